@@ -1,6 +1,15 @@
 #include "avl_matrix.h"
+#include "csr_matrix.h"
+#include "thread_pool.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
+#include <string.h>
+
+#define ARENA_INITIAL_BYTES 4096
+#define ARENA_MAX_BYTES 262144
+#define POOL_INITIAL_NODES 64
+#define LINK_INDEX_MASK ((1u << AVL_LINK_INDEX_BITS) - 1)
 
 /**
  * @file avl_matrix.c
@@ -20,6 +29,285 @@ static void _allocation_fail(){
     exit(EXIT_FAILURE);
 }
 
+/**
+ * @brief Endereço do nó index de um pool.
+ *
+ * @param pool pool do nó.
+ * @param index índice do nó.
+ * @param node_size tamanho do tipo de nó do pool.
+ */
+static void* _pool_at(const AVLNodePool* pool, AVLIndex index, size_t node_size){
+    return (unsigned char*) pool->nodes + (size_t) index * node_size;
+}
+
+/**
+ * @brief Obtém um índice livre do pool, reaproveitando os devolvidos primeiro.
+ *
+ * O vetor de nós cresce 50% quando lota. Como ele pode mudar de endereço, ponteiros
+ * para nós do pool não sobrevivem a esta chamada; apenas os índices.
+ *
+ * @param arena arena dona do pool (contabiliza os bytes do crescimento).
+ * @param pool pool de onde o nó sai.
+ * @param node_size tamanho do tipo de nó do pool.
+ * @return Índice do nó (nunca 0).
+ */
+static AVLIndex _pool_alloc(AVLArena* arena, AVLNodePool* pool, size_t node_size){
+    if(pool->free_list){
+        AVLIndex index = pool->free_list;
+        pool->free_list = *(unsigned int*) _pool_at(pool, index, node_size);
+        if(pool->references){
+            pool->references[index] = 0;
+        }
+        return index;
+    }
+    if(pool->count == 0){
+        pool->count = 1; //O índice 0 é reservado para "nenhum nó".
+    }
+    if(pool->count >= pool->capacity){
+        unsigned int capacity = pool->capacity ? pool->capacity + pool->capacity / 2 : POOL_INITIAL_NODES;
+        if(capacity > LINK_INDEX_MASK + 1){
+            capacity = LINK_INDEX_MASK + 1;
+        }
+        if(capacity == pool->capacity){
+            _allocation_fail();
+        }
+        void* nodes = realloc(pool->nodes, (size_t) capacity * node_size);
+        if(!nodes){
+            _allocation_fail();
+        }
+        arena->bytes += (unsigned long long) (capacity - pool->capacity) * node_size;
+        pool->nodes = nodes;
+        if(pool->references || arena->users > 1){
+            unsigned int* references = realloc(pool->references, sizeof(unsigned int) * capacity);
+            if(!references){
+                _allocation_fail();
+            }
+            arena->bytes += (unsigned long long) (capacity - pool->capacity) * sizeof(unsigned int);
+            pool->references = references;
+        }
+        pool->capacity = capacity;
+    }
+    if(pool->references){
+        pool->references[pool->count] = 0;
+    }
+    return pool->count++;
+}
+
+/**
+ * @brief Devolve um índice ao pool para reuso.
+ *
+ * @param pool pool do nó.
+ * @param index índice que não pertence mais a nenhuma árvore.
+ * @param node_size tamanho do tipo de nó do pool.
+ */
+static void _pool_release(AVLNodePool* pool, AVLIndex index, size_t node_size){
+    *(unsigned int*) _pool_at(pool, index, node_size) = pool->free_list;
+    pool->free_list = index;
+}
+
+/**
+ * @brief Libera o vetor de nós de um pool.
+ *
+ * @param pool pool a esvaziar.
+ */
+static void _pool_destroy(AVLNodePool* pool){
+    free(pool->nodes);
+    free(pool->references);
+    *pool = (AVLNodePool){NULL, 0, 0, 0, NULL};
+}
+
+/**
+ * @brief Liga ou desliga a contagem de referências de um pool.
+ *
+ * O vetor guarda as referências além da primeira: ao ligar, ele começa zerado (cada nó
+ * tem um único pai enquanto a arena não é compartilhada); ao desligar, volta implicitamente a zero.
+ *
+ * @param arena arena dona do pool (contabiliza os bytes do vetor de contagens).
+ * @param pool pool afetado.
+ * @param enable 1 para ligar, 0 para desligar.
+ */
+static void _pool_track_references(AVLArena* arena, AVLNodePool* pool, int enable){
+    if(!enable){
+        if(pool->references){
+            free(pool->references);
+            pool->references = NULL;
+            arena->bytes -= (unsigned long long) pool->capacity * sizeof(unsigned int);
+        }
+        return;
+    }
+    if(pool->references || pool->capacity == 0){ //Um pool vazio cria as contagens ao crescer.
+        return;
+    }
+    pool->references = calloc(pool->capacity, sizeof(unsigned int)); //Páginas zeradas sob demanda: ligar é O(1) na prática.
+    if(!pool->references){
+        _allocation_fail();
+    }
+    arena->bytes += (unsigned long long) pool->capacity * sizeof(unsigned int);
+}
+
+/**
+ * @brief Endereço do InnerNode index da arena (NULL para o índice 0).
+ */
+static InnerNode* _inner_node(const AVLArena* arena, AVLIndex index){
+    return index ? _pool_at(&arena->inner, index, sizeof(InnerNode)) : NULL;
+}
+
+/**
+ * @brief Endereço do OuterNode index da arena (NULL para o índice 0).
+ */
+static OuterNode* _outer_node(const AVLArena* arena, AVLIndex index){
+    return index ? _pool_at(&arena->outer, index, sizeof(OuterNode)) : NULL;
+}
+
+/**
+ * @brief Reserva size bytes do bloco mais recente da arena, criando outro se necessário.
+ *
+ * Usado pelos nós B+. Os blocos dobram de tamanho a partir de ARENA_INITIAL_BYTES até ARENA_MAX_BYTES.
+ *
+ * @param arena arena da árvore.
+ * @param size tamanho do nó (múltiplo de 8).
+ * @return Ponteiro para a área reservada.
+ */
+static void* _arena_alloc(AVLArena* arena, size_t size){
+    if(!arena->chunks || arena->chunks->used + size > arena->chunks->size){
+        size_t chunk_size = arena->chunks ? arena->chunks->size * 2 : ARENA_INITIAL_BYTES;
+        if(chunk_size > ARENA_MAX_BYTES){
+            chunk_size = ARENA_MAX_BYTES;
+        }
+        AVLArenaChunk* chunk = malloc(sizeof(AVLArenaChunk) + chunk_size);
+        if(!chunk){
+            _allocation_fail();
+        }
+        chunk->next = arena->chunks;
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        arena->chunks = chunk;
+        arena->bytes += sizeof(AVLArenaChunk) + chunk_size;
+    }
+    void* node = (unsigned char*) arena->chunks->data + arena->chunks->used;
+    arena->chunks->used += size;
+    return node;
+}
+
+/**
+ * @brief Obtém um InnerNode da arena.
+ *
+ * @param arena arena da árvore.
+ * @return Índice do nó.
+ */
+static AVLIndex _arena_inner(AVLArena* arena){
+    return _pool_alloc(arena, &arena->inner, sizeof(InnerNode));
+}
+
+/**
+ * @brief Obtém um OuterNode da arena.
+ *
+ * @param arena arena da árvore.
+ * @return Índice do nó.
+ */
+static AVLIndex _arena_outer(AVLArena* arena){
+    return _pool_alloc(arena, &arena->outer, sizeof(OuterNode));
+}
+
+/**
+ * @brief Devolve um InnerNode removido ao pool da arena.
+ *
+ * @param arena arena da árvore.
+ * @param index nó que não pertence mais a nenhuma árvore.
+ */
+static void _arena_release_inner(AVLArena* arena, AVLIndex index){
+    _pool_release(&arena->inner, index, sizeof(InnerNode));
+}
+
+/**
+ * @brief Devolve um OuterNode removido ao pool da arena.
+ *
+ * @param arena arena da árvore.
+ * @param index nó que não pertence mais a nenhuma árvore.
+ */
+static void _arena_release_outer(AVLArena* arena, AVLIndex index){
+    _pool_release(&arena->outer, index, sizeof(OuterNode));
+}
+
+/**
+ * @brief Obtém um nó B+ da arena, reaproveitando a lista livre do seu tamanho primeiro.
+ *
+ * @param arena arena da matriz.
+ * @param small 1 para um bloco de 32 bytes (folha curta), 0 para 64 bytes.
+ */
+static BTreeNode* _arena_block(AVLArena* arena, int small){
+    void** list = small ? &arena->free_small_blocks : &arena->free_blocks;
+    BTreeNode* block;
+    if(*list){
+        block = *list;
+        *list = *(void**) block;
+    }
+    else{
+        block = _arena_alloc(arena, small ? 32 : 64);
+    }
+    block->references = 1;
+    return block;
+}
+
+/**
+ * @brief Devolve um nó B+ removido para a lista livre do seu tamanho.
+ *
+ * @param arena arena da matriz.
+ * @param node nó que não pertence mais a nenhuma árvore.
+ */
+static void _arena_release_block(AVLArena* arena, BTreeNode* node){
+    void** list = node->capacity == AVL_BTREE_SMALL_LEAF_CAPACITY ? &arena->free_small_blocks : &arena->free_blocks;
+    *(void**) node = *list;
+    *list = node;
+}
+
+/**
+ * @brief Libera todos os blocos da arena em O(blocos) e a deixa vazia para reuso.
+ *
+ * @param arena arena da matriz.
+ */
+static void _arena_destroy(AVLArena* arena){
+    AVLArenaChunk* chunk = arena->chunks;
+    while(chunk){
+        AVLArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    _pool_destroy(&arena->inner);
+    _pool_destroy(&arena->outer);
+    arena->chunks = NULL;
+    arena->free_small_blocks = NULL;
+    arena->free_blocks = NULL;
+    arena->bytes = 0;
+}
+
+/**
+ * @brief Cria uma arena vazia usada por uma única árvore.
+ *
+ * @return Arena alocada.
+ */
+static AVLArena* _arena_create(){
+    AVLArena* arena = calloc(1, sizeof(AVLArena));
+    if(!arena){
+        _allocation_fail();
+    }
+    arena->users = 1;
+    return arena;
+}
+
+/**
+ * @brief Registra mais uma árvore usando a arena, ligando a contagem de referências dos nós.
+ *
+ * @param arena arena a compartilhar.
+ * @return A própria arena.
+ */
+static AVLArena* _arena_share(AVLArena* arena){
+    arena->users++;
+    _pool_track_references(arena, &arena->inner, 1);
+    _pool_track_references(arena, &arena->outer, 1);
+    return arena;
+}
+
 const char* avl_status_string(AVLStatus status){
     switch(status){
         case AVL_STATUS_OK:
@@ -98,53 +386,200 @@ static AVLStatus _validate_same_dimensions(AVLMatrix* A, AVLMatrix* B){
     return AVL_STATUS_OK;
 }
 
+/**
+ * @brief Índice do filho guardado num campo left/right empacotado.
+ */
+static AVLIndex _link(unsigned int link){
+    return link & LINK_INDEX_MASK;
+}
+
+/**
+ * @brief Troca o filho de um campo left/right empacotado, preservando os bits de altura.
+ */
+static void _set_link(unsigned int* link, AVLIndex index){
+    *link = (*link & ~LINK_INDEX_MASK) | index;
+}
+
+/**
+ * @brief Lê a altura empacotada nos 3 bits altos de left e right.
+ */
+static int _unpack_height(unsigned int left, unsigned int right){
+    return (int) ((left >> AVL_LINK_INDEX_BITS) << 3 | (right >> AVL_LINK_INDEX_BITS));
+}
+
+/**
+ * @brief Grava a altura (até 63) nos 3 bits altos de left e right.
+ */
+static void _pack_height(unsigned int* left, unsigned int* right, int height){
+    *left = (*left & LINK_INDEX_MASK) | ((unsigned int) height >> 3) << AVL_LINK_INDEX_BITS;
+    *right = (*right & LINK_INDEX_MASK) | ((unsigned int) height & 7u) << AVL_LINK_INDEX_BITS;
+}
+
 /**
  * @brief Retorna altura de um nó da árvore interna (0 se nulo).
  *
+ * @param arena arena da árvore.
  * @param tree nó cuja altura é consultada.
  */
-static int _height_i(InnerNode* tree){
+static int _height_i(const AVLArena* arena, AVLIndex tree){
     if(!tree){
         return 0; 
     }
-    return tree->height;
+    InnerNode* node = _inner_node(arena, tree);
+    return _unpack_height(node->left, node->right);
 }
 /**
  * @brief Retorna altura de um nó da árvore externa (0 se nulo).
  *
+ * @param arena arena da árvore.
  * @param tree nó cuja altura é consultada.
  */
-static int _height_o(OuterNode* tree){
+static int _height_o(const AVLArena* arena, AVLIndex tree){
     if(!tree){
         return 0; 
     }
-    return tree->height;
+    OuterNode* node = _outer_node(arena, tree);
+    return _unpack_height(node->left, node->right);
+}
+
+/**
+ * @brief Retorna o maior entre dois inteiros.
+ *
+ * @param a primeiro inteiro.
+ * @param b segundo inteiro.
+ */
+static int _max(int a, int b) {
+    return (a > b) ? a : b;
+}
+
+/**
+ * @brief Recalcula a altura de um nó interno a partir dos filhos.
+ *
+ * @param arena arena da árvore.
+ * @param node nó a atualizar.
+ */
+static void _update_height_i(const AVLArena* arena, InnerNode* node){
+    int height = 1 + _max(_height_i(arena, _link(node->left)), _height_i(arena, _link(node->right)));
+    _pack_height(&node->left, &node->right, height);
+}
+
+/**
+ * @brief Recalcula a altura de um nó externo a partir dos filhos.
+ *
+ * @param arena arena da árvore.
+ * @param node nó a atualizar.
+ */
+static void _update_height_o(const AVLArena* arena, OuterNode* node){
+    int height = 1 + _max(_height_o(arena, _link(node->left)), _height_o(arena, _link(node->right)));
+    _pack_height(&node->left, &node->right, height);
 }
+
 /**
  * @brief Calcula fator de balanceamento (altura esquerda - altura direita) da árvore interna.
  *
- * @param tree raiz da subárvore interna.
+ * @param arena arena da árvore.
+ * @param node raiz da subárvore interna.
  */
-static int _balance_factor_i(InnerNode* tree){
-    return _height_i(tree->left) - _height_i(tree->right);
+static int _balance_factor_i(const AVLArena* arena, InnerNode* node){
+    return _height_i(arena, _link(node->left)) - _height_i(arena, _link(node->right));
 }
 /**
  * @brief Calcula fator de balanceamento (altura esquerda - altura direita) da árvore externa.
  *
- * @param tree raiz da subárvore externa.
+ * @param arena arena da árvore.
+ * @param node raiz da subárvore externa.
  */
-static int _balance_factor_o(OuterNode* tree){
-    return _height_o(tree->left) - _height_o(tree->right);
+static int _balance_factor_o(const AVLArena* arena, OuterNode* node){
+    return _height_o(arena, _link(node->left)) - _height_o(arena, _link(node->right));
 }
 
 /**
- * @brief Retorna o maior entre dois inteiros.
+ * @brief Soma uma referência a um nó interno de uma arena compartilhada.
  *
- * @param a primeiro inteiro.
- * @param b segundo inteiro.
+ * @param arena arena da árvore.
+ * @param tree nó referenciado (ou 0).
  */
-static int _max(int a, int b) {
-    return (a > b) ? a : b;
+static void _retain_i(AVLArena* arena, AVLIndex tree){
+    if(tree && arena->inner.references){
+        arena->inner.references[tree]++;
+    }
+}
+
+/**
+ * @brief Soma uma referência a um nó externo de uma arena compartilhada.
+ *
+ * @param arena arena da árvore.
+ * @param tree nó referenciado (ou 0).
+ */
+static void _retain_o(AVLArena* arena, AVLIndex tree){
+    if(tree && arena->outer.references){
+        arena->outer.references[tree]++;
+    }
+}
+
+/**
+ * @brief Soma uma referência à fileira apontada por um nó externo.
+ *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
+ * @param root fileira referenciada.
+ */
+static void _retain_inner(AVLArena* arena, AVLInnerLayout layout, AVLInnerRoot root){
+    if(layout == AVL_INNER_BTREE){
+        if(root.btree){
+            root.btree->references++;
+        }
+    }
+    else{
+        _retain_i(arena, root.tree);
+    }
+}
+
+/**
+ * @brief Garante que o nó interno tree pertence a uma única árvore antes de ser alterado.
+ *
+ * Se o nó é compartilhado, é substituído por uma cópia (path copying): a cópia passa a
+ * referenciar os mesmos filhos e o original perde a referência de quem chamou.
+ *
+ * @param arena arena da árvore.
+ * @param tree nó prestes a ser alterado (ou 0).
+ * @return Índice de um nó exclusivo com o mesmo conteúdo.
+ */
+static AVLIndex _own_i(AVLArena* arena, AVLIndex tree){
+    if(!tree || !arena->inner.references || arena->inner.references[tree] == 0){
+        return tree;
+    }
+    AVLIndex copy = _arena_inner(arena);
+    InnerNode* node = _inner_node(arena, tree);
+    *_inner_node(arena, copy) = *node;
+    arena->inner.references[tree]--;
+    _retain_i(arena, _link(node->left));
+    _retain_i(arena, _link(node->right));
+    return copy;
+}
+
+/**
+ * @brief Garante que o nó externo tree pertence a uma única árvore antes de ser alterado.
+ *
+ * Como em _own_i; a cópia também passa a referenciar a fileira do nó.
+ *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
+ * @param tree nó prestes a ser alterado (ou 0).
+ * @return Índice de um nó exclusivo com o mesmo conteúdo.
+ */
+static AVLIndex _own_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree){
+    if(!tree || !arena->outer.references || arena->outer.references[tree] == 0){
+        return tree;
+    }
+    AVLIndex copy = _arena_outer(arena);
+    OuterNode* node = _outer_node(arena, tree);
+    *_outer_node(arena, copy) = *node;
+    arena->outer.references[tree]--;
+    _retain_o(arena, _link(node->left));
+    _retain_o(arena, _link(node->right));
+    _retain_inner(arena, layout, node->inner);
+    return copy;
 }
 
 /**
@@ -153,17 +588,21 @@ static int _max(int a, int b) {
  * Rotação usada para o rebalanceamento da árvore
  * AVL interna.
  *
+ * @param arena arena da árvore.
  * @param tree raiz desbalanceada.
  * @return Nova raiz após rotação.
  */
-static InnerNode* _left_rotate_i(InnerNode* tree){
-    InnerNode* right = tree->right;
-    tree -> right = right->left;
-    right->left = tree;
-
-    tree->height  = 1 + _max(_height_i(tree->left),  _height_i(tree->right));
-    right->height = 1 + _max(_height_i(right->left), _height_i(right->right));
-    return right;
+static AVLIndex _left_rotate_i(AVLArena* arena, AVLIndex tree){
+    tree = _own_i(arena, tree);
+    AVLIndex right_index = _own_i(arena, _link(_inner_node(arena, tree)->right));
+    InnerNode* node = _inner_node(arena, tree);
+    InnerNode* right = _inner_node(arena, right_index);
+    _set_link(&node->right, _link(right->left));
+    _set_link(&right->left, tree);
+
+    _update_height_i(arena, node);
+    _update_height_i(arena, right);
+    return right_index;
 }
 
 /**
@@ -172,17 +611,21 @@ static InnerNode* _left_rotate_i(InnerNode* tree){
  * Rotação usada para o rebalanceamento da árvore
  * AVL interna.
  *
+ * @param arena arena da árvore.
  * @param tree raiz desbalanceada.
  * @return Nova raiz após rotação.
  */
-static InnerNode* _right_rotate_i(InnerNode* tree){
-    InnerNode* left = tree->left;
-    tree -> left = left-> right;
-    left->right = tree;
-
-    tree->height = 1 + _max(_height_i(tree->left), _height_i(tree->right));
-    left->height = 1 + _max(_height_i(left->left), _height_i(left->right));
-    return left;
+static AVLIndex _right_rotate_i(AVLArena* arena, AVLIndex tree){
+    tree = _own_i(arena, tree);
+    AVLIndex left_index = _own_i(arena, _link(_inner_node(arena, tree)->left));
+    InnerNode* node = _inner_node(arena, tree);
+    InnerNode* left = _inner_node(arena, left_index);
+    _set_link(&node->left, _link(left->right));
+    _set_link(&left->right, tree);
+
+    _update_height_i(arena, node);
+    _update_height_i(arena, left);
+    return left_index;
 }
 
 /**
@@ -191,18 +634,22 @@ static InnerNode* _right_rotate_i(InnerNode* tree){
  * Rotação usada para o rebalanceamento da árvore
  * AVL externa.
  *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
  * @param tree raiz desbalanceada.
  * @return Nova raiz após rotação.
  */
-static OuterNode* _left_rotate_o(OuterNode* tree){
-    OuterNode* right = tree->right;
-    tree->right = right->left;
-    right->left = tree;
-
-    tree->height  = 1 + _max(_height_o(tree->left),  _height_o(tree->right));
-    right->height = 1 + _max(_height_o(right->left), _height_o(right->right));
-
-    return right;
+static AVLIndex _left_rotate_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree){
+    tree = _own_o(arena, layout, tree);
+    AVLIndex right_index = _own_o(arena, layout, _link(_outer_node(arena, tree)->right));
+    OuterNode* node = _outer_node(arena, tree);
+    OuterNode* right = _outer_node(arena, right_index);
+    _set_link(&node->right, _link(right->left));
+    _set_link(&right->left, tree);
+
+    _update_height_o(arena, node);
+    _update_height_o(arena, right);
+    return right_index;
 }
 
 /**
@@ -211,663 +658,2170 @@ static OuterNode* _left_rotate_o(OuterNode* tree){
  * Rotação usada para o rebalanceamento da árvore
  * AVL externa.
  *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
  * @param tree raiz desbalanceada.
  * @return Nova raiz após rotação.
  */
-static OuterNode* _right_rotate_o(OuterNode* tree){
-    OuterNode* left = tree->left;
-    tree->left = left->right;
-    left->right = tree;
+static AVLIndex _right_rotate_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree){
+    tree = _own_o(arena, layout, tree);
+    AVLIndex left_index = _own_o(arena, layout, _link(_outer_node(arena, tree)->left));
+    OuterNode* node = _outer_node(arena, tree);
+    OuterNode* left = _outer_node(arena, left_index);
+    _set_link(&node->left, _link(left->right));
+    _set_link(&left->right, tree);
+
+    _update_height_o(arena, node);
+    _update_height_o(arena, left);
+    return left_index;
+}
+
+/**
+ * @brief Atualiza a altura de um nó interno e aplica a rotação necessária (LL, LR, RR ou RL).
+ *
+ * @param arena arena da árvore.
+ * @param tree raiz da subárvore (exclusiva), com filhos já balanceados.
+ * @return Nova raiz da subárvore.
+ */
+static AVLIndex _rebalance_i(AVLArena* arena, AVLIndex tree){
+    InnerNode* node = _inner_node(arena, tree);
+    _update_height_i(arena, node);
+
+    int bf = _balance_factor_i(arena, node);
+
+    if(bf > 1){//Sub-árvore esquerda grande
+        int sub_bf = _balance_factor_i(arena, _inner_node(arena, _link(node->left)));
+        if(sub_bf < 0){//Causa é a sub-árvore direita do filho esquerdo: LR
+            AVLIndex left = _left_rotate_i(arena, _link(node->left));
+            _set_link(&_inner_node(arena, tree)->left, left);
+        }
+        //Causa é a sub-árvore esquerda do filho esquerdo: LL
+        return _right_rotate_i(arena, tree);
+    }
+    if(bf < -1){//Sub-árvore direita grande
+        int sub_bf = _balance_factor_i(arena, _inner_node(arena, _link(node->right)));
+        if(sub_bf > 0){//Causa é a sub-árvore esquerda do filho direito: RL
+            AVLIndex right = _right_rotate_i(arena, _link(node->right));
+            _set_link(&_inner_node(arena, tree)->right, right);
+        }
+        //Causa é a sub-árvore direita do filho direito: RR
+        return _left_rotate_i(arena, tree);
+    }
+
+    return tree;
+}
 
-    tree->height = 1 + _max(_height_o(tree->left), _height_o(tree->right));
-    left->height = 1 + _max(_height_o(left->left), _height_o(left->right));
+/**
+ * @brief Atualiza a altura de um nó externo e aplica a rotação necessária (LL, LR, RR ou RL).
+ *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
+ * @param tree raiz da subárvore (exclusiva), com filhos já balanceados.
+ * @return Nova raiz da subárvore.
+ */
+static AVLIndex _rebalance_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree){
+    OuterNode* node = _outer_node(arena, tree);
+    _update_height_o(arena, node);
+
+    int bf = _balance_factor_o(arena, node);
+
+    if(bf > 1){
+        int sub_bf = _balance_factor_o(arena, _outer_node(arena, _link(node->left)));
+        if(sub_bf < 0){
+            AVLIndex left = _left_rotate_o(arena, layout, _link(node->left));
+            _set_link(&_outer_node(arena, tree)->left, left);
+        }
+        return _right_rotate_o(arena, layout, tree);
+    }
+    if(bf < -1){
+        int sub_bf = _balance_factor_o(arena, _outer_node(arena, _link(node->right)));
+        if(sub_bf > 0){
+            AVLIndex right = _right_rotate_o(arena, layout, _link(node->right));
+            _set_link(&_outer_node(arena, tree)->right, right);
+        }
+        return _left_rotate_o(arena, layout, tree);
+    }
 
-    return left;
+    return tree;
 }
 
 /**
  * @brief Busca nó na árvore interna pelo índice.
  *
+ * @param arena arena da árvore.
  * @param tree raiz da árvore interna.
  * @param search_key fileira procurada.
  * @return Ponteiro para o nó ou NULL se não existir.
  */
-static InnerNode* _find_node_i(InnerNode* tree, int search_key){
-    if(!tree){
-        return NULL;
-    }
-    if(tree->key == search_key){
-        return tree;
-    }
-    if(tree -> key < search_key){
-        return _find_node_i(tree -> right, search_key);
-    }
-    else{
-        return _find_node_i(tree -> left, search_key);
+static InnerNode* _find_node_i(const AVLArena* arena, AVLIndex tree, int search_key){
+    while(tree){
+        InnerNode* node = _inner_node(arena, tree);
+        if(node->key == search_key){
+            return node;
+        }
+        unsigned int link = node->key < search_key ? node->right : node->left; //Seleção sem desvio antes da máscara.
+        tree = _link(link);
     }
+    return NULL;
 }
 
 /**
  * @brief Busca nó na árvore externa pelo índice.
  *
+ * @param arena arena da árvore.
  * @param tree raiz da árvore externa.
  * @param search_key fileira procurada.
  * @return Ponteiro para o nó ou NULL se não existir.
  */
-static OuterNode* _find_node_o(OuterNode* tree, int search_key){
-    if(!tree){
-        return NULL;
+static OuterNode* _find_node_o(const AVLArena* arena, AVLIndex tree, int search_key){
+    while(tree){
+        OuterNode* node = _outer_node(arena, tree);
+        if(node->key == search_key){
+            return node;
+        }
+        unsigned int link = node->key < search_key ? node->right : node->left; //Seleção sem desvio antes da máscara.
+        tree = _link(link);
     }
-    if(tree->key == search_key){
+    return NULL;
+}
+
+/**
+ * @brief Copia os nós externos compartilhados do caminho da raiz até a fileira key.
+ *
+ * Depois da chamada, o nó da fileira (se existir) pode ter seu campo inner alterado
+ * sem afetar as outras árvores que dividem a arena.
+ *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
+ * @param tree raiz da árvore externa.
+ * @param key fileira procurada.
+ * @return Nova raiz da árvore externa.
+ */
+static AVLIndex _own_path_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree, int key){
+    if(!arena->outer.references){
         return tree;
     }
-    if(tree -> key < search_key){
-        return _find_node_o(tree -> right, search_key);
-    }
-    else{
-        return _find_node_o(tree -> left, search_key);
+    AVLIndex root = _own_o(arena, layout, tree);
+    AVLIndex current = root;
+    while(current){
+        OuterNode* node = _outer_node(arena, current);
+        if(node->key == key){
+            break;
+        }
+        int right = node->key < key;
+        AVLIndex child = _own_o(arena, layout, _link(right ? node->right : node->left));
+        node = _outer_node(arena, current); //A cópia pode ter realocado o pool.
+        _set_link(right ? &node->right : &node->left, child);
+        current = child;
     }
+    return root;
 }
 
 /**
  * @brief Insere ou atualiza um valor na árvore interna mantendo balanceamento AVL.
  *
+ * @param arena arena de onde o novo nó é obtido.
  * @param tree raiz da árvore interna.
  * @param insert_key índice do elemento a inserir.
  * @param value valor a armazenar.
  * @param already_existed flag de saída: 1 se chave já existia.
  * @return Nova raiz da subárvore após inserção/balanceamento.
  */
-static InnerNode* _insert_i(InnerNode* tree, int insert_key, float value, int* already_existed){
+static AVLIndex _insert_i(AVLArena* arena, AVLIndex tree, int insert_key, float value, int* already_existed){
     if(!tree){
-        InnerNode* new_node = malloc(sizeof (InnerNode));
-        if(!new_node){
-            _allocation_fail();
-        }
+        AVLIndex new_index = _arena_inner(arena);
+        InnerNode* new_node = _inner_node(arena, new_index);
         new_node -> key = insert_key;
         new_node -> data = value;
-        new_node -> left = NULL;
-        new_node -> right = NULL;
-        new_node -> height = 1;
-        return new_node;
+        new_node -> left = 0;
+        new_node -> right = 0;
+        _pack_height(&new_node->left, &new_node->right, 1);
+        return new_index;
     }
 
-    if(tree->key == insert_key){
+    tree = _own_i(arena, tree);
+    InnerNode* node = _inner_node(arena, tree);
+    if(node->key == insert_key){
         *already_existed = 1;
-        tree -> data = value;
+        node -> data = value;
         return tree;
     }
-    if(tree->key < insert_key){
-        tree -> right = _insert_i(tree->right, insert_key, value, already_existed);
+    //A inserção no filho pode realocar o pool: node é recalculado a partir do índice.
+    if(node->key < insert_key){
+        AVLIndex right = _insert_i(arena, _link(node->right), insert_key, value, already_existed);
+        _set_link(&_inner_node(arena, tree)->right, right);
     }
-    if(tree->key > insert_key){
-        tree -> left = _insert_i(tree->left, insert_key, value, already_existed);
+    else{
+        AVLIndex left = _insert_i(arena, _link(node->left), insert_key, value, already_existed);
+        _set_link(&_inner_node(arena, tree)->left, left);
     }
 
-    tree->height = 1 + _max(_height_i(tree->left), _height_i(tree->right));
+    return _rebalance_i(arena, tree);
+}
 
-    int bf = _balance_factor_i(tree);
+/**
+ * @brief Insere ou atualiza um valor na árvore externa mantendo balanceamento AVL.
+ *
+ * @param arena arena de onde o novo nó é obtido.
+ * @param layout layout das fileiras.
+ * @param tree raiz da árvore externa.
+ * @param insert_key fileira a inserir.
+ * @param inner fileira (em qualquer layout) à ser inserida no nó.
+ * @return Nova raiz da subárvore após inserção/balanceamento.
+ */
+static AVLIndex _insert_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree, int insert_key, AVLInnerRoot inner){
+    if(!tree){
+        AVLIndex new_index = _arena_outer(arena);
+        OuterNode* new_node = _outer_node(arena, new_index);
+        new_node -> key = insert_key;
+        new_node -> inner = inner;
+        new_node -> left = 0;
+        new_node -> right = 0;
+        _pack_height(&new_node->left, &new_node->right, 1);
+        return new_index;
+    }
 
-    if(bf > 1){//Sub-árvore esquerda grande
-        int sub_bf = _balance_factor_i(tree->left);
-        if(sub_bf >= 0){//Causa é a sub-árvore esquerda do filho esquerdo: LL
-            return _right_rotate_i(tree);
-        }
-        else{//Causa é a sub-árvore direita do filho esquerdo: LR
-            tree -> left = _left_rotate_i(tree -> left);
-            return _right_rotate_i(tree);
-        }
+    tree = _own_o(arena, layout, tree);
+    OuterNode* node = _outer_node(arena, tree);
+    if(node->key == insert_key){
+        node -> inner = inner;
+        return tree;
     }
-    if(bf < -1){//Sub-árvore direita grande
-        int sub_bf = _balance_factor_i(tree->right);
-        if(sub_bf < 0){//Causa é a sub-árvore direita do filho direito: RR
-            return _left_rotate_i(tree);
-        }
-        else{//Causa é a sub-árvore esquerda do filho direito: RL
-            tree -> right = _right_rotate_i(tree -> right);
-            return _left_rotate_i(tree);
-        }
+    if(node->key < insert_key){
+        AVLIndex right = _insert_o(arena, layout, _link(node->right), insert_key, inner);
+        _set_link(&_outer_node(arena, tree)->right, right);
+    }
+    else{
+        AVLIndex left = _insert_o(arena, layout, _link(node->left), insert_key, inner);
+        _set_link(&_outer_node(arena, tree)->left, left);
     }
 
-    return tree;
-
+    return _rebalance_o(arena, layout, tree);
+}
+/**
+ * @brief Encontra o maior nó (mais à direita) em uma árvore interna.
+ *
+ * @param arena arena da árvore.
+ * @param tree raiz da árvore interna (não vazia).
+ * @return Ponteiro para o nó máximo.
+ */
+static InnerNode * _find_max_i (const AVLArena* arena, AVLIndex tree){
+    InnerNode* node = _inner_node(arena, tree);
+    while(_link(node->right)){
+        node = _inner_node(arena, _link(node->right));
+    }
+    return node;
 }
 
 /**
- * @brief Insere ou atualiza um valor na árvore externa mantendo balanceamento AVL.
+ * @brief Encontra o maior nó (mais à direita) em uma árvore externa.
  *
- * @param tree raiz da árvore externa.
- * @param insert_key fileira a inserir.
- * @param inner_tree ponteiro para a árvore interna à ser inserida no nó.
- * @return Nova raiz da subárvore após inserção/balanceamento.
+ * @param arena arena da árvore.
+ * @param tree raiz da árvore externa (não vazia).
+ * @return Ponteiro para o nó máximo.
  */
-static OuterNode* _insert_o(OuterNode* tree, int insert_key, InnerNode* inner_tree){
-    if(!tree){
-        OuterNode* new_node = malloc(sizeof (OuterNode));
-        if(!new_node){
-            _allocation_fail();
-        }
-        new_node -> key = insert_key;
-        new_node -> inner_tree = inner_tree;
-        new_node -> left = NULL;
-        new_node -> right = NULL;
-        new_node -> height = 1;
-        return new_node;
+static OuterNode * _find_max_o (const AVLArena* arena, AVLIndex tree){
+    OuterNode* node = _outer_node(arena, tree);
+    while(_link(node->right)){
+        node = _outer_node(arena, _link(node->right));
     }
+    return node;
+}
 
-    if(tree->key == insert_key){
-        tree -> inner_tree = inner_tree;
-        return tree;
+/**
+ * @brief Remove chave da árvore interna e rebalanceia.
+ *
+ * @param arena arena que recebe o nó removido.
+ * @param tree raiz da árvore interna.
+ * @param remove_key coluna a remover.
+ * @return Nova raiz da subárvore após remoção.
+ */
+static AVLIndex _remove_i(AVLArena* arena, AVLIndex tree, int remove_key){
+    if(!tree){
+        return 0;
     }
-    if(tree->key < insert_key){
-        tree -> right = _insert_o(tree->right, insert_key, inner_tree);
+    tree = _own_i(arena, tree);
+    InnerNode* node = _inner_node(arena, tree);
+    //A remoção no filho pode copiar nós compartilhados (realocando o pool): node é recalculado.
+    if(node -> key < remove_key){
+        AVLIndex right = _remove_i(arena, _link(node->right), remove_key);
+        _set_link(&_inner_node(arena, tree)->right, right);
     }
-    if(tree->key > insert_key){
-        tree -> left = _insert_o(tree->left, insert_key, inner_tree);
+    else if(node->key > remove_key){
+        AVLIndex left = _remove_i(arena, _link(node->left), remove_key);
+        _set_link(&_inner_node(arena, tree)->left, left);
     }
+    else{
+        if(!_link(node->left)){ //Sem filho esquerdo ou sem filhos
+            AVLIndex right = _link(node->right);
+            _arena_release_inner(arena, tree);
+            return right; //No caso sem filhos, retorna 0
+        }
+        else if(!_link(node->right)){//Sem filho direito
+            AVLIndex left = _link(node->left);
+            _arena_release_inner(arena, tree);
+            return left;
+        }
+        else{ //Dois filhos
+            InnerNode* max_of_left = _find_max_i(arena, _link(node->left));
+            node->key = max_of_left->key;
+            node->data = max_of_left->data;
 
-    tree -> height = 1 + _max(_height_o(tree -> left), _height_o(tree -> right));
+            AVLIndex left = _remove_i(arena, _link(node->left), node->key);
+            _set_link(&_inner_node(arena, tree)->left, left);
+        }
+    }
 
-    int bf = _balance_factor_o(tree);
+    return _rebalance_i(arena, tree);
+}
 
-    if(bf > 1){//Sub-árvore esquerda grande
-        int sub_bf = _balance_factor_o(tree->left);
-        if(sub_bf >= 0){//Causa é a sub-árvore esquerda do filho esquerdo: LL
-            return _right_rotate_o(tree);
-        }
-        else{//Causa é a sub-árvore direita do filho esquerdo: LR
-            tree -> left = _left_rotate_o(tree -> left);
-            return _right_rotate_o(tree);
-        }
+/**
+ * @brief Remove fileira e rebalanceia a árvore externa.
+ * 
+ * Só deve ser chamado para a remoção "estrutural" do nó,
+ * não limpa o conteúdo interno dele. Planejado para a
+ * remoção de um nó já vazio.
+ *
+ * @param arena arena que recebe o nó removido.
+ * @param layout layout das fileiras.
+ * @param tree raiz da árvore externa.
+ * @param remove_key fileira a remover.
+ * @return Nova raiz da subárvore após remoção.
+ */
+static AVLIndex _remove_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree, int remove_key){
+    if(!tree){
+        return 0;
     }
-    if(bf < -1){//Sub-árvore direita grande
-        int sub_bf = _balance_factor_o(tree->right);
-        if(sub_bf < 0){//Causa é a sub-árvore direita do filho direito: RR
-            return _left_rotate_o(tree);
+    tree = _own_o(arena, layout, tree);
+    OuterNode* node = _outer_node(arena, tree);
+    if(node -> key < remove_key){
+        AVLIndex right = _remove_o(arena, layout, _link(node->right), remove_key);
+        _set_link(&_outer_node(arena, tree)->right, right);
+    }
+    else if(node->key > remove_key){
+        AVLIndex left = _remove_o(arena, layout, _link(node->left), remove_key);
+        _set_link(&_outer_node(arena, tree)->left, left);
+    }
+    else{
+        if(!_link(node->left)){
+            AVLIndex right = _link(node->right);
+            _arena_release_outer(arena, tree);
+            return right;
         }
-        else{//Causa é a sub-árvore esquerda do filho direito: RL
-            tree -> right = _right_rotate_o(tree -> right);
-            return _left_rotate_o(tree);
+        else if(!_link(node->right)){
+            AVLIndex left = _link(node->left);
+            _arena_release_outer(arena, tree);
+            return left;
         }
-    }
+        else{
+            OuterNode* max_of_left = _find_max_o(arena, _link(node->left));
+            node->key = max_of_left->key;
+            node->inner = max_of_left->inner; //A referência do nó removido abaixo passa para node.
 
-    return tree;
+            AVLIndex left = _remove_o(arena, layout, _link(node->left), node->key);
+            _set_link(&_outer_node(arena, tree)->left, left);
+        }
+    }
 
+    return _rebalance_o(arena, layout, tree);
 }
+
 /**
- * @brief Encontra o maior nó (mais à direita) em uma árvore interna.
- *
- * @param tree raiz da árvore interna.
- * @return Ponteiro para o nó máximo ou NULL se a árvore estiver vazia.
+ * @brief Vetor de chaves de uma folha B+, curta ou completa.
  */
-static InnerNode * _find_max_i (InnerNode * tree){
-    if(tree == NULL){
-        return NULL;
+static int* _leaf_keys(BTreeNode* node){
+    if(node->capacity == AVL_BTREE_SMALL_LEAF_CAPACITY){
+        return ((BTreeSmallLeaf*) node)->keys;
     }
-    if(tree -> right == NULL){
-        return tree;
+    return ((BTreeLeaf*) node)->keys;
+}
+
+/**
+ * @brief Vetor de valores de uma folha B+, curta ou completa.
+ */
+static float* _leaf_values(BTreeNode* node){
+    if(node->capacity == AVL_BTREE_SMALL_LEAF_CAPACITY){
+        return ((BTreeSmallLeaf*) node)->values;
     }
-    return _find_max_i(tree -> right);
+    return ((BTreeLeaf*) node)->values;
 }
 
 /**
- * @brief Encontra o maior nó (mais à direita) em uma árvore externa.
+ * @brief Conta as chaves menores que key (posição de inserção) num vetor ordenado curto.
  *
- * @param tree raiz da árvore externa.
- * @return Ponteiro para o nó máximo ou NULL se a árvore estiver vazia.
+ * Sem desvios dependentes dos dados: com no máximo 7 chaves, a varredura completa é mais
+ * barata que uma busca binária e o compilador pode vetorizá-la.
  */
-static OuterNode * _find_max_o (OuterNode * tree){
-    if(tree == NULL){
-        return NULL;
+static int _block_lower(const int* keys, int count, int key){
+    int rank = 0;
+    for(int p = 0; p < count; p++){
+        rank += keys[p] < key;
     }
-    if(tree -> right == NULL){
-        return tree;
+    return rank;
+}
+
+/**
+ * @brief Conta as chaves menores ou iguais a key: índice do filho que contém key.
+ */
+static int _block_upper(const int* keys, int count, int key){
+    int rank = 0;
+    for(int p = 0; p < count; p++){
+        rank += keys[p] <= key;
     }
-    return _find_max_o(tree -> right);
+    return rank;
 }
 
 /**
- * @brief Remove chave da árvore interna e rebalanceia.
+ * @brief Cria uma folha B+ com os elementos [low, high) de vetores ordenados.
  *
- * @param tree raiz da árvore interna.
- * @param remove_key coluna a remover.
- * @return Nova raiz da subárvore após remoção.
+ * @param arena arena da matriz.
+ * @param small 1 para uma folha curta (high - low <= 3).
+ * @param keys, values elementos em ordem crescente de chave.
+ * @param low, high intervalo a copiar.
+ */
+static BTreeNode* _new_leaf_b(AVLArena* arena, int small, const int* keys, const float* values, int low, int high){
+    BTreeNode* leaf = _arena_block(arena, small);
+    leaf->capacity = small ? AVL_BTREE_SMALL_LEAF_CAPACITY : AVL_BTREE_LEAF_CAPACITY;
+    leaf->count = high - low;
+    int* leaf_keys = _leaf_keys(leaf);
+    float* leaf_values = _leaf_values(leaf);
+    for(int p = low; p < high; p++){
+        leaf_keys[p - low] = keys[p];
+        leaf_values[p - low] = values[p];
+    }
+    return leaf;
+}
+
+/**
+ * @brief Busca uma chave na árvore B+ de uma fileira.
+ *
+ * @param node raiz da árvore (ou NULL).
+ * @param key chave buscada.
+ * @return Ponteiro para o valor armazenado ou NULL se a chave não existir.
  */
-static InnerNode * _remove_i(InnerNode* tree, int remove_key){
-    if(tree == NULL){
+static float* _find_b(BTreeNode* node, int key){
+    if(!node){
         return NULL;
     }
-    if(tree -> key < remove_key){
-        tree->right = _remove_i(tree->right, remove_key);
+    while(node->capacity == 0){
+        BTreeBranch* branch = (BTreeBranch*) node;
+        node = branch->children[_block_upper(branch->keys, node->count, key)];
     }
-    else if(tree->key > remove_key){
-        tree->left = _remove_i(tree->left, remove_key);
+    int* keys = _leaf_keys(node);
+    int position = _block_lower(keys, node->count, key);
+    if(position < node->count && keys[position] == key){
+        return &_leaf_values(node)[position];
     }
-    else{
-        if(tree->left == NULL){ //Sem filho esquerdo ou sem filhos
-            InnerNode* right = tree->right;
-            free(tree);
-            return right; //No caso sem filhos, retorna NULL
-        }
-        else if(tree->right == NULL){//Sem filho direito
-            InnerNode* left = tree->left;
-            free(tree);
-            return left;
+    return NULL;
+}
+
+/**
+ * @brief Insere (ou atualiza) key numa subárvore B+, dividindo nós cheios na volta.
+ *
+ * @param arena arena da matriz.
+ * @param node raiz da subárvore (não nula).
+ * @param key chave a inserir.
+ * @param value valor associado.
+ * @param already_existed escrito com 1 se a chave já existia.
+ * @param split saída: novo irmão à direita, ou NULL se não houve divisão.
+ * @param split_key saída: menor chave de *split.
+ * @return Raiz da subárvore (uma folha curta cheia é trocada por uma completa).
+ */
+static BTreeNode* _insert_b_node(AVLArena* arena, BTreeNode* node, int key, float value, int* already_existed, BTreeNode** split, int* split_key){
+    *split = NULL;
+    if(node->capacity != 0){
+        int* keys = _leaf_keys(node);
+        float* values = _leaf_values(node);
+        int position = _block_lower(keys, node->count, key);
+        if(position < node->count && keys[position] == key){
+            values[position] = value;
+            *already_existed = 1;
+            return node;
+        }
+        if(node->count == AVL_BTREE_SMALL_LEAF_CAPACITY && node->capacity == AVL_BTREE_SMALL_LEAF_CAPACITY){
+            BTreeNode* grown = _new_leaf_b(arena, 0, keys, values, 0, node->count);
+            _arena_release_block(arena, node);
+            node = grown;
+            keys = _leaf_keys(node);
+            values = _leaf_values(node);
+        }
+        if(node->count < node->capacity){
+            for(int p = node->count; p > position; p--){
+                keys[p] = keys[p - 1];
+                values[p] = values[p - 1];
+            }
+            keys[position] = key;
+            values[position] = value;
+            node->count++;
+            return node;
         }
-        else{ //Dois filhos
-            InnerNode* max_of_left = _find_max_i(tree->left);
-            tree->key = max_of_left->key;
-            tree->data = max_of_left->data;
 
-            tree->left = _remove_i(tree->left, max_of_left->key);
+        //Folha completa cheia: as 8 chaves são divididas 4/4.
+        int all_keys[AVL_BTREE_LEAF_CAPACITY + 1];
+        float all_values[AVL_BTREE_LEAF_CAPACITY + 1];
+        for(int p = 0, q = 0; p <= AVL_BTREE_LEAF_CAPACITY; p++){
+            if(p == position){
+                all_keys[p] = key;
+                all_values[p] = value;
+            }
+            else{
+                all_keys[p] = keys[q];
+                all_values[p] = values[q];
+                q++;
+            }
         }
-    }
-    if(tree == NULL){//Se a remoção esvaziou essa sub-árvore, nada a fazer.
-        return NULL;
+        int half = (AVL_BTREE_LEAF_CAPACITY + 1) / 2;
+        for(int p = 0; p < half; p++){
+            keys[p] = all_keys[p];
+            values[p] = all_values[p];
+        }
+        node->count = half;
+        *split = _new_leaf_b(arena, 0, all_keys, all_values, half, AVL_BTREE_LEAF_CAPACITY + 1);
+        *split_key = all_keys[half];
+        return node;
+    }
+
+    BTreeBranch* branch = (BTreeBranch*) node;
+    int child = _block_upper(branch->keys, node->count, key);
+    BTreeNode* child_split;
+    int child_key;
+    branch->children[child] = _insert_b_node(arena, branch->children[child], key, value, already_existed, &child_split, &child_key);
+    if(!child_split){
+        return node;
+    }
+    if(node->count < AVL_BTREE_BRANCH_CAPACITY){
+        for(int p = node->count; p > child; p--){
+            branch->keys[p] = branch->keys[p - 1];
+            branch->children[p + 1] = branch->children[p];
+        }
+        branch->keys[child] = child_key;
+        branch->children[child + 1] = child_split;
+        node->count++;
+        return node;
     }
 
-    tree->height = 1 + _max(_height_i(tree->left), _height_i(tree->right));
+    //Nó interno cheio: 5 separadores e 6 filhos; o separador do meio sobe.
+    int all_keys[AVL_BTREE_BRANCH_CAPACITY + 1];
+    BTreeNode* all_children[AVL_BTREE_BRANCH_CAPACITY + 2];
+    for(int p = 0, q = 0; p <= AVL_BTREE_BRANCH_CAPACITY; p++){
+        all_keys[p] = p == child ? child_key : branch->keys[q++];
+    }
+    for(int p = 0, q = 0; p <= AVL_BTREE_BRANCH_CAPACITY + 1; p++){
+        all_children[p] = p == child + 1 ? child_split : branch->children[q++];
+    }
+    int half = AVL_BTREE_BRANCH_CAPACITY / 2;
+    BTreeBranch* right = (BTreeBranch*) _arena_block(arena, 0);
+    right->header.capacity = 0;
+    right->header.count = AVL_BTREE_BRANCH_CAPACITY - half;
+    for(int p = 0; p < half; p++){
+        branch->keys[p] = all_keys[p];
+    }
+    for(int p = 0; p <= half; p++){
+        branch->children[p] = all_children[p];
+    }
+    node->count = half;
+    for(int p = 0; p < right->header.count; p++){
+        right->keys[p] = all_keys[half + 1 + p];
+    }
+    for(int p = 0; p <= right->header.count; p++){
+        right->children[p] = all_children[half + 1 + p];
+    }
+    *split = &right->header;
+    *split_key = all_keys[half];
+    return node;
+}
 
-    int bf = _balance_factor_i(tree);
+/**
+ * @brief Insere (ou atualiza) key na árvore B+ de uma fileira.
+ *
+ * @param arena arena da matriz.
+ * @param root raiz atual (NULL cria uma folha curta).
+ * @param key chave a inserir.
+ * @param value valor associado.
+ * @param already_existed escrito com 1 se a chave já existia.
+ * @return Nova raiz.
+ */
+static BTreeNode* _insert_b(AVLArena* arena, BTreeNode* root, int key, float value, int* already_existed){
+    if(!root){
+        return _new_leaf_b(arena, 1, &key, &value, 0, 1);
+    }
+    BTreeNode* split;
+    int split_key;
+    root = _insert_b_node(arena, root, key, value, already_existed, &split, &split_key);
+    if(!split){
+        return root;
+    }
+    BTreeBranch* new_root = (BTreeBranch*) _arena_block(arena, 0);
+    new_root->header.capacity = 0;
+    new_root->header.count = 1;
+    new_root->keys[0] = split_key;
+    new_root->children[0] = root;
+    new_root->children[1] = split;
+    return &new_root->header;
+}
 
-    if(bf > 1){//Sub-árvore esquerda grande
-        int sub_bf = _balance_factor_i(tree->left);
-        if(sub_bf >= 0){//Causa é a sub-árvore esquerda do filho esquerdo: LL
-            return _right_rotate_i(tree);
+/**
+ * @brief Funde o filho left com o vizinho left + 1 se os dois couberem em um nó.
+ *
+ * Mantém a ocupação dos nós após remoções sem redistribuição elemento a elemento.
+ *
+ * @param arena arena da matriz.
+ * @param branch nó interno pai.
+ * @param left índice do filho da esquerda (left < count).
+ * @return 1 se os filhos foram fundidos.
+ */
+static int _merge_children_b(AVLArena* arena, BTreeBranch* branch, int left){
+    BTreeNode* a = branch->children[left];
+    BTreeNode* b = branch->children[left + 1];
+    if(a->capacity != 0){
+        if(a->count + b->count > a->capacity){
+            return 0;
         }
-        else{//Causa é a sub-árvore direita do filho esquerdo: LR
-            tree -> left = _left_rotate_i(tree -> left);
-            return _right_rotate_i(tree);
+        int* a_keys = _leaf_keys(a);
+        float* a_values = _leaf_values(a);
+        int* b_keys = _leaf_keys(b);
+        float* b_values = _leaf_values(b);
+        for(int p = 0; p < b->count; p++){
+            a_keys[a->count + p] = b_keys[p];
+            a_values[a->count + p] = b_values[p];
         }
+        a->count += b->count;
     }
-    if(bf < -1){//Sub-árvore direita grande
-        int sub_bf = _balance_factor_i(tree->right);
-        if(sub_bf < 0){//Causa é a sub-árvore direita do filho direito: RR
-            return _left_rotate_i(tree);
+    else{
+        if(a->count + 1 + b->count > AVL_BTREE_BRANCH_CAPACITY){
+            return 0;
         }
-        else{//Causa é a sub-árvore esquerda do filho direito: RL
-            tree -> right = _right_rotate_i(tree -> right);
-            return _left_rotate_i(tree);
+        BTreeBranch* a_branch = (BTreeBranch*) a;
+        BTreeBranch* b_branch = (BTreeBranch*) b;
+        a_branch->keys[a->count] = branch->keys[left];
+        for(int p = 0; p < b->count; p++){
+            a_branch->keys[a->count + 1 + p] = b_branch->keys[p];
         }
+        for(int p = 0; p <= b->count; p++){
+            a_branch->children[a->count + 1 + p] = b_branch->children[p];
+        }
+        a->count += 1 + b->count;
+    }
+    _arena_release_block(arena, b);
+    for(int p = left; p < branch->header.count - 1; p++){
+        branch->keys[p] = branch->keys[p + 1];
+        branch->children[p + 1] = branch->children[p + 2];
     }
+    branch->header.count--;
+    return 1;
+}
 
-    return tree;
+/**
+ * @brief Remove key de uma subárvore B+, descartando nós que ficarem vazios.
+ *
+ * Todas as folhas continuam na mesma profundidade: um filho só desaparece quando fica
+ * vazio ou é fundido a um irmão do mesmo nível.
+ *
+ * @param arena arena da matriz.
+ * @param node raiz da subárvore (não nula).
+ * @param key chave a remover.
+ * @return Raiz da subárvore ou NULL se ela ficou vazia.
+ */
+static BTreeNode* _remove_b_node(AVLArena* arena, BTreeNode* node, int key){
+    if(node->capacity != 0){
+        int* keys = _leaf_keys(node);
+        float* values = _leaf_values(node);
+        int position = _block_lower(keys, node->count, key);
+        if(position >= node->count || keys[position] != key){
+            return node;
+        }
+        for(int p = position; p < node->count - 1; p++){
+            keys[p] = keys[p + 1];
+            values[p] = values[p + 1];
+        }
+        node->count--;
+        if(node->count == 0){
+            _arena_release_block(arena, node);
+            return NULL;
+        }
+        return node;
+    }
 
+    BTreeBranch* branch = (BTreeBranch*) node;
+    int child = _block_upper(branch->keys, node->count, key);
+    BTreeNode* remaining = _remove_b_node(arena, branch->children[child], key);
+    if(remaining){
+        branch->children[child] = remaining;
+        if(!(child < node->count && _merge_children_b(arena, branch, child)) && child > 0){
+            _merge_children_b(arena, branch, child - 1);
+        }
+        return node;
+    }
+    if(node->count == 0){
+        _arena_release_block(arena, node);
+        return NULL;
+    }
+    int separator = child > 0 ? child - 1 : 0;
+    for(int p = separator; p < node->count - 1; p++){
+        branch->keys[p] = branch->keys[p + 1];
+    }
+    for(int p = child; p < node->count; p++){
+        branch->children[p] = branch->children[p + 1];
+    }
+    node->count--;
+    return node;
 }
 
 /**
- * @brief Remove fileira e rebalanceia a árvore externa.
- * 
- * Só deve ser chamado para a remoção "estrutural" do nó,
- * não limpa o conteúdo interno dele. Planejado para a
- * remoção de um nó já vazio.
+ * @brief Remove key da árvore B+ de uma fileira, encolhendo a raiz quando possível.
  *
- * @param tree raiz da árvore externa.
- * @param remove_key fileira a remover.
- * @return Nova raiz da subárvore após remoção.
+ * @param arena arena da matriz.
+ * @param root raiz atual (não nula).
+ * @param key chave a remover.
+ * @return Nova raiz ou NULL se a fileira ficou vazia.
+ */
+static BTreeNode* _remove_b(AVLArena* arena, BTreeNode* root, int key){
+    root = _remove_b_node(arena, root, key);
+    while(root && root->capacity == 0 && root->count == 0){
+        BTreeNode* child = ((BTreeBranch*) root)->children[0];
+        _arena_release_block(arena, root);
+        root = child;
+    }
+    return root;
+}
+
+/**
+ * @brief Constrói uma subárvore B+ de altura fixa a partir de chaves ordenadas.
+ *
+ * O intervalo é repartido igualmente entre o menor número de filhos capaz de contê-lo,
+ * de modo que todas as folhas ficam na mesma profundidade e pelo menos meio cheias.
+ *
+ * @param arena arena de onde os nós são obtidos.
+ * @param keys, values elementos em ordem crescente de chave.
+ * @param low, high intervalo (não vazio) a construir.
+ * @param depth níveis de nós internos acima das folhas.
+ * @param child_span número máximo de elementos sob cada filho (7 * 5^(depth-1)).
+ */
+static BTreeNode* _build_b_level(AVLArena* arena, const int* keys, const float* values, int low, int high, int depth, long long child_span){
+    if(depth == 0){
+        return _new_leaf_b(arena, 0, keys, values, low, high);
+    }
+    int size = high - low;
+    int parts = (int) ((size + child_span - 1) / child_span);
+    BTreeBranch* branch = (BTreeBranch*) _arena_block(arena, 0);
+    branch->header.capacity = 0;
+    branch->header.count = parts - 1;
+    for(int part = 0; part < parts; part++){
+        int start = low + (int) ((long long) size * part / parts);
+        int end = low + (int) ((long long) size * (part + 1) / parts);
+        if(part > 0){
+            branch->keys[part - 1] = keys[start];
+        }
+        branch->children[part] = _build_b_level(arena, keys, values, start, end, depth - 1, child_span / (AVL_BTREE_BRANCH_CAPACITY + 1));
+    }
+    return &branch->header;
+}
+
+/**
+ * @brief Constrói a árvore B+ de uma fileira a partir de chaves ordenadas, em tempo linear.
+ *
+ * @param arena arena de onde os nós são obtidos.
+ * @param keys, values elementos em ordem crescente de chave.
+ * @param low, high intervalo a construir.
+ * @return Raiz da árvore (NULL se o intervalo for vazio).
  */
-static OuterNode * _remove_o(OuterNode* tree, int remove_key){
-    if(tree == NULL){
+static BTreeNode* _build_b(AVLArena* arena, const int* keys, const float* values, int low, int high){
+    int size = high - low;
+    if(size <= 0){
         return NULL;
     }
-    if(tree -> key < remove_key){
-        tree->right = _remove_o(tree->right, remove_key);
+    if(size <= AVL_BTREE_SMALL_LEAF_CAPACITY){
+        return _new_leaf_b(arena, 1, keys, values, low, high);
     }
-    else if(tree->key > remove_key){
-        tree->left = _remove_o(tree->left, remove_key);
+    int depth = 0;
+    long long span = AVL_BTREE_LEAF_CAPACITY;
+    while(span < size){
+        span *= AVL_BTREE_BRANCH_CAPACITY + 1;
+        depth++;
     }
-    else{
-        if(tree->left == NULL){
-            OuterNode* right = tree->right;
-            free(tree);
-            return right;
-        }
-        else if(tree->right == NULL){
-            OuterNode* left = tree->left;
-            free(tree);
-            return left;
-        }
-        else{
-            OuterNode* max_of_left = _find_max_o(tree->left);
-            tree->key = max_of_left->key;
-            tree->inner_tree = max_of_left->inner_tree;
+    return _build_b_level(arena, keys, values, low, high, depth, span / (AVL_BTREE_BRANCH_CAPACITY + 1));
+}
 
-            tree->left = _remove_o(tree->left, max_of_left->key);
+/**
+ * @brief Lista em ordem as chaves e valores de uma árvore B+.
+ *
+ * @param node raiz da árvore (ou NULL).
+ * @param keys vetor de chaves de saída.
+ * @param values vetor de valores de saída.
+ * @param position ponteiro com posição inicial dos vetores.
+ */
+static void _flatten_b(BTreeNode* node, int* keys, float* values, int* position){
+    if(!node){
+        return;
+    }
+    if(node->capacity == 0){
+        for(int p = 0; p <= node->count; p++){
+            _flatten_b(((BTreeBranch*) node)->children[p], keys, values, position);
         }
+        return;
+    }
+    int* leaf_keys = _leaf_keys(node);
+    float* leaf_values = _leaf_values(node);
+    for(int p = 0; p < node->count; p++){
+        keys[*position + p] = leaf_keys[p];
+        values[*position + p] = leaf_values[p];
     }
+    *position = *position + node->count;
+}
 
-    if(tree == NULL){
+/**
+ * @brief Clona profundamente uma árvore B+.
+ *
+ * @param arena arena de destino dos nós clonados.
+ * @param node raiz a copiar.
+ * @return Raiz clonada.
+ */
+static BTreeNode* _clone_b(AVLArena* arena, BTreeNode* node){
+    if(!node){
         return NULL;
     }
+    if(node->capacity != 0){
+        return _new_leaf_b(arena, node->capacity == AVL_BTREE_SMALL_LEAF_CAPACITY, _leaf_keys(node), _leaf_values(node), 0, node->count);
+    }
+    BTreeBranch* source = (BTreeBranch*) node;
+    BTreeBranch* copy = (BTreeBranch*) _arena_block(arena, 0);
+    copy->header = source->header;
+    copy->header.references = 1;
+    for(int p = 0; p < node->count; p++){
+        copy->keys[p] = source->keys[p];
+    }
+    for(int p = 0; p <= node->count; p++){
+        copy->children[p] = _clone_b(arena, source->children[p]);
+    }
+    return &copy->header;
+}
 
-    tree->height = 1 + _max(_height_o(tree->left), _height_o(tree->right));
-
-    int bf = _balance_factor_o(tree);
+/**
+ * @brief Garante que a fileira B+ não é compartilhada antes de modificá-la.
+ *
+ * As fileiras B+ são copiadas inteiras (e não só o caminho): seus nós não têm contagem
+ * própria, apenas a raiz conta quantos nós externos apontam para a fileira.
+ *
+ * @param arena arena da árvore.
+ * @param root raiz da fileira (ou NULL).
+ * @return A própria raiz, ou uma cópia exclusiva se ela era compartilhada.
+ */
+static BTreeNode* _own_b(AVLArena* arena, BTreeNode* root){
+    if(!root || root->references == 1){
+        return root;
+    }
+    root->references--;
+    return _clone_b(arena, root);
+}
 
-    if(bf > 1){
-        int sub_bf = _balance_factor_o(tree->left);
-        if(sub_bf >= 0){
-            return _right_rotate_o(tree);
-        }
-        else{
-            tree -> left = _left_rotate_o(tree -> left);
-            return _right_rotate_o(tree);
-        }
+/**
+ * @brief Multiplica todos os valores de uma árvore B+ por um escalar.
+ *
+ * @param node raiz da árvore.
+ * @param a fator escalar.
+ */
+static void _scalar_multiply_b(BTreeNode* node, float a){
+    if(!node){
+        return;
     }
-    if(bf < -1){
-        int sub_bf = _balance_factor_o(tree->right);
-        if(sub_bf < 0){
-            return _left_rotate_o(tree);
-        }
-        else{
-            tree -> right = _right_rotate_o(tree -> right);
-            return _left_rotate_o(tree);
+    if(node->capacity == 0){
+        for(int p = 0; p <= node->count; p++){
+            _scalar_multiply_b(((BTreeBranch*) node)->children[p], a);
         }
+        return;
+    }
+    float* values = _leaf_values(node);
+    for(int p = 0; p < node->count; p++){
+        values[p] = values[p] * a;
     }
-
-    return tree;
 }
 
 /**
- * @brief Libera recursivamente uma árvore interna.
+ * @brief Devolve à arena todos os blocos de uma árvore B+.
  *
- * @param tree raiz da árvore interna a ser desalocada (ou NULL).
+ * @param arena arena da árvore.
+ * @param node raiz da árvore (ou NULL).
  */
-static void _free_i_tree(InnerNode* tree){
-    if(tree == NULL){
+static void _release_b(AVLArena* arena, BTreeNode* node){
+    if(!node){
         return;
     }
-    _free_i_tree(tree->left);
-    _free_i_tree(tree->right);
-    free(tree);
-    return;
+    if(node->capacity == 0){
+        for(int p = 0; p <= node->count; p++){
+            _release_b(arena, ((BTreeBranch*) node)->children[p]);
+        }
+    }
+    _arena_release_block(arena, node);
 }
 
 /**
- * @brief Libera recursivamente árvore externa e todas as internas associadas.
+ * @brief Solta uma referência a uma árvore interna de uma arena compartilhada.
  *
- * @param tree raiz da árvore externa a ser desalocada (ou NULL).
+ * Só desce para os filhos de nós que perdem a última referência; o resto continua em uso pelas outras árvores.
+ *
+ * @param arena arena compartilhada (com contagens ligadas).
+ * @param tree raiz a soltar.
  */
-static void _free_o_tree(OuterNode* tree){
-    if(tree == NULL){
+static void _release_i_tree(AVLArena* arena, AVLIndex tree){
+    if(!tree || arena->inner.references[tree]-- > 0){
         return;
     }
-    _free_o_tree(tree->left);
-    _free_o_tree(tree->right);
-    _free_i_tree(tree->inner_tree);
-    free(tree);
-    return;
+    InnerNode* node = _inner_node(arena, tree);
+    _release_i_tree(arena, _link(node->left));
+    _release_i_tree(arena, _link(node->right));
+    _arena_release_inner(arena, tree);
 }
 
 /**
- * @brief Clona profundamente uma árvore interna.
+ * @brief Solta uma referência a uma árvore externa de uma arena compartilhada, com suas linhas.
  *
- * @param tree raiz a copiar.
- * @return Ponteiro para a nova raiz clonada.
+ * @param arena arena compartilhada (com contagens ligadas).
+ * @param layout layout das linhas.
+ * @param tree raiz a soltar.
  */
-static InnerNode* _clone_i_tree(InnerNode* tree){
-    if(!tree){
-        return NULL;
+static void _release_o_tree(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree){
+    if(!tree || arena->outer.references[tree]-- > 0){
+        return;
     }
-    InnerNode* new_node = malloc(sizeof(InnerNode));
-    if(!new_node){
-        _allocation_fail();
+    OuterNode* node = _outer_node(arena, tree);
+    _release_o_tree(arena, layout, _link(node->left));
+    _release_o_tree(arena, layout, _link(node->right));
+    if(layout == AVL_INNER_BTREE){
+        BTreeNode* row = node->inner.btree;
+        if(row && --row->references == 0){
+            _release_b(arena, row);
+        }
     }
-    new_node->key = tree->key;
-    new_node->data = tree->data;
-    new_node->height = tree->height;
-    new_node->left = _clone_i_tree(tree->left);
-    new_node->right = _clone_i_tree(tree->right);
-    return new_node;
+    else{
+        _release_i_tree(arena, node->inner.tree);
+    }
+    _arena_release_outer(arena, tree);
 }
 
 /**
- * @brief Clona profundamente a árvore externa e cada árvore interna.
+ * @brief Desliga uma árvore da sua arena.
  *
- * @param tree raiz a copiar.
- * @return Ponteiro para a nova raiz clonada.
+ * Se a árvore era a única usuária, a arena inteira é liberada em O(blocos). Senão, só os nós
+ * que nenhuma outra árvore referencia voltam às listas livres; quando sobra um usuário, as
+ * contagens são desligadas.
+ *
+ * @param arena arena da árvore (não deve mais ser usada pelo chamador).
+ * @param layout layout das linhas.
+ * @param root raiz da árvore.
  */
-static OuterNode* _clone_o_tree(OuterNode* tree){
-    if(!tree){
-        return NULL;
+static void _arena_leave(AVLArena* arena, AVLInnerLayout layout, AVLIndex root){
+    if(arena->users == 1){
+        _arena_destroy(arena);
+        free(arena);
+        return;
     }
-    OuterNode* new_node = malloc(sizeof(OuterNode));
-    if(!new_node){
-        _allocation_fail();
+    _release_o_tree(arena, layout, root);
+    arena->users--;
+    if(arena->users == 1){
+        _pool_track_references(arena, &arena->inner, 0);
+        _pool_track_references(arena, &arena->outer, 0);
     }
-    new_node->key = tree->key;
-    new_node->height = tree->height;
-    new_node->inner_tree = _clone_i_tree(tree->inner_tree);
-    new_node->left = _clone_o_tree(tree->left);
-    new_node->right = _clone_o_tree(tree->right);
-    return new_node;
 }
 
 /**
- * @brief Copia conteúdo de uma matriz para outra, recriando ambas as árvores.
+ * @brief Esvazia a matriz liberando de uma vez todos os nós das duas árvores.
  *
- * @param source origem (já validada).
- * @param dest destino, que terá árvores antigas liberadas.
+ * @param matrix matriz a esvaziar (dimensões preservadas).
  */
-static AVLStatus _copy_matrix(AVLMatrix* source, AVLMatrix* dest){
-    if(!source || !dest){
-        return AVL_ERROR_NULL_MATRIX;
+static void _clear_matrix(AVLMatrix* matrix){
+    _arena_leave(matrix->main_arena, matrix->inner_layout, matrix->main_root);
+    _arena_leave(matrix->transposed_arena, matrix->inner_layout, matrix->transposed_root);
+    matrix->main_arena = _arena_create();
+    matrix->transposed_arena = _arena_create();
+    matrix->main_root = 0;
+    matrix->transposed_root = 0;
+    matrix->k = 0;
+    matrix->transposed_stale = 0;
+}
+
+/**
+ * @brief No modo preguiçoso, descarta a transposta antes de uma escrita em main_root.
+ *
+ * Como a transposta tem arena própria, o descarte libera os blocos inteiros em O(blocos)
+ * (ou só os nós exclusivos dela, se a arena é compartilhada com uma cópia).
+ *
+ * @param matrix matriz prestes a ser modificada.
+ */
+static void _invalidate_transposed(AVLMatrix* matrix){
+    if(matrix->transpose_mode != AVL_TRANSPOSE_LAZY || matrix->transposed_stale){
+        return;
     }
-    if(source == dest){
+    _arena_leave(matrix->transposed_arena, matrix->inner_layout, matrix->transposed_root);
+    matrix->transposed_arena = _arena_create();
+    matrix->transposed_root = 0;
+    matrix->transposed_stale = 1;
+}
+
+/**
+ * @brief Clona profundamente uma árvore interna.
+ *
+ * @param arena arena de destino dos nós clonados.
+ * @param source arena da árvore copiada.
+ * @param tree raiz a copiar.
+ * @return Índice da nova raiz clonada.
+ */
+static AVLIndex _clone_i_tree(AVLArena* arena, const AVLArena* source, AVLIndex tree){
+    if(!tree){
+        return 0;
+    }
+    InnerNode* node = _inner_node(source, tree);
+    AVLIndex new_index = _arena_inner(arena);
+    AVLIndex left = _clone_i_tree(arena, source, _link(node->left));
+    AVLIndex right = _clone_i_tree(arena, source, _link(node->right));
+    InnerNode* new_node = _inner_node(arena, new_index);
+    new_node->key = node->key;
+    new_node->data = node->data;
+    new_node->left = node->left; //Copia os bits de altura; os índices são trocados abaixo.
+    new_node->right = node->right;
+    _set_link(&new_node->left, left);
+    _set_link(&new_node->right, right);
+    return new_index;
+}
+
+/**
+ * @brief Clona profundamente a árvore externa e cada árvore interna.
+ *
+ * @param arena arena de destino dos nós clonados.
+ * @param source arena da árvore copiada.
+ * @param layout layout das fileiras (o mesmo na origem e no destino).
+ * @param tree raiz a copiar.
+ * @return Índice da nova raiz clonada.
+ */
+static AVLIndex _clone_o_tree(AVLArena* arena, const AVLArena* source, AVLInnerLayout layout, AVLIndex tree){
+    if(!tree){
+        return 0;
+    }
+    OuterNode* node = _outer_node(source, tree);
+    AVLIndex new_index = _arena_outer(arena);
+    AVLInnerRoot inner;
+    if(layout == AVL_INNER_BTREE){
+        inner.btree = _clone_b(arena, node->inner.btree);
+    }
+    else{
+        inner.tree = _clone_i_tree(arena, source, node->inner.tree);
+    }
+    AVLIndex left = _clone_o_tree(arena, source, layout, _link(node->left));
+    AVLIndex right = _clone_o_tree(arena, source, layout, _link(node->right));
+    OuterNode* new_node = _outer_node(arena, new_index);
+    new_node->key = node->key;
+    new_node->inner = inner;
+    new_node->left = node->left;
+    new_node->right = node->right;
+    _set_link(&new_node->left, left);
+    _set_link(&new_node->right, right);
+    return new_index;
+}
+
+/**
+ * @brief Troca uma árvore de arena compartilhada por um clone numa arena exclusiva.
+ *
+ * @param arena arena da árvore (atualizada).
+ * @param root raiz da árvore (atualizada).
+ * @param layout layout das fileiras.
+ */
+static void _unshare_tree(AVLArena** arena, AVLIndex* root, AVLInnerLayout layout){
+    if((*arena)->users == 1){
+        return;
+    }
+    AVLArena* private_arena = _arena_create();
+    AVLIndex private_root = _clone_o_tree(private_arena, *arena, layout, *root);
+    _arena_leave(*arena, layout, *root);
+    *arena = private_arena;
+    *root = private_root;
+}
+
+/**
+ * @brief Garante que nenhuma das árvores da matriz divide nós com outra matriz.
+ *
+ * Necessário antes de operações que alteram todos os nós de uma vez, como a escala.
+ *
+ * @param matrix matriz a tornar exclusiva.
+ */
+static void _unshare_matrix(AVLMatrix* matrix){
+    _unshare_tree(&matrix->main_arena, &matrix->main_root, matrix->inner_layout);
+    _unshare_tree(&matrix->transposed_arena, &matrix->transposed_root, matrix->inner_layout);
+}
+
+/**
+ * @brief Multiplica todos os nós de uma árvore interna por um escalar.
+ *
+ * @param arena arena da árvore.
+ * @param tree raiz da árvore interna.
+ * @param a fator escalar.
+ */
+static void _scalar_multiply_i_tree(const AVLArena* arena, AVLIndex tree, float a){
+    if(!tree){
+        return;
+    }
+    InnerNode* node = _inner_node(arena, tree);
+    _scalar_multiply_i_tree(arena, _link(node->left), a);
+    node->data = node->data * a;
+    _scalar_multiply_i_tree(arena, _link(node->right), a);
+}
+
+/**
+ * @brief Multiplica todos os valores armazenados na árvore externa (todas as fileiras) por um escalar.
+ *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
+ * @param tree raiz da árvore externa.
+ * @param a fator escalar.
+ */
+static void _scalar_multiply_o_tree(const AVLArena* arena, AVLInnerLayout layout, AVLIndex tree, float a){
+    if(!tree){
+        return;
+    }
+    OuterNode* node = _outer_node(arena, tree);
+    _scalar_multiply_o_tree(arena, layout, _link(node->left), a);
+    if(layout == AVL_INNER_BTREE){
+        _scalar_multiply_b(node->inner.btree, a);
+    }
+    else{
+        _scalar_multiply_i_tree(arena, node->inner.tree, a);
+    }
+    _scalar_multiply_o_tree(arena, layout, _link(node->right), a);
+}
+
+/**
+ * @brief Lista em ordem os nós de uma árvore externa.
+ *
+ * @param arena arena da árvore.
+ * @param tree raiz da árvore externa.
+ * @param nodes vetor de saída (espaço para todos os nós).
+ * @param position ponteiro com posição inicial do vetor.
+ */
+static void _collect_o(const AVLArena* arena, AVLIndex tree, OuterNode** nodes, int* position){
+    if(!tree){
+        return;
+    }
+    OuterNode* node = _outer_node(arena, tree);
+    _collect_o(arena, _link(node->left), nodes, position);
+    nodes[*position] = node;
+    *position = *position + 1;
+    _collect_o(arena, _link(node->right), nodes, position);
+}
+
+/**
+ * @brief Lista em ordem as chaves e valores de uma árvore interna.
+ *
+ * @param arena arena da árvore.
+ * @param tree raiz da árvore interna.
+ * @param keys vetor de chaves de saída.
+ * @param values vetor de valores de saída.
+ * @param position ponteiro com posição inicial dos vetores.
+ */
+static void _flatten_i(const AVLArena* arena, AVLIndex tree, int* keys, float* values, int* position){
+    if(!tree){
+        return;
+    }
+    InnerNode* node = _inner_node(arena, tree);
+    _flatten_i(arena, _link(node->left), keys, values, position);
+    keys[*position] = node->key;
+    values[*position] = node->data;
+    *position = *position + 1;
+    _flatten_i(arena, _link(node->right), keys, values, position);
+}
+
+/**
+ * @brief Constrói uma árvore interna perfeitamente balanceada a partir de chaves ordenadas.
+ *
+ * O elemento central de [low, high) vira a raiz; nenhuma rotação é necessária.
+ *
+ * @param arena arena de onde os nós são obtidos.
+ * @param keys chaves em ordem crescente.
+ * @param values valores paralelos a keys.
+ * @param low início do intervalo (inclusivo).
+ * @param high fim do intervalo (exclusivo).
+ * @return Raiz da árvore construída (0 se o intervalo for vazio).
+ */
+static AVLIndex _build_i(AVLArena* arena, const int* keys, const float* values, int low, int high){
+    if(low >= high){
+        return 0;
+    }
+    int middle = low + (high - low) / 2;
+    AVLIndex index = _arena_inner(arena);
+    AVLIndex left = _build_i(arena, keys, values, low, middle);
+    AVLIndex right = _build_i(arena, keys, values, middle + 1, high);
+    InnerNode* node = _inner_node(arena, index);
+    node->key = keys[middle];
+    node->data = values[middle];
+    node->left = left;
+    node->right = right;
+    _update_height_i(arena, node);
+    return index;
+}
+
+/**
+ * @brief Busca key na fileira, qualquer que seja o layout.
+ *
+ * @return Ponteiro para o valor armazenado ou NULL se ausente.
+ */
+static float* _inner_find(const AVLArena* arena, AVLInnerLayout layout, AVLInnerRoot root, int key){
+    if(layout == AVL_INNER_BTREE){
+        return _find_b(root.btree, key);
+    }
+    InnerNode* node = _find_node_i(arena, root.tree, key);
+    return node ? &node->data : NULL;
+}
+
+/**
+ * @brief Insere (ou atualiza) key na fileira, qualquer que seja o layout.
+ *
+ * @return Nova raiz da fileira.
+ */
+static AVLInnerRoot _inner_insert(AVLArena* arena, AVLInnerLayout layout, AVLInnerRoot root, int key, float value, int* already_existed){
+    if(layout == AVL_INNER_BTREE){
+        root.btree = _insert_b(arena, _own_b(arena, root.btree), key, value, already_existed);
+    }
+    else{
+        root.tree = _insert_i(arena, root.tree, key, value, already_existed);
+    }
+    return root;
+}
+
+/**
+ * @brief Remove key da fileira, qualquer que seja o layout.
+ *
+ * @return Nova raiz da fileira (vazia se não restar elemento).
+ */
+static AVLInnerRoot _inner_remove(AVLArena* arena, AVLInnerLayout layout, AVLInnerRoot root, int key){
+    if(layout == AVL_INNER_BTREE){
+        root.btree = _remove_b(arena, _own_b(arena, root.btree), key);
+    }
+    else{
+        root.tree = _remove_i(arena, root.tree, key);
+    }
+    return root;
+}
+
+/**
+ * @brief Indica se a fileira não tem elementos, qualquer que seja o layout.
+ */
+static int _inner_empty(AVLInnerLayout layout, AVLInnerRoot root){
+    return layout == AVL_INNER_BTREE ? root.btree == NULL : root.tree == 0;
+}
+
+/**
+ * @brief Constrói uma fileira a partir de chaves ordenadas, qualquer que seja o layout.
+ */
+static AVLInnerRoot _inner_build(AVLArena* arena, AVLInnerLayout layout, const int* keys, const float* values, int low, int high){
+    AVLInnerRoot root;
+    if(layout == AVL_INNER_BTREE){
+        root.btree = _build_b(arena, keys, values, low, high);
+    }
+    else{
+        root.tree = _build_i(arena, keys, values, low, high);
+    }
+    return root;
+}
+
+/**
+ * @brief Lista em ordem os elementos de uma fileira, qualquer que seja o layout.
+ */
+static void _inner_flatten(const AVLArena* arena, AVLInnerLayout layout, AVLInnerRoot root, int* keys, float* values, int* position){
+    if(layout == AVL_INNER_BTREE){
+        _flatten_b(root.btree, keys, values, position);
+    }
+    else{
+        _flatten_i(arena, root.tree, keys, values, position);
+    }
+}
+
+/**
+ * @brief Estado de uma atualização in loco (upsert) de um elemento.
+ *
+ * A mesma operação é aplicada às duas árvores: na principal o callback decide o novo
+ * valor; na transposta, update é NULL e o valor já decidido é gravado.
+ */
+typedef struct AVLUpsert{
+    AVLUpsertFunction update; /**< Callback do usuário (NULL para gravar value). */
+    void* context;            /**< Contexto repassado ao callback. */
+    float value;              /**< Valor final do elemento (0.0 se ficou ausente). */
+    int change;               /**< +1 se o elemento foi criado, -1 se removido, 0 caso contrário. */
+    int modified;             /**< 1 se o valor armazenado mudou. */
+} AVLUpsert;
+
+/**
+ * @brief Decide o novo valor de um elemento e registra o efeito no estado do upsert.
+ *
+ * @param op estado do upsert.
+ * @param current valor atual (0.0 se ausente).
+ * @param existed 1 se o elemento existe.
+ * @return Novo valor (0.0 para remover ou não criar).
+ */
+static float _upsert_value(AVLUpsert* op, float current, int existed){
+    float value = op->update ? op->update(current, existed, op->context) : op->value;
+    op->value = value;
+    op->change = existed ? -(value == 0.0f) : value != 0.0f;
+    op->modified = value != current;
+    return value;
+}
+
+/**
+ * @brief Atualiza, cria ou remove key numa árvore interna com uma única descida.
+ *
+ * @param arena arena da árvore.
+ * @param tree raiz da árvore interna.
+ * @param key coluna do elemento.
+ * @param op estado do upsert.
+ * @return Nova raiz da subárvore.
+ */
+static AVLIndex _upsert_i(AVLArena* arena, AVLIndex tree, int key, AVLUpsert* op){
+    if(!tree){
+        float value = _upsert_value(op, 0.0f, 0);
+        return value != 0.0f ? _insert_i(arena, 0, key, value, NULL) : 0;
+    }
+    tree = _own_i(arena, tree);
+    InnerNode* node = _inner_node(arena, tree);
+    if(node->key == key){
+        float value = _upsert_value(op, node->data, 1);
+        if(value == 0.0f){
+            return _remove_i(arena, tree, key); //tree já é o nó procurado: a remoção não desce de novo.
+        }
+        _inner_node(arena, tree)->data = value;
+        return tree;
+    }
+    if(node->key < key){
+        AVLIndex right = _upsert_i(arena, _link(node->right), key, op);
+        _set_link(&_inner_node(arena, tree)->right, right);
+    }
+    else{
+        AVLIndex left = _upsert_i(arena, _link(node->left), key, op);
+        _set_link(&_inner_node(arena, tree)->left, left);
+    }
+    if(op->change == 0){ //Só o valor mudou: as alturas do caminho (e dos irmãos) não precisam ser lidas.
+        return tree;
+    }
+    return _rebalance_i(arena, tree);
+}
+
+/**
+ * @brief Atualiza, cria ou remove key na fileira, qualquer que seja o layout.
+ *
+ * No layout B+ uma atualização de valor é feita no lugar encontrado pela busca; só
+ * criações e remoções (que podem dividir ou fundir nós) descem de novo.
+ *
+ * @return Nova raiz da fileira.
+ */
+static AVLInnerRoot _inner_upsert(AVLArena* arena, AVLInnerLayout layout, AVLInnerRoot root, int key, AVLUpsert* op){
+    if(layout != AVL_INNER_BTREE){
+        root.tree = _upsert_i(arena, root.tree, key, op);
+        return root;
+    }
+    float* stored = _find_b(root.btree, key);
+    float value = _upsert_value(op, stored ? *stored : 0.0f, stored != NULL);
+    if(!op->modified){
+        return root;
+    }
+    if(stored && value != 0.0f && root.btree->references == 1){
+        *stored = value;
+    }
+    else if(value != 0.0f){
+        int already_existed = 0;
+        root.btree = _insert_b(arena, _own_b(arena, root.btree), key, value, &already_existed);
+    }
+    else{
+        root.btree = _remove_b(arena, _own_b(arena, root.btree), key);
+    }
+    return root;
+}
+
+/**
+ * @brief Atualiza, cria ou remove o elemento (row, column) numa árvore externa.
+ *
+ * A fileira é localizada pela busca iterativa (sem rebalancear o caminho) e o elemento
+ * é tratado com uma única descida nela. Só a criação de uma fileira nova ou a remoção
+ * de uma fileira que ficou vazia descem de novo na árvore externa.
+ *
+ * @param arena arena da árvore.
+ * @param layout layout das fileiras.
+ * @param tree raiz da árvore externa.
+ * @param row fileira do elemento.
+ * @param column posição do elemento na fileira.
+ * @param op estado do upsert.
+ * @return Nova raiz da árvore externa.
+ */
+static AVLIndex _upsert_o(AVLArena* arena, AVLInnerLayout layout, AVLIndex tree, int row, int column, AVLUpsert* op){
+    tree = _own_path_o(arena, layout, tree, row);
+    OuterNode* node = _find_node_o(arena, tree, row);
+    if(!node){
+        AVLInnerRoot inner = _inner_upsert(arena, layout, (AVLInnerRoot){.btree = NULL}, column, op);
+        return _inner_empty(layout, inner) ? tree : _insert_o(arena, layout, tree, row, inner);
+    }
+    node->inner = _inner_upsert(arena, layout, node->inner, column, op);
+    if(_inner_empty(layout, node->inner)){
+        return _remove_o(arena, layout, tree, row);
+    }
+    return tree;
+}
+
+/**
+ * @brief Constrói uma árvore externa perfeitamente balanceada a partir de fileiras ordenadas.
+ *
+ * @param arena arena de onde os nós são obtidos.
+ * @param keys fileiras em ordem crescente.
+ * @param inner_roots fileiras (em qualquer layout) paralelas a keys.
+ * @param low início do intervalo (inclusivo).
+ * @param high fim do intervalo (exclusivo).
+ * @return Raiz da árvore construída (0 se o intervalo for vazio).
+ */
+static AVLIndex _build_o(AVLArena* arena, const int* keys, const AVLInnerRoot* inner_roots, int low, int high){
+    if(low >= high){
+        return 0;
+    }
+    int middle = low + (high - low) / 2;
+    AVLIndex index = _arena_outer(arena);
+    AVLIndex left = _build_o(arena, keys, inner_roots, low, middle);
+    AVLIndex right = _build_o(arena, keys, inner_roots, middle + 1, high);
+    OuterNode* node = _outer_node(arena, index);
+    node->key = keys[middle];
+    node->inner = inner_roots[middle];
+    node->left = left;
+    node->right = right;
+    _update_height_o(arena, node);
+    return index;
+}
+/**
+ * @brief Soma duas árvores externas por intercalação, fileira a fileira.
+ *
+ * As fileiras das duas árvores são percorridas em ordem; fileiras presentes em ambas têm
+ * suas árvores internas achatadas e intercaladas como vetores ordenados. Somas nulas são
+ * descartadas e cada fileira resultante vira uma árvore balanceada construída diretamente,
+ * em O(nnz(A) + nnz(B) + fileiras) no total.
+ *
+ * @param arena arena de onde os nós do resultado são obtidos.
+ * @param layout layout das fileiras do resultado.
+ * @param a_arena arena da primeira árvore.
+ * @param a raiz da primeira árvore externa.
+ * @param a_layout layout das fileiras de a.
+ * @param b_arena arena da segunda árvore.
+ * @param b raiz da segunda árvore externa.
+ * @param b_layout layout das fileiras de b.
+ * @param outer_dim número de fileiras possíveis (limite de nós externos).
+ * @param inner_dim tamanho de cada fileira (limite de nós internos por fileira).
+ * @param k saída: número de elementos do resultado.
+ * @return Raiz da árvore externa resultante.
+ */
+static AVLIndex _merge_sum_o(AVLArena* arena, AVLInnerLayout layout, const AVLArena* a_arena, AVLIndex a, AVLInnerLayout a_layout, const AVLArena* b_arena, AVLIndex b, AVLInnerLayout b_layout, int outer_dim, int inner_dim, int* k){
+    size_t outer_size = outer_dim > 0 ? (size_t) outer_dim : 1;
+    size_t inner_size = inner_dim > 0 ? (size_t) inner_dim : 1;
+    OuterNode** a_rows = malloc(sizeof(OuterNode*) * outer_size);
+    OuterNode** b_rows = malloc(sizeof(OuterNode*) * outer_size);
+    int* out_rows = malloc(sizeof(int) * outer_size);
+    AVLInnerRoot* out_trees = malloc(sizeof(AVLInnerRoot) * outer_size);
+    int* a_keys = malloc(sizeof(int) * inner_size);
+    float* a_values = malloc(sizeof(float) * inner_size);
+    int* b_keys = malloc(sizeof(int) * inner_size);
+    float* b_values = malloc(sizeof(float) * inner_size);
+    int* out_keys = malloc(sizeof(int) * inner_size);
+    float* out_values = malloc(sizeof(float) * inner_size);
+    if(!a_rows || !b_rows || !out_rows || !out_trees || !a_keys || !a_values || !b_keys || !b_values || !out_keys || !out_values){
+        _allocation_fail();
+    }
+
+    int a_count = 0;
+    int b_count = 0;
+    _collect_o(a_arena, a, a_rows, &a_count);
+    _collect_o(b_arena, b, b_rows, &b_count);
+
+    int row_count = 0;
+    int pa = 0;
+    int pb = 0;
+    *k = 0;
+    while(pa < a_count || pb < b_count){
+        int row;
+        int a_size = 0;
+        int b_size = 0;
+        if(pb >= b_count || (pa < a_count && a_rows[pa]->key < b_rows[pb]->key)){
+            row = a_rows[pa]->key;
+            _inner_flatten(a_arena, a_layout, a_rows[pa++]->inner, a_keys, a_values, &a_size);
+        } else if(pa >= a_count || b_rows[pb]->key < a_rows[pa]->key){
+            row = b_rows[pb]->key;
+            _inner_flatten(b_arena, b_layout, b_rows[pb++]->inner, b_keys, b_values, &b_size);
+        } else {
+            row = a_rows[pa]->key;
+            _inner_flatten(a_arena, a_layout, a_rows[pa++]->inner, a_keys, a_values, &a_size);
+            _inner_flatten(b_arena, b_layout, b_rows[pb++]->inner, b_keys, b_values, &b_size);
+        }
+
+        int out_size = 0;
+        int qa = 0;
+        int qb = 0;
+        while(qa < a_size || qb < b_size){
+            int key;
+            float value;
+            if(qb >= b_size || (qa < a_size && a_keys[qa] < b_keys[qb])){
+                key = a_keys[qa];
+                value = a_values[qa++];
+            } else if(qa >= a_size || b_keys[qb] < a_keys[qa]){
+                key = b_keys[qb];
+                value = b_values[qb++];
+            } else {
+                key = a_keys[qa];
+                value = a_values[qa++] + b_values[qb++];
+            }
+            if(value != 0.0f){
+                out_keys[out_size] = key;
+                out_values[out_size] = value;
+                out_size++;
+            }
+        }
+
+        if(out_size > 0){
+            out_rows[row_count] = row;
+            out_trees[row_count] = _inner_build(arena, layout, out_keys, out_values, 0, out_size);
+            row_count++;
+            *k = *k + out_size;
+        }
+    }
+
+    AVLIndex root = _build_o(arena, out_rows, out_trees, 0, row_count);
+
+    free(a_rows);
+    free(b_rows);
+    free(out_rows);
+    free(out_trees);
+    free(a_keys);
+    free(a_values);
+    free(b_keys);
+    free(b_values);
+    free(out_keys);
+    free(out_values);
+    return root;
+}
+
+/**
+ * @brief Converte uma árvore externa para o formato CSR (fileiras comprimidas).
+ *
+ * @param arena arena da árvore.
+ * @param root raiz da árvore externa.
+ * @param layout layout das fileiras.
+ * @param rows número de fileiras possíveis.
+ * @param count número de elementos da árvore.
+ * @param ptr saída: vetor de rows+1 posições; a fileira r ocupa [ptr[r], ptr[r+1]).
+ * @param keys saída: chaves internas, crescentes dentro de cada fileira.
+ * @param values saída: valores paralelos a keys.
+ */
+static void _tree_to_csr(const AVLArena* arena, AVLIndex root, AVLInnerLayout layout, int rows, int count, int** ptr, int** keys, float** values){
+    OuterNode** nodes = malloc(sizeof(OuterNode*) * (rows > 0 ? rows : 1));
+    *ptr = calloc((size_t) rows + 1, sizeof(int));
+    *keys = malloc(sizeof(int) * (count > 0 ? count : 1));
+    *values = malloc(sizeof(float) * (count > 0 ? count : 1));
+    if(!nodes || !*ptr || !*keys || !*values){
+        _allocation_fail();
+    }
+    int node_count = 0;
+    _collect_o(arena, root, nodes, &node_count);
+
+    int position = 0;
+    int next_row = 0;
+    for(int t = 0; t < node_count; t++){
+        for(; next_row <= nodes[t]->key; next_row++){
+            (*ptr)[next_row] = position;
+        }
+        _inner_flatten(arena, layout, nodes[t]->inner, *keys, *values, &position);
+    }
+    for(; next_row <= rows; next_row++){
+        (*ptr)[next_row] = position;
+    }
+    free(nodes);
+}
+/**
+ * @brief Transposição por contagem em blocos contíguos de fileiras, um por tarefa do pool.
+ *
+ * Na fase 0 cada bloco conta as chaves das próprias fileiras; uma soma de prefixos
+ * entre as fases converte as contagens em posições iniciais de cada bloco dentro de cada
+ * fileira transposta, e na fase 1 cada bloco espalha seus elementos. Os blocos seguem a
+ * ordem das fileiras, então a saída é idêntica à da versão sequencial.
+ */
+typedef struct AVLTransposeJob{
+    int columns;
+    const int *ptr, *keys;
+    const float* values;
+    const int* bounds; /**< parts+1 posições; o bloco b ocupa as fileiras [bounds[b], bounds[b+1]). */
+    int* next;         /**< parts * columns contadores, um vetor por bloco. */
+    int* t_keys;
+    float* t_values;
+    int phase;
+} AVLTransposeJob;
+
+/**
+ * @brief Executa a fase atual de ::AVLTransposeJob nos blocos [begin, end).
+ */
+static void _transpose_blocks_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    AVLTransposeJob* job = context;
+    for(int b = begin; b < end; b++){
+        int* next = &job->next[(size_t) b * job->columns];
+        for(int r = job->bounds[b]; r < job->bounds[b + 1]; r++){
+            for(int p = job->ptr[r]; p < job->ptr[r + 1]; p++){
+                if(job->phase == 0){
+                    next[job->keys[p]]++;
+                    continue;
+                }
+                int position = next[job->keys[p]]++;
+                job->t_keys[position] = r;
+                job->t_values[position] = job->values[p];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Transpõe uma matriz em CSR por ordenação por contagem.
+ *
+ * Como as fileiras de origem são visitadas em ordem crescente, as chaves de cada
+ * fileira transposta também saem em ordem crescente. Com pool, as fileiras são divididas
+ * em blocos com número parecido de elementos, cada um com contadores próprios; o número
+ * de blocos é limitado para que os contadores não passem de algumas vezes o tamanho da matriz.
+ *
+ * @param pool pool que executa os blocos (NULL para sequencial).
+ * @param rows fileiras da origem.
+ * @param columns fileiras da transposta.
+ * @param ptr, keys, values matriz de origem em CSR.
+ * @param t_ptr, t_keys, t_values saída: transposta em CSR.
+ */
+static void _transpose_csr(ThreadPool* pool, int rows, int columns, const int* ptr, const int* keys, const float* values, int** t_ptr, int** t_keys, float** t_values){
+    int count = ptr[rows];
+    *t_ptr = calloc((size_t) columns + 1, sizeof(int));
+    *t_keys = malloc(sizeof(int) * (count > 0 ? count : 1));
+    *t_values = malloc(sizeof(float) * (count > 0 ? count : 1));
+    if(!*t_ptr || !*t_keys || !*t_values){
+        _allocation_fail();
+    }
+
+    int parts = thread_pool_size(pool);
+    while(parts > 1 && (long long) parts * columns > 4LL * ((long long) count + columns)){
+        parts--;
+    }
+    if(parts > rows){
+        parts = rows;
+    }
+    if(parts > 1){
+        int* bounds = malloc(sizeof(int) * ((size_t) parts + 1));
+        int* next = calloc((size_t) parts * columns, sizeof(int));
+        if(!bounds || !next){
+            _allocation_fail();
+        }
+        bounds[0] = 0;
+        int row = 0;
+        for(int b = 1; b < parts; b++){
+            long long target = (long long) count * b / parts;
+            while(row < rows && ptr[row] < target){
+                row++;
+            }
+            bounds[b] = row;
+        }
+        bounds[parts] = rows;
+
+        AVLTransposeJob job = {columns, ptr, keys, values, bounds, next, *t_keys, *t_values, 0};
+        parallel_for_thread_pool(pool, 0, parts, 1, THREAD_POOL_STEALING, _transpose_blocks_task, &job);
+        int position = 0;
+        for(int c = 0; c < columns; c++){
+            (*t_ptr)[c] = position;
+            for(int b = 0; b < parts; b++){
+                int block_count = next[(size_t) b * columns + c];
+                next[(size_t) b * columns + c] = position;
+                position += block_count;
+            }
+        }
+        (*t_ptr)[columns] = position;
+        job.phase = 1;
+        parallel_for_thread_pool(pool, 0, parts, 1, THREAD_POOL_STEALING, _transpose_blocks_task, &job);
+        free(bounds);
+        free(next);
+        return;
+    }
+
+    int* next = malloc(sizeof(int) * (columns > 0 ? columns : 1));
+    if(!next){
+        _allocation_fail();
+    }
+    for(int p = 0; p < count; p++){
+        (*t_ptr)[keys[p] + 1]++;
+    }
+    for(int c = 0; c < columns; c++){
+        (*t_ptr)[c + 1] += (*t_ptr)[c];
+        next[c] = (*t_ptr)[c];
+    }
+    for(int r = 0; r < rows; r++){
+        for(int p = ptr[r]; p < ptr[r + 1]; p++){
+            int position = next[keys[p]]++;
+            (*t_keys)[position] = r;
+            (*t_values)[position] = values[p];
+        }
+    }
+    free(next);
+}
+
+/**
+ * @brief Constrói uma árvore externa balanceada, com internas balanceadas, a partir de CSR.
+ *
+ * Fileiras vazias não geram nós. Custo linear no número de elementos e fileiras.
+ *
+ * @param arena arena de onde os nós são obtidos.
+ * @param layout layout das fileiras construídas.
+ * @param rows número de fileiras.
+ * @param ptr, keys, values matriz em CSR com chaves crescentes em cada fileira.
+ * @return Raiz da árvore externa.
+ */
+static AVLIndex _build_from_csr(AVLArena* arena, AVLInnerLayout layout, int rows, const int* ptr, const int* keys, const float* values){
+    int* row_keys = malloc(sizeof(int) * (rows > 0 ? rows : 1));
+    AVLInnerRoot* inner_roots = malloc(sizeof(AVLInnerRoot) * (rows > 0 ? rows : 1));
+    if(!row_keys || !inner_roots){
+        _allocation_fail();
+    }
+    int row_count = 0;
+    for(int r = 0; r < rows; r++){
+        if(ptr[r + 1] > ptr[r]){
+            row_keys[row_count] = r;
+            inner_roots[row_count] = _inner_build(arena, layout, keys, values, ptr[r], ptr[r + 1]);
+            row_count++;
+        }
+    }
+    AVLIndex root = _build_o(arena, row_keys, inner_roots, 0, row_count);
+    free(row_keys);
+    free(inner_roots);
+    return root;
+}
+
+/**
+ * @brief Reconstrói transposed_root a partir de main_root se ela estiver desatualizada.
+ *
+ * Custo O(k + n + m): achatamento em CSR, transposição por contagem e construção balanceada.
+ *
+ * @param matrix matriz a atualizar.
+ */
+static void _ensure_transposed(AVLMatrix* matrix){
+    if(!matrix->transposed_stale){
+        return;
+    }
+    int *ptr, *keys, *t_ptr, *t_keys;
+    float *values, *t_values;
+    _tree_to_csr(matrix->main_arena, matrix->main_root, matrix->inner_layout, matrix->n, matrix->k, &ptr, &keys, &values);
+    _transpose_csr(thread_pool_global(), matrix->n, matrix->m, ptr, keys, values, &t_ptr, &t_keys, &t_values);
+    matrix->transposed_root = _build_from_csr(matrix->transposed_arena, matrix->inner_layout, matrix->m, t_ptr, t_keys, t_values);
+    matrix->transposed_stale = 0;
+    free(ptr);
+    free(keys);
+    free(values);
+    free(t_ptr);
+    free(t_keys);
+    free(t_values);
+}
+/**
+ * @brief Copia conteúdo de uma matriz para outra.
+ *
+ * Com o mesmo layout, o destino passa a compartilhar as arenas e as raízes da origem em O(1);
+ * as escritas seguintes em qualquer uma das duas copiam só o caminho que alteram.
+ *
+ * @param source origem (já validada).
+ * @param dest destino, que terá árvores antigas liberadas.
+ */
+static AVLStatus _copy_matrix(AVLMatrix* source, AVLMatrix* dest){
+    if(!source || !dest){
+        return AVL_ERROR_NULL_MATRIX;
+    }
+    if(source == dest){
+        return AVL_STATUS_OK;
+    }
+    AVLStatus status = _validate_matrix(source);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    _clear_matrix(dest);
+    if(dest->inner_layout == source->inner_layout){
+        _arena_leave(dest->main_arena, dest->inner_layout, 0);
+        dest->main_arena = _arena_share(source->main_arena);
+        _retain_o(dest->main_arena, source->main_root);
+        dest->main_root = source->main_root;
+        if(!source->transposed_stale){
+            _arena_leave(dest->transposed_arena, dest->inner_layout, 0);
+            dest->transposed_arena = _arena_share(source->transposed_arena);
+            _retain_o(dest->transposed_arena, source->transposed_root);
+            dest->transposed_root = source->transposed_root;
+        }
+        dest->transposed_stale = source->transposed_stale;
+    }
+    else{
+        //Layouts diferentes: as fileiras são reconstruídas a partir de CSR e a transposta, sob demanda.
+        int *ptr, *keys;
+        float* values;
+        _tree_to_csr(source->main_arena, source->main_root, source->inner_layout, source->n, source->k, &ptr, &keys, &values);
+        dest->main_root = _build_from_csr(dest->main_arena, dest->inner_layout, source->n, ptr, keys, values);
+        dest->transposed_stale = 1;
+        free(ptr);
+        free(keys);
+        free(values);
+    }
+    dest->k = source->k;
+    dest->n = source->n;
+    dest->m = source->m;
+    if(dest->transpose_mode == AVL_TRANSPOSE_EAGER){
+        _ensure_transposed(dest);
+    }
+    return AVL_STATUS_OK;
+}
+
+AVLStatus get_element_avl(AVLMatrix* matrix, int i, int j, float* out_value){
+    if(!out_value){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    AVLStatus status = _validate_matrix(matrix);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    *out_value = 0.0f;
+    status = _validate_indexes(matrix, i, j);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    OuterNode* o_node = _find_node_o(matrix->main_arena, matrix->main_root, i);
+    if(!o_node){
+        return AVL_STATUS_OK;
+    }
+    float* stored = _inner_find(matrix->main_arena, matrix->inner_layout, o_node->inner, j);
+    if(!stored){
+        return AVL_STATUS_OK;
+    }
+    *out_value = *stored;
+    return AVL_STATUS_OK;
+}
+
+AVLStatus insert_element_avl(AVLMatrix* matrix, float value, int i, int j){
+    AVLStatus status = _validate_indexes(matrix, i, j);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    int already_existed = 0;
+    AVLArena* arena = matrix->main_arena;
+    matrix->main_root = _own_path_o(arena, matrix->inner_layout, matrix->main_root, i);
+    OuterNode* o_node = _find_node_o(arena, matrix->main_root, i);
+    if(o_node){
+        o_node->inner = _inner_insert(arena, matrix->inner_layout, o_node->inner, j, value, &already_existed);
+    }
+    else{
+        AVLInnerRoot new_main_i_tree = _inner_insert(arena, matrix->inner_layout, (AVLInnerRoot){.btree = NULL}, j, value, &already_existed);
+        matrix -> main_root = _insert_o(arena, matrix->inner_layout, matrix->main_root, i, new_main_i_tree);
+    }
+    if(!already_existed){
+        matrix-> k = matrix -> k + 1;
+    }
+
+    if(matrix->transpose_mode == AVL_TRANSPOSE_LAZY){
+        _invalidate_transposed(matrix);
+        return AVL_STATUS_OK;
+    }
+
+    int transposed_existed = already_existed;
+    arena = matrix->transposed_arena;
+    matrix->transposed_root = _own_path_o(arena, matrix->inner_layout, matrix->transposed_root, j);
+    OuterNode* o_node_transposed = _find_node_o(arena, matrix->transposed_root, j);
+    if(o_node_transposed){
+        o_node_transposed->inner = _inner_insert(arena, matrix->inner_layout, o_node_transposed->inner, i, value, &transposed_existed);
+    }
+    else{
+        AVLInnerRoot new_transposed_i_tree = _inner_insert(arena, matrix->inner_layout, (AVLInnerRoot){.btree = NULL}, i, value, &transposed_existed);
+        matrix -> transposed_root = _insert_o(arena, matrix->inner_layout, matrix->transposed_root, j, new_transposed_i_tree);
+    }
+    return AVL_STATUS_OK;
+}
+
+AVLStatus upsert_element_avl(AVLMatrix* matrix, int i, int j, AVLUpsertFunction update, void* context){
+    if(!update){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    AVLStatus status = _validate_indexes(matrix, i, j);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    AVLUpsert op = {update, context, 0.0f, 0, 0};
+    matrix->main_root = _upsert_o(matrix->main_arena, matrix->inner_layout, matrix->main_root, i, j, &op);
+    matrix->k = matrix->k + op.change;
+    if(!op.modified){
+        return AVL_STATUS_OK;
+    }
+    if(matrix->transpose_mode == AVL_TRANSPOSE_LAZY){
+        _invalidate_transposed(matrix);
+        return AVL_STATUS_OK;
+    }
+    op.update = NULL;
+    matrix->transposed_root = _upsert_o(matrix->transposed_arena, matrix->inner_layout, matrix->transposed_root, j, i, &op);
+    return AVL_STATUS_OK;
+}
+
+/**
+ * @brief Callback de accumulate_element_avl: soma a parcela apontada por context.
+ */
+static float _accumulate_update(float current, int existed, void* context){
+    (void) existed;
+    return current + *(const float*) context;
+}
+
+AVLStatus accumulate_element_avl(AVLMatrix* matrix, float delta, int i, int j){
+    return upsert_element_avl(matrix, i, j, _accumulate_update, &delta);
+}
+
+AVLStatus delete_element_avl(AVLMatrix* matrix, int i, int j){
+    AVLStatus status = _validate_indexes(matrix, i, j);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+
+    AVLArena* arena = matrix->main_arena;
+    OuterNode* o_node_main = _find_node_o(arena, matrix->main_root, i);
+    if(!o_node_main){
+        return AVL_STATUS_NOT_FOUND;
+    }
+    if(!_inner_find(arena, matrix->inner_layout, o_node_main->inner, j)){
+        return AVL_STATUS_NOT_FOUND;
+    }
+    if(arena->outer.references){
+        matrix->main_root = _own_path_o(arena, matrix->inner_layout, matrix->main_root, i);
+        o_node_main = _find_node_o(arena, matrix->main_root, i);
+    }
+
+    o_node_main->inner = _inner_remove(arena, matrix->inner_layout, o_node_main->inner, j);
+    matrix -> k = matrix -> k - 1;
+
+    if(_inner_empty(matrix->inner_layout, o_node_main->inner)){
+        matrix->main_root = _remove_o(arena, matrix->inner_layout, matrix->main_root, i);
+    }
+
+    if(matrix->transpose_mode == AVL_TRANSPOSE_LAZY){
+        _invalidate_transposed(matrix);
         return AVL_STATUS_OK;
     }
-    AVLStatus status = _validate_matrix(source);
-    if(status != AVL_STATUS_OK){
-        return status;
+
+    arena = matrix->transposed_arena;
+    matrix->transposed_root = _own_path_o(arena, matrix->inner_layout, matrix->transposed_root, j);
+    OuterNode* o_node_transposed = _find_node_o(arena, matrix->transposed_root, j);
+    if(!o_node_transposed){
+        return AVL_ERROR_INVALID_ARGUMENT;
     }
-    _free_o_tree(dest->main_root);
-    _free_o_tree(dest->transposed_root);
-    dest->main_root = _clone_o_tree(source->main_root);
-    dest->transposed_root = _clone_o_tree(source->transposed_root);
-    dest->k = source->k;
-    dest->n = source->n;
-    dest->m = source->m;
+    o_node_transposed->inner = _inner_remove(arena, matrix->inner_layout, o_node_transposed->inner, i);
+    if(_inner_empty(matrix->inner_layout, o_node_transposed->inner)){
+        matrix->transposed_root = _remove_o(arena, matrix->inner_layout, matrix->transposed_root, j);
+    }
+
     return AVL_STATUS_OK;
 }
 
 /**
- * @brief Multiplica todos os nós de uma árvore interna por um escalar.
+ * @brief Prepara um cursor vazio sobre uma das árvores da matriz.
  *
- * @param tree raiz da árvore interna.
- * @param a fator escalar.
+ * @param cursor cursor a inicializar.
+ * @param matrix matriz percorrida (já validada).
+ * @param transposed 1 para percorrer transposed_root.
  */
-static void _scalar_multiply_i_tree(InnerNode* tree, float a){
-    if(!tree){
-        return;
-    }
-    _scalar_multiply_i_tree(tree->left, a);
-    tree->data = tree->data * a;
-    _scalar_multiply_i_tree(tree->right, a);
+static void _cursor_init(AVLCursor* cursor, AVLMatrix* matrix, int transposed){
+    cursor->arena = transposed ? matrix->transposed_arena : matrix->main_arena;
+    cursor->layout = matrix->inner_layout;
+    cursor->transposed = transposed;
+    cursor->row = -1;
+    cursor->high = INT_MAX;
+    cursor->outer_depth = 0;
+    cursor->inner_depth = 0;
+    cursor->leaf = NULL;
+    cursor->leaf_position = 0;
 }
 
 /**
- * @brief Multiplica todos os valores armazenados na árvore externa (todas as fileiras) por um escalar.
- *
- * @param tree raiz da árvore externa.
- * @param a fator escalar.
+ * @brief Empilha tree e seus descendentes à esquerda (próximas fileiras em ordem).
  */
-static void _scalar_multiply_o_tree(OuterNode* tree, float a){
-    if(!tree){
-        return;
+static void _cursor_push_o(AVLCursor* cursor, AVLIndex tree){
+    while(tree){
+        cursor->outer_stack[cursor->outer_depth++] = tree;
+        tree = _link(_outer_node(cursor->arena, tree)->left);
     }
-    _scalar_multiply_o_tree(tree->left, a);
-    _scalar_multiply_i_tree(tree->inner_tree, a);
-    _scalar_multiply_o_tree(tree->right, a);
 }
 
 /**
- * @brief Copia pares (i,j,valor) de uma árvore interna para vetores auxiliares.
+ * @brief Empilha o caminho de uma fileira AVL até a menor chave maior ou igual a low.
  *
- * @param inner_tree árvore interna.
- * @param I vetor de linhas.
- * @param J vetor de colunas.
- * @param Data vetor de valores.
- * @param position ponteiro com posição inicial dos vetores.
- * @param i índice de linha fixado.
+ * Nós com chave menor que low são atravessados sem empilhar: nem eles nem sua
+ * subárvore esquerda entram no percurso.
  */
-static void _copy_i(InnerNode* inner_tree, int* I, int* J, float* Data, int* position, int i){
-    if(!inner_tree){
-        return;
+static void _cursor_push_i(AVLCursor* cursor, AVLIndex tree, int low){
+    while(tree){
+        InnerNode* node = _inner_node(cursor->arena, tree);
+        if(node->key < low){
+            tree = _link(node->right);
+        }
+        else{
+            cursor->inner_stack[cursor->inner_depth++] = tree;
+            tree = _link(node->left);
+        }
     }
+}
 
-    _copy_i(inner_tree -> left, I, J, Data, position, i);
-    I[*position] = i;
-    J[*position] = inner_tree->key;
-    Data[*position] = inner_tree->data;
-    *position = *position + 1;
-    _copy_i(inner_tree -> right, I, J, Data, position, i);
-    return;
+/**
+ * @brief Desce de node até a folha B+ que contém a menor chave maior ou igual a low, empilhando o caminho.
+ */
+static void _cursor_descend_b(AVLCursor* cursor, BTreeNode* node, int low){
+    while(node && node->capacity == 0){
+        BTreeBranch* branch = (BTreeBranch*) node;
+        int position = _block_upper(branch->keys, node->count, low);
+        cursor->branch_stack[cursor->inner_depth] = branch;
+        cursor->branch_position[cursor->inner_depth] = position;
+        cursor->inner_depth++;
+        node = branch->children[position];
+    }
+    cursor->leaf = node;
+    cursor->leaf_position = node ? _block_lower(_leaf_keys(node), node->count, low) : 0;
 }
 
 /**
- * @brief Copia toda a matriz percorrendo a árvore externa e delegando para _copy_i.
- *
- * Resulta em vetores paralelos I,J,Data de tamanho k com todas as entradas não nulas.
- *
- * @param outer_tree raiz da árvore externa.
- * @param I vetor de linhas.
- * @param J vetor de colunas.
- * @param Data vetor de valores.
- * @param position ponteiro com posição inicial dos vetores.
+ * @brief Passa o cursor para a fileira do nó node, a partir da chave low.
  */
-static void _copy_o(OuterNode* outer_tree, int* I, int* J, float* Data, int* position){
-    if(!outer_tree){
-        return;
+static void _cursor_open_row(AVLCursor* cursor, const OuterNode* node, int low){
+    cursor->row = node->key;
+    cursor->inner_depth = 0;
+    if(cursor->layout == AVL_INNER_BTREE){
+        _cursor_descend_b(cursor, node->inner.btree, low);
+    }
+    else{
+        _cursor_push_i(cursor, node->inner.tree, low);
     }
-
-    _copy_o(outer_tree -> left, I, J, Data, position);
-    _copy_i(outer_tree->inner_tree, I, J, Data, position, outer_tree->key);
-    _copy_o(outer_tree-> right, I, J, Data, position);
-    return;
 }
 
 /**
- * @brief Acumula parcial de multiplicação de matrizes: atualiza linha de C com valores de A * B.
- *
- * Percorre a árvore interna correspondente à linha j de B (elementos B[j, c])
- * e, para cada coluna c ali presente, soma no resultado C a contribuição
- * A[i, j] * B[j, c]. O efeito é acumular na linha i de C todas as parcelas
- * referentes a um valor específico A[i, j], de modo que, com chamadas que
- * englobam todas as posições necessárias, a multiplicação de matriz ocorre
- * corretamente.
+ * @brief Próximo elemento da fileira atual.
  *
- * @param inner_tree árvore interna da linha j de B (colunas não nulas).
- * @param row linha alvo em C.
- * @param A_value valor A[i, j] correspondente.
- * @param C matriz resultado.
+ * @param cursor cursor posicionado numa fileira.
+ * @param key saída: chave do elemento.
+ * @param value saída: valor do elemento.
+ * @return 1 se há elemento, 0 se a fileira (ou o intervalo) acabou.
  */
-static AVLStatus _matmul_i_accumulate(InnerNode* inner_tree, int row, float A_value, AVLMatrix* C){
-    if(!inner_tree){
-        return AVL_STATUS_OK;
-    }
-    AVLStatus status = _matmul_i_accumulate(inner_tree->left, row, A_value, C);
-    if(status != AVL_STATUS_OK){
-        return status;
+static int _cursor_next_inner(AVLCursor* cursor, int* key, float* value){
+    if(cursor->layout != AVL_INNER_BTREE){
+        if(cursor->inner_depth == 0){
+            return 0;
+        }
+        AVLIndex tree = cursor->inner_stack[--cursor->inner_depth];
+        InnerNode* node = _inner_node(cursor->arena, tree);
+        if(node->key >= cursor->high){
+            cursor->inner_depth = 0;
+            return 0;
+        }
+        *key = node->key;
+        *value = node->data;
+        _cursor_push_i(cursor, _link(node->right), INT_MIN);
+        return 1;
+    }
+    while(cursor->leaf && cursor->leaf_position >= cursor->leaf->count){
+        //Folha esgotada: sobe até o primeiro nó com filho à direita ainda não visitado.
+        BTreeNode* next = NULL;
+        while(!next && cursor->inner_depth > 0){
+            int level = cursor->inner_depth - 1;
+            BTreeBranch* branch = cursor->branch_stack[level];
+            if(cursor->branch_position[level] < branch->header.count){
+                next = branch->children[++cursor->branch_position[level]];
+            }
+            else{
+                cursor->inner_depth--;
+            }
+        }
+        cursor->leaf = NULL;
+        if(next){
+            _cursor_descend_b(cursor, next, INT_MIN);
+        }
     }
-    float current = 0.0f;
-    status = get_element_avl(C, row, inner_tree->key, &current);
-    if(status != AVL_STATUS_OK){
-        return status;
+    if(!cursor->leaf){
+        return 0;
     }
-    status = insert_element_avl(C, current + (A_value * inner_tree->data), row, inner_tree->key);
-    if(status != AVL_STATUS_OK){
-        return status;
+    int stored_key = _leaf_keys(cursor->leaf)[cursor->leaf_position];
+    if(stored_key >= cursor->high){
+        cursor->leaf = NULL;
+        return 0;
     }
-    return _matmul_i_accumulate(inner_tree->right, row, A_value, C);
+    *key = stored_key;
+    *value = _leaf_values(cursor->leaf)[cursor->leaf_position];
+    cursor->leaf_position++;
+    return 1;
 }
 
-AVLStatus get_element_avl(AVLMatrix* matrix, int i, int j, float* out_value){
-    if(!out_value){
+AVLStatus begin_matrix_cursor_avl(AVLMatrix* matrix, AVLCursor* cursor){
+    if(!cursor){
         return AVL_ERROR_INVALID_ARGUMENT;
     }
     AVLStatus status = _validate_matrix(matrix);
     if(status != AVL_STATUS_OK){
         return status;
     }
-    *out_value = 0.0f;
-    status = _validate_indexes(matrix, i, j);
-    if(status != AVL_STATUS_OK){
-        return status;
-    }
-    OuterNode* o_node = _find_node_o(matrix->main_root, i);
-    if(!o_node){
-        return AVL_STATUS_OK;
-    }
-    InnerNode* i_node = _find_node_i(o_node->inner_tree, j);
-    if(!i_node){
-        return AVL_STATUS_OK;
-    }
-    *out_value = i_node -> data;
+    _cursor_init(cursor, matrix, 0);
+    _cursor_push_o(cursor, matrix->main_root);
     return AVL_STATUS_OK;
 }
 
-AVLStatus insert_element_avl(AVLMatrix* matrix, float value, int i, int j){
-    AVLStatus status = _validate_indexes(matrix, i, j);
+AVLStatus begin_row_range_cursor_avl(AVLMatrix* matrix, int i, int low, int high, AVLCursor* cursor){
+    if(!cursor){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    AVLStatus status = _validate_matrix(matrix);
     if(status != AVL_STATUS_OK){
         return status;
     }
-    int already_existed = 0;
-    OuterNode* o_node = _find_node_o(matrix->main_root, i);
-    if(o_node){
-        o_node->inner_tree = _insert_i(o_node->inner_tree, j, value, &already_existed);
-    }
-    else{
-        InnerNode* new_main_i_tree = _insert_i(NULL, j, value, &already_existed);
-        matrix -> main_root = _insert_o(matrix->main_root, i, new_main_i_tree);
-    }
-    if(!already_existed){
-        matrix-> k = matrix -> k + 1;
-    }
-
-    int transposed_existed = already_existed;
-    OuterNode* o_node_transposed = _find_node_o(matrix->transposed_root, j);
-    if(o_node_transposed){
-        o_node_transposed->inner_tree = _insert_i(o_node_transposed->inner_tree, i, value, &transposed_existed);
+    if(i < 0 || i >= matrix->n){
+        return AVL_ERROR_OUT_OF_BOUNDS;
     }
-    else{
-        InnerNode* new_transposed_i_tree = _insert_i(NULL, i, value, &transposed_existed);
-        matrix -> transposed_root = _insert_o(matrix->transposed_root, j, new_transposed_i_tree);
+    _cursor_init(cursor, matrix, 0);
+    cursor->high = high;
+    OuterNode* node = _find_node_o(cursor->arena, matrix->main_root, i);
+    if(node){
+        _cursor_open_row(cursor, node, low);
     }
     return AVL_STATUS_OK;
 }
 
-AVLStatus delete_element_avl(AVLMatrix* matrix, int i, int j){
-    AVLStatus status = _validate_indexes(matrix, i, j);
+AVLStatus begin_row_cursor_avl(AVLMatrix* matrix, int i, AVLCursor* cursor){
+    return begin_row_range_cursor_avl(matrix, i, INT_MIN, INT_MAX, cursor);
+}
+
+AVLStatus begin_column_cursor_avl(AVLMatrix* matrix, int j, AVLCursor* cursor){
+    if(!cursor){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    AVLStatus status = _validate_matrix(matrix);
     if(status != AVL_STATUS_OK){
         return status;
     }
-
-    OuterNode* o_node_main = _find_node_o(matrix->main_root, i);
-    if(!o_node_main){
-        return AVL_STATUS_NOT_FOUND;
-    }
-    InnerNode* i_node_main = _find_node_i(o_node_main->inner_tree, j);
-    if(!i_node_main){
-        return AVL_STATUS_NOT_FOUND;
+    if(j < 0 || j >= matrix->m){
+        return AVL_ERROR_OUT_OF_BOUNDS;
     }
-
-    o_node_main->inner_tree = _remove_i(o_node_main->inner_tree, j);
-    matrix -> k = matrix -> k - 1;
-
-    if(o_node_main->inner_tree == NULL){
-        matrix->main_root = _remove_o(matrix->main_root, i);
+    _ensure_transposed(matrix);
+    _cursor_init(cursor, matrix, 1);
+    OuterNode* node = _find_node_o(cursor->arena, matrix->transposed_root, j);
+    if(node){
+        _cursor_open_row(cursor, node, INT_MIN);
     }
+    return AVL_STATUS_OK;
+}
 
-    OuterNode* o_node_transposed = _find_node_o(matrix->transposed_root, j);
-    if(!o_node_transposed){
-        return AVL_ERROR_INVALID_ARGUMENT;
+int next_cursor_avl(AVLCursor* cursor, int* i, int* j, float* value){
+    if(!cursor || !i || !j || !value){
+        return 0;
     }
-    o_node_transposed->inner_tree = _remove_i(o_node_transposed->inner_tree, i);
-    if(o_node_transposed->inner_tree == NULL){
-        matrix->transposed_root = _remove_o(matrix->transposed_root, j);
-    }
-
-    return AVL_STATUS_OK;
+    int key;
+    float data;
+    while(!_cursor_next_inner(cursor, &key, &data)){
+        if(cursor->outer_depth == 0){
+            return 0;
+        }
+        AVLIndex tree = cursor->outer_stack[--cursor->outer_depth];
+        OuterNode* node = _outer_node(cursor->arena, tree);
+        _cursor_push_o(cursor, _link(node->right));
+        _cursor_open_row(cursor, node, INT_MIN);
+    }
+    *i = cursor->transposed ? key : cursor->row;
+    *j = cursor->transposed ? cursor->row : key;
+    *value = data;
+    return 1;
 }
 
 AVLStatus transpose_avl(AVLMatrix* matrix){
@@ -875,15 +2829,59 @@ AVLStatus transpose_avl(AVLMatrix* matrix){
     if(status != AVL_STATUS_OK){
         return status;
     }
-    OuterNode* temp = matrix -> main_root;
+    _ensure_transposed(matrix);
+    AVLIndex temp = matrix -> main_root;
     matrix -> main_root = matrix -> transposed_root;
     matrix -> transposed_root = temp;
+    AVLArena* temp_arena = matrix -> main_arena;
+    matrix -> main_arena = matrix -> transposed_arena;
+    matrix -> transposed_arena = temp_arena;
     int temp_dim = matrix->n;
     matrix->n = matrix->m;
     matrix->m = temp_dim;
     return AVL_STATUS_OK;
 }
 
+AVLStatus set_transpose_mode_avl(AVLMatrix* matrix, AVLTransposeMode mode){
+    AVLStatus status = _validate_matrix(matrix);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    if(mode != AVL_TRANSPOSE_EAGER && mode != AVL_TRANSPOSE_LAZY){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    if(mode == AVL_TRANSPOSE_EAGER){
+        _ensure_transposed(matrix);
+    }
+    matrix->transpose_mode = mode;
+    return AVL_STATUS_OK;
+}
+
+/**
+ * @brief Multiplicação por escalar das duas árvores de uma matriz (tarefa 0: principal, 1: transposta).
+ */
+typedef struct AVLScaleJob{
+    AVLMatrix* matrix;
+    float a;
+} AVLScaleJob;
+
+/**
+ * @brief Escala as árvores [begin, end) de ::AVLScaleJob; elas ficam em arenas distintas e podem rodar em paralelo.
+ */
+static void _scale_trees_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    AVLScaleJob* job = context;
+    AVLMatrix* matrix = job->matrix;
+    for(int tree = begin; tree < end; tree++){
+        if(tree == 0){
+            _scalar_multiply_o_tree(matrix->main_arena, matrix->inner_layout, matrix->main_root, job->a);
+        }
+        else{
+            _scalar_multiply_o_tree(matrix->transposed_arena, matrix->inner_layout, matrix->transposed_root, job->a);
+        }
+    }
+}
+
 AVLStatus scalar_mul_avl(AVLMatrix* A, AVLMatrix* B, float a){
     if(!A || !B){
         return AVL_ERROR_NULL_MATRIX;
@@ -903,24 +2901,17 @@ AVLStatus scalar_mul_avl(AVLMatrix* A, AVLMatrix* B, float a){
 
     if(A == B){
         if(a == 0.0f){
-            _free_o_tree(A->main_root);
-            _free_o_tree(A->transposed_root);
-            A->main_root = NULL;
-            A->transposed_root = NULL;
-            A->k = 0;
+            _clear_matrix(A);
             return AVL_STATUS_OK;
         }
-        _scalar_multiply_o_tree(A->main_root, a);
-        _scalar_multiply_o_tree(A->transposed_root, a);
+        _unshare_matrix(A);
+        AVLScaleJob job = {A, a};
+        parallel_for_thread_pool(thread_pool_global(), 0, 2, 1, THREAD_POOL_STEALING, _scale_trees_task, &job);
         return AVL_STATUS_OK;
     }
 
     if(a == 0.0f){
-        _free_o_tree(B->main_root);
-        _free_o_tree(B->transposed_root);
-        B->main_root = NULL;
-        B->transposed_root = NULL;
-        B->k = 0;
+        _clear_matrix(B);
         B->n = A->n;
         B->m = A->m;
         return AVL_STATUS_OK;
@@ -930,11 +2921,41 @@ AVLStatus scalar_mul_avl(AVLMatrix* A, AVLMatrix* B, float a){
     if(status != AVL_STATUS_OK){
         return status;
     }
-    _scalar_multiply_o_tree(B->main_root, a);
-    _scalar_multiply_o_tree(B->transposed_root, a);
+    _unshare_matrix(B);
+    AVLScaleJob job = {B, a};
+    parallel_for_thread_pool(thread_pool_global(), 0, 2, 1, THREAD_POOL_STEALING, _scale_trees_task, &job);
     return AVL_STATUS_OK;
 }
 
+/**
+ * @brief Soma por intercalação das duas árvores (tarefa 0: principal, 1: transposta) em arenas novas.
+ */
+typedef struct AVLSumJob{
+    AVLMatrix *A, *B;
+    AVLInnerLayout layout; /**< Layout das fileiras do resultado. */
+    AVLArena* arenas[2];
+    AVLIndex roots[2];     /**< Saída. */
+    int counts[2];         /**< Saída: elementos de cada árvore. */
+} AVLSumJob;
+
+/**
+ * @brief Intercala as árvores [begin, end) de ::AVLSumJob; A e B são apenas lidas.
+ */
+static void _sum_trees_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    AVLSumJob* job = context;
+    AVLMatrix* A = job->A;
+    AVLMatrix* B = job->B;
+    for(int tree = begin; tree < end; tree++){
+        if(tree == 0){
+            job->roots[0] = _merge_sum_o(job->arenas[0], job->layout, A->main_arena, A->main_root, A->inner_layout, B->main_arena, B->main_root, B->inner_layout, A->n, A->m, &job->counts[0]);
+        }
+        else{
+            job->roots[1] = _merge_sum_o(job->arenas[1], job->layout, A->transposed_arena, A->transposed_root, A->inner_layout, B->transposed_arena, B->transposed_root, B->inner_layout, A->m, A->n, &job->counts[1]);
+        }
+    }
+}
+
 AVLStatus sum_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C){
     if(!A || !B || !C){
         return AVL_ERROR_NULL_MATRIX;
@@ -948,57 +2969,69 @@ AVLStatus sum_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C){
         return status;
     }
 
-    status = _copy_matrix(B, C);
-    if(status != AVL_STATUS_OK){
-        return status;
-    }
-    int* I = NULL;
-    int* J = NULL;
-    float* Data = NULL;
-    if(A->k > 0){
-        I = (int*) malloc(sizeof(int) * A->k);
-        J = (int*) malloc(sizeof(int) * A->k);
-        Data = (float*) malloc(sizeof(float) * A-> k);
-        if(!I || !J || !Data){
-            if(I){
-                free(I);
-            }
-            if(J){
-                free(J);
-            }
-            if(Data){
-                free(Data);
-            }
-            _allocation_fail();
-        }
+    //As árvores novas vão para arenas próprias, então C pode ser a mesma matriz que A ou B.
+    int transposed_ready = !A->transposed_stale && !B->transposed_stale && C->transpose_mode == AVL_TRANSPOSE_EAGER;
+    AVLSumJob job = {A, B, C->inner_layout, {_arena_create(), _arena_create()}, {0, 0}, {0, 0}};
+    parallel_for_thread_pool(thread_pool_global(), 0, transposed_ready ? 2 : 1, 1, THREAD_POOL_STEALING, _sum_trees_task, &job);
+
+    _arena_leave(C->main_arena, C->inner_layout, C->main_root);
+    _arena_leave(C->transposed_arena, C->inner_layout, C->transposed_root);
+    C->main_arena = job.arenas[0];
+    C->transposed_arena = job.arenas[1];
+    C->main_root = job.roots[0];
+    C->transposed_root = job.roots[1];
+    C->transposed_stale = !transposed_ready;
+    C->k = job.counts[0];
+    if(C->transpose_mode == AVL_TRANSPOSE_EAGER){
+        _ensure_transposed(C);
     }
-    int position = 0;
-    _copy_o(A->main_root, I, J, Data, &position);
-    for(int pos = 0; pos < A->k; pos++){
-        float element = 0.0f;
-        status = get_element_avl(C, I[pos], J[pos], &element);
-        if(status != AVL_STATUS_OK){
-            free(I);
-            free(J);
-            free(Data);
-            return status;
-        }
-        status = insert_element_avl(C, element + Data[pos], I[pos], J[pos]);
-        if(status != AVL_STATUS_OK){
-            free(I);
-            free(J);
-            free(Data);
-            return status;
+    return AVL_STATUS_OK;
+}
+
+/**
+ * @brief Construção em lote das árvores principal e transposta a partir da mesma CSR.
+ *
+ * As duas árvores ficam em arenas distintas, então as tarefas 0 (principal) e
+ * 1 (transposta) podem rodar em paralelo no pool.
+ */
+typedef struct AVLBuildJob{
+    AVLInnerLayout layout;
+    int rows, columns;
+    const int* ptr;
+    const int* keys;
+    const float* values;
+    AVLArena* main_arena;
+    AVLArena* transposed_arena;
+    AVLIndex main_root;
+    AVLIndex transposed_root;
+} AVLBuildJob;
+
+/**
+ * @brief Constrói as árvores [begin, end) de ::AVLBuildJob; a transposta vem de uma segunda ordenação por contagem.
+ */
+static void _build_trees_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    AVLBuildJob* job = context;
+    for(int tree = begin; tree < end; tree++){
+        if(tree == 0){
+            job->main_root = _build_from_csr(job->main_arena, job->layout, job->rows, job->ptr, job->keys, job->values);
+            continue;
         }
+        int *t_ptr, *t_keys;
+        float* t_values;
+        _transpose_csr(NULL, job->rows, job->columns, job->ptr, job->keys, job->values, &t_ptr, &t_keys, &t_values);
+        job->transposed_root = _build_from_csr(job->transposed_arena, job->layout, job->columns, t_ptr, t_keys, t_values);
+        free(t_ptr);
+        free(t_keys);
+        free(t_values);
     }
-
-    free(I);
-    free(J);
-    free(Data);
-    return AVL_STATUS_OK;
 }
 
 AVLStatus matrix_mul_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C){
+    return matrix_mul_parallel_avl(A, B, C, thread_pool_global());
+}
+
+AVLStatus matrix_mul_parallel_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C, ThreadPool* pool){
     if(!A || !B || !C){
         return AVL_ERROR_NULL_MATRIX;
     }
@@ -1011,76 +3044,250 @@ AVLStatus matrix_mul_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C){
     if(A == C || B == C){ //Não vamos implementar multiplicação de matrizes "in-place" no momento
         return AVL_ERROR_NOT_IMPLEMENTED;
     }
-    _free_o_tree(C->main_root);
-    _free_o_tree(C->transposed_root);
-    C-> main_root = NULL;
-    C-> transposed_root = NULL;
-    C-> k = 0;
+    _clear_matrix(C);
     if(A ->k == 0 || B->k == 0){
         return AVL_STATUS_OK;
     }
-    int* I = NULL;
-    int* J = NULL;
-    float* Data = NULL;
-    if(A->k > 0){
-        I = (int*) malloc(sizeof(int) * A->k);
-        J = (int*) malloc(sizeof(int) * A->k);
-        Data = (float*) malloc(sizeof(float) * A-> k);
-        if(!I || !J || !Data){
-            if(I){
-                free(I);
-            }
-            if(J){
-                free(J);
-            }
-            if(Data){
-                free(Data);
-            }
-            _allocation_fail();
-        }
+
+    //Gustavson: C(i,:) = soma de A(i,j) * B(j,:), com A e B achatadas em CSR uma única vez.
+    int *a_ptr, *a_keys, *b_ptr, *b_keys;
+    float *a_values, *b_values;
+    _tree_to_csr(A->main_arena, A->main_root, A->inner_layout, A->n, A->k, &a_ptr, &a_keys, &a_values);
+    _tree_to_csr(B->main_arena, B->main_root, B->inner_layout, B->n, B->k, &b_ptr, &b_keys, &b_values);
+
+    //As linhas saem como sequências ordenadas, prontas para a construção balanceada.
+    int *c_ptr, *c_keys;
+    float* c_values;
+    int c_count = gustavson_csr(pool, A->n, C->m, a_ptr, a_keys, a_values, b_ptr, b_keys, b_values, 1, &c_ptr, &c_keys, &c_values);
+
+    int eager = C->transpose_mode == AVL_TRANSPOSE_EAGER;
+    AVLBuildJob build = {C->inner_layout, C->n, C->m, c_ptr, c_keys, c_values, C->main_arena, C->transposed_arena, 0, 0};
+    parallel_for_thread_pool(pool, 0, eager ? 2 : 1, 1, THREAD_POOL_STEALING, _build_trees_task, &build);
+    C->main_root = build.main_root;
+    C->k = c_count;
+    if(eager){
+        C->transposed_root = build.transposed_root;
     }
-    int position = 0;
-    _copy_o(A->main_root, I, J, Data, &position);
-    for(int pos = 0; pos < A->k; pos++){
-        OuterNode* B_row = _find_node_o(B->main_root, J[pos]);
-        if(B_row){
-            AVLStatus status = _matmul_i_accumulate(B_row->inner_tree, I[pos], Data[pos], C);
-            if(status != AVL_STATUS_OK){
-                free(I);
-                free(J);
-                free(Data);
-                return status;
-            }
-        }
+    else{
+        C->transposed_stale = 1;
+    }
+
+    free(a_ptr);
+    free(a_keys);
+    free(a_values);
+    free(b_ptr);
+    free(b_keys);
+    free(b_values);
+    free(c_ptr);
+    free(c_keys);
+    free(c_values);
+
+    return AVL_STATUS_OK;
+}
+
+AVLStatus spmv_avl(AVLMatrix* matrix, const float* x, float* y){
+    if(!x || !y){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    AVLStatus status = _validate_matrix(matrix);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    for(int i = 0; i < matrix->n; i++){
+        y[i] = 0.0f;
     }
+    AVLCursor cursor;
+    begin_matrix_cursor_avl(matrix, &cursor);
+    int i, j;
+    float value;
+    while(next_cursor_avl(&cursor, &i, &j, &value)){
+        y[i] += value * x[j];
+    }
+    return AVL_STATUS_OK;
+}
+
+AVLStatus spmv_transposed_avl(AVLMatrix* matrix, const float* x, float* y){
+    if(!x || !y){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    AVLStatus status = _validate_matrix(matrix);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    for(int j = 0; j < matrix->m; j++){
+        y[j] = 0.0f;
+    }
+    AVLCursor cursor;
+    begin_matrix_cursor_avl(matrix, &cursor);
+    int i, j;
+    float value;
+    while(next_cursor_avl(&cursor, &i, &j, &value)){
+        y[j] += value * x[i];
+    }
+    return AVL_STATUS_OK;
+}
 
-    free(I);
-    free(J);
-    free(Data);
-    
+AVLStatus to_csr_avl(AVLMatrix* matrix, int** row_ptr, int** columns, float** values){
+    if(!row_ptr || !columns || !values){
+        return AVL_ERROR_INVALID_ARGUMENT;
+    }
+    AVLStatus status = _validate_matrix(matrix);
+    if(status != AVL_STATUS_OK){
+        return status;
+    }
+    _tree_to_csr(matrix->main_arena, matrix->main_root, matrix->inner_layout, matrix->n, matrix->k, row_ptr, columns, values);
     return AVL_STATUS_OK;
 }
+
 AVLMatrix* create_matrix_avl(int n, int m){
+    return create_matrix_avl_with_layout(n, m, AVL_INNER_AVL);
+}
+
+AVLMatrix* create_matrix_avl_with_layout(int n, int m, AVLInnerLayout layout){
     if(n < 0 || m < 0){
         fprintf(stderr, "Error: matrix dimensions must be non-negative.\n");
         return NULL;
     }
+    if(layout != AVL_INNER_AVL && layout != AVL_INNER_BTREE){
+        fprintf(stderr, "Error: unknown inner layout.\n");
+        return NULL;
+    }
     AVLMatrix* matrix = malloc(sizeof(AVLMatrix));
     if(!matrix){
         _allocation_fail();
     }
-    matrix->main_root = NULL;
-    matrix->transposed_root = NULL;
+    matrix->main_root = 0;
+    matrix->transposed_root = 0;
     matrix->k = 0;
     matrix->n = n;
     matrix->m = m;
+    matrix->main_arena = _arena_create();
+    matrix->transposed_arena = _arena_create();
+    matrix->transpose_mode = AVL_TRANSPOSE_EAGER;
+    matrix->transposed_stale = 0;
+    matrix->inner_layout = layout;
+    return matrix;
+}
+/**
+ * @brief Ordena triplas por (linha, coluna) com radix sort LSD de dois passes.
+ *
+ * O primeiro passo distribui por coluna e o segundo, estável, por linha; o resultado
+ * já sai em CSR. Entre triplas repetidas fica a última da entrada (mesma semântica de
+ * inserções sucessivas) e valores nulos são descartados.
+ *
+ * @param n, m dimensões da matriz.
+ * @param k número de triplas.
+ * @param I, J, values triplas de entrada (índices já validados).
+ * @param ptr, keys, out_values saída: matriz em CSR.
+ * @return Número de elementos não nulos distintos.
+ */
+static int _triplets_to_csr(int n, int m, int k, const int* I, const int* J, const float* values, int** ptr, int** keys, float** out_values){
+    int* by_column = malloc(sizeof(int) * (k > 0 ? k : 1));
+    int* order = malloc(sizeof(int) * (k > 0 ? k : 1));
+    int* column_start = calloc((size_t) m + 1, sizeof(int));
+    *ptr = calloc((size_t) n + 1, sizeof(int));
+    *keys = malloc(sizeof(int) * (k > 0 ? k : 1));
+    *out_values = malloc(sizeof(float) * (k > 0 ? k : 1));
+    if(!by_column || !order || !column_start || !*ptr || !*keys || !*out_values){
+        _allocation_fail();
+    }
+
+    for(int t = 0; t < k; t++){
+        column_start[J[t] + 1]++;
+    }
+    for(int c = 0; c < m; c++){
+        column_start[c + 1] += column_start[c];
+    }
+    for(int t = 0; t < k; t++){
+        by_column[column_start[J[t]]++] = t;
+    }
+
+    //ptr[r + 1] conta a linha r; depois da soma de prefixos, ptr[r] é a próxima posição livre da linha r.
+    for(int t = 0; t < k; t++){
+        (*ptr)[I[t] + 1]++;
+    }
+    for(int r = 0; r < n; r++){
+        (*ptr)[r + 1] += (*ptr)[r];
+    }
+    for(int t = 0; t < k; t++){
+        int source = by_column[t];
+        order[(*ptr)[I[source]]++] = source;
+    }
+
+    //ptr[r] agora marca o fim da linha r; compacta removendo repetidas e nulos.
+    int count = 0;
+    int start = 0;
+    for(int r = 0; r < n; r++){
+        int end = (*ptr)[r];
+        (*ptr)[r] = count;
+        for(int p = start; p < end; p++){
+            int source = order[p];
+            if(p + 1 < end && J[order[p + 1]] == J[source]){
+                continue;
+            }
+            if(values[source] != 0.0f){
+                (*keys)[count] = J[source];
+                (*out_values)[count] = values[source];
+                count++;
+            }
+        }
+        start = end;
+    }
+    (*ptr)[n] = count;
+
+    free(by_column);
+    free(order);
+    free(column_start);
+    return count;
+}
+
+AVLMatrix* create_matrix_avl_from_triplets(int n, int m, int k, const int* I, const int* J, const float* values, int threads){
+    if(k < 0 || (k > 0 && (!I || !J || !values))){
+        fprintf(stderr, "Error: invalid triplet arrays.\n");
+        return NULL;
+    }
+    AVLMatrix* matrix = create_matrix_avl(n, m);
+    if(!matrix){
+        return NULL;
+    }
+    for(int t = 0; t < k; t++){
+        if(I[t] < 0 || I[t] >= n || J[t] < 0 || J[t] >= m){
+            fprintf(stderr, "Error: triplet %d is out of bounds.\n", t);
+            free_matrix_avl(matrix);
+            return NULL;
+        }
+    }
+
+    int *ptr, *keys;
+    float* csr_values;
+    matrix->k = _triplets_to_csr(n, m, k, I, J, values, &ptr, &keys, &csr_values);
+
+    AVLBuildJob job = {matrix->inner_layout, n, m, ptr, keys, csr_values, matrix->main_arena, matrix->transposed_arena, 0, 0};
+    parallel_for_thread_pool(threads >= 2 ? thread_pool_global() : NULL, 0, 2, 1, THREAD_POOL_STEALING, _build_trees_task, &job);
+    matrix->main_root = job.main_root;
+    matrix->transposed_root = job.transposed_root;
+
+    free(ptr);
+    free(keys);
+    free(csr_values);
     return matrix;
 }
+
+AVLMatrix* copy_matrix_avl(AVLMatrix* source){
+    if(_validate_matrix(source) != AVL_STATUS_OK){
+        return NULL;
+    }
+    AVLMatrix* copy = create_matrix_avl_with_layout(source->n, source->m, source->inner_layout);
+    copy->transpose_mode = source->transpose_mode;
+    _copy_matrix(source, copy);
+    return copy;
+}
+
 void free_matrix_avl(AVLMatrix* matrix){
     if(!matrix){
         return;
     }
-    _free_o_tree(matrix->main_root);
-    _free_o_tree(matrix->transposed_root);
+    _arena_leave(matrix->main_arena, matrix->inner_layout, matrix->main_root);
+    _arena_leave(matrix->transposed_arena, matrix->inner_layout, matrix->transposed_root);
     free(matrix);
 }
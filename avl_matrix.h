@@ -1,4 +1,6 @@
 #pragma once
+#include <stddef.h>
+#include "thread_pool.h"
 
 /**
  * @file avl_matrix.h
@@ -6,37 +8,140 @@
  */
 
 /**
- * @brief Nó da árvore interna (contém os elementos).
+ * @brief Índice de um nó no pool da sua árvore; 0 representa "nenhum nó".
+ */
+typedef unsigned int AVLIndex;
+
+#define AVL_LINK_INDEX_BITS 29 /**< Bits de índice em left/right; os 3 bits altos de cada um guardam a altura. */
+
+/**
+ * @brief Nó da árvore interna (contém os elementos), com 16 bytes.
  *
- * Armazena o índice da linha ou coluna, o valor do elemento não-nulo,
- * os ponteiros dos filhos da árvore AVL interna e a altura
- * relativa ao nó.
+ * Armazena o índice da linha ou coluna, o valor do elemento não-nulo
+ * e os índices dos filhos da árvore AVL interna. A altura do nó (até 63)
+ * ocupa os 3 bits altos de left (parte alta) e de right (parte baixa).
  */
 typedef struct InnerNode{
     int key;
     float data;
-    struct InnerNode* left;
-    struct InnerNode* right;
-    int height;
+    unsigned int left;
+    unsigned int right;
 } InnerNode;
 
+#define AVL_BTREE_SMALL_LEAF_CAPACITY 3 /**< Folha de 32 bytes, usada só como raiz de fileiras curtas. */
+#define AVL_BTREE_LEAF_CAPACITY 7       /**< Folha de 64 bytes (uma linha de cache). */
+#define AVL_BTREE_BRANCH_CAPACITY 4     /**< Chaves por nó interno de 64 bytes (5 filhos). */
+
+/**
+ * @brief Cabeçalho comum dos nós da árvore B+ de uma fileira (layout ::AVL_INNER_BTREE).
+ *
+ * Todos os elementos ficam nas folhas, com chaves e valores em vetores ordenados
+ * separados; os nós internos guardam apenas separadores e filhos.
+ */
+typedef struct BTreeNode{
+    unsigned short count;    /**< Chaves em uso. */
+    unsigned short capacity; /**< Capacidade da folha (3 ou 7); 0 em nós internos. */
+    unsigned int references; /**< Na raiz da fileira: nós externos que apontam para ela (cópias compartilham fileiras). */
+} BTreeNode;
+
+/**
+ * @brief Folha curta (32 bytes), raiz de fileiras com até três elementos.
+ */
+typedef struct BTreeSmallLeaf{
+    BTreeNode header;
+    int keys[AVL_BTREE_SMALL_LEAF_CAPACITY];
+    float values[AVL_BTREE_SMALL_LEAF_CAPACITY];
+} BTreeSmallLeaf;
+
+/**
+ * @brief Folha completa (64 bytes).
+ */
+typedef struct BTreeLeaf{
+    BTreeNode header;
+    int keys[AVL_BTREE_LEAF_CAPACITY];
+    float values[AVL_BTREE_LEAF_CAPACITY];
+} BTreeLeaf;
+
+/**
+ * @brief Nó interno (64 bytes): children[c] guarda as chaves em [keys[c-1], keys[c]).
+ */
+typedef struct BTreeBranch{
+    BTreeNode header;
+    int keys[AVL_BTREE_BRANCH_CAPACITY];
+    struct BTreeNode* children[AVL_BTREE_BRANCH_CAPACITY + 1];
+} BTreeBranch;
+
+/**
+ * @brief Raiz da estrutura de uma fileira, conforme o layout da matriz.
+ */
+typedef union AVLInnerRoot{
+    AVLIndex tree;           /**< Layout ::AVL_INNER_AVL: índice da raiz no pool de InnerNode. */
+    struct BTreeNode* btree; /**< Layout ::AVL_INNER_BTREE: raiz da árvore B+. */
+} AVLInnerRoot;
+
 /**
  * @brief Nó da árvore externa (linha ou coluna da matriz).
  *
  * Cada nó representa uma linha ou coluna da matriz e aponta 
- * para a árvore interna contendo os elementos não-nulos da
- * linha ou coluna. Armazena o índice dessa linha ou coluna,
- * os ponteiros dos filhos da árvore AVL externa e a altura
- * relativa ao nó.
+ * para a estrutura interna contendo os elementos não-nulos da
+ * linha ou coluna. Armazena o índice dessa linha ou coluna e
+ * os índices dos filhos da árvore AVL externa, com a altura
+ * empacotada como em ::InnerNode.
  */
 typedef struct OuterNode{
     int key;
-    struct InnerNode* inner_tree; 
-    struct OuterNode* left;
-    struct OuterNode* right;
-    int height;
+    unsigned int left;
+    unsigned int right;
+    AVLInnerRoot inner;
 } OuterNode;
 
+/**
+ * @brief Bloco contíguo de memória de onde a arena entrega nós.
+ */
+typedef struct AVLArenaChunk{
+    struct AVLArenaChunk* next;  /**< Bloco alocado anteriormente. */
+    size_t size;                 /**< Bytes utilizáveis em data. */
+    size_t used;                 /**< Bytes já entregues. */
+    unsigned long long data[];   /**< Área dos nós (alinhada a 8 bytes). */
+} AVLArenaChunk;
+
+/**
+ * @brief Pool de nós de tamanho fixo endereçados por ::AVLIndex.
+ *
+ * Os nós ficam num único vetor contíguo, realocado (crescendo 50%) quando lota;
+ * por isso as árvores guardam índices e não ponteiros. Índices devolvidos são
+ * reaproveitados antes de novos.
+ */
+typedef struct AVLNodePool{
+    void* nodes;            /**< Vetor de nós; a posição 0 é reservada. */
+    unsigned int count;     /**< Próximo índice nunca entregue. */
+    unsigned int capacity;  /**< Nós que cabem em nodes. */
+    unsigned int free_list; /**< Primeiro índice devolvido (encadeado pelos 4 primeiros bytes do nó). */
+    unsigned int* references; /**< Referências a cada nó além da primeira; NULL enquanto a arena não é compartilhada. */
+} AVLNodePool;
+
+/**
+ * @brief Arena de nós de uma árvore (externa e internas) de uma matriz AVL.
+ *
+ * InnerNode e OuterNode vêm de pools próprios. Os nós B+ são entregues em sequência a
+ * partir do bloco mais recente; nós removidos voltam para uma lista livre por tamanho e
+ * são reaproveitados antes de qualquer novo bloco. A liberação é feita bloco a bloco.
+ *
+ * Cópias de matriz compartilham a arena (copy-on-write): cada árvore que a usa conta em
+ * users e os nós passam a ter contagem de referências, de modo que uma escrita copia
+ * apenas o caminho que altera. Árvores que compartilham uma arena não devem ser
+ * modificadas por threads diferentes ao mesmo tempo.
+ */
+typedef struct AVLArena{
+    AVLNodePool inner;        /**< Pool de InnerNode. */
+    AVLNodePool outer;        /**< Pool de OuterNode. */
+    AVLArenaChunk* chunks;    /**< Blocos dos nós B+, o mais recente primeiro. */
+    void* free_small_blocks;  /**< Nós B+ de 32 bytes devolvidos (encadeados pelo início do bloco). */
+    void* free_blocks;        /**< Nós B+ de 64 bytes devolvidos (encadeados pelo início do bloco). */
+    unsigned long long bytes; /**< Total de bytes reservados nos pools e nos blocos (incluindo cabeçalhos). */
+    int users;                /**< Árvores (de uma ou mais matrizes) que usam a arena. */
+} AVLArena;
+
 /**
  * @brief Códigos de retorno das operações na matriz AVL.
  */
@@ -50,20 +155,74 @@ typedef enum {
     AVL_ERROR_NOT_IMPLEMENTED = -5     /**< Funcionalidade ainda não implementada. */
 } AVLStatus;
 
+/**
+ * @brief Política de manutenção da árvore transposta.
+ */
+typedef enum {
+    AVL_TRANSPOSE_EAGER = 0, /**< Toda escrita atualiza as duas árvores (padrão). */
+    AVL_TRANSPOSE_LAZY = 1   /**< Escritas atualizam só main_root; a transposta é descartada e reconstruída sob demanda. */
+} AVLTransposeMode;
+
+/**
+ * @brief Estrutura usada para os elementos de cada fileira.
+ */
+typedef enum {
+    AVL_INNER_AVL = 0,  /**< Árvore AVL de InnerNode (16 bytes por elemento, mais 4 de contagem de referências em árvores compartilhadas; padrão). */
+    AVL_INNER_BTREE = 1 /**< Árvore B+ com nós de uma linha de cache e chaves em vetores ordenados. */
+} AVLInnerLayout;
+
 /**
  * @brief Representação de uma matriz esparsa usando duas árvores AVL.
  *
  * A árvore main_root guarda os elementos no formato linha->coluna e a
  * transposed_root armazena a matriz transposta para facilitar operações.
+ *
+ * As árvores externas são sempre AVL; as fileiras seguem inner_layout. Cada
+ * árvore tem sua própria arena, trocada junto com a raiz na transposição e
+ * compartilhada com as cópias feitas por copy_matrix_avl.
+ *
+ * No modo ::AVL_TRANSPOSE_LAZY, transposed_root pode estar desatualizada
+ * (transposed_stale = 1, raiz 0) e só é reconstruída, em O(k), quando necessária.
  */
 typedef struct AVLMatrix{
-    struct OuterNode* main_root;       /**< Raiz (linhas) com árvores internas de colunas. */
-    struct OuterNode* transposed_root; /**< Raiz (colunas) com árvores internas de linhas. */
+    AVLIndex main_root;                /**< Raiz (linhas) com árvores internas de colunas, em main_arena. */
+    AVLIndex transposed_root;          /**< Raiz (colunas) com árvores internas de linhas, em transposed_arena. */
     int k;                             /**< Quantidade de elementos não nulos. */
     int n;                             /**< Quantidade de linhas de main_root. */
     int m;                             /**< Quantidade de colunas de main_root. */
+    AVLArena* main_arena;              /**< Origem de todos os nós de main_root (possivelmente compartilhada). */
+    AVLArena* transposed_arena;        /**< Origem de todos os nós de transposed_root (possivelmente compartilhada). */
+    AVLTransposeMode transpose_mode;   /**< Política de manutenção de transposed_root. */
+    int transposed_stale;              /**< 1 se transposed_root não reflete main_root (apenas no modo preguiçoso). */
+    AVLInnerLayout inner_layout;       /**< Estrutura das fileiras das duas árvores. */
 } AVLMatrix;
 
+#define AVL_CURSOR_MAX_DEPTH 64 /**< Profundidade máxima das pilhas do cursor (a altura empacotada vai até 63). */
+
+/**
+ * @brief Cursor não recursivo sobre os elementos de uma matriz, de uma linha, de uma coluna
+ * ou de um intervalo de uma linha.
+ *
+ * Guarda em pilhas de tamanho fixo o caminho da árvore externa e o da fileira atual, então
+ * cada passo custa O(1) amortizado e nenhum passo aloca memória. Pode ficar na pilha do
+ * chamador. Qualquer escrita na matriz percorrida invalida o cursor.
+ */
+typedef struct AVLCursor{
+    const AVLArena* arena;                                  /**< Arena da árvore percorrida. */
+    AVLInnerLayout layout;                                  /**< Layout das fileiras. */
+    int transposed;                                         /**< 1 se percorre transposed_root (linha e coluna trocam de papel). */
+    int row;                                                /**< Fileira atual. */
+    int high;                                               /**< Fim (exclusivo) do intervalo de chaves. */
+    int outer_depth;                                        /**< Nós em outer_stack. */
+    int inner_depth;                                        /**< Nós em inner_stack (layout AVL) ou em branch_stack (layout B+). */
+    BTreeNode* leaf;                                        /**< Folha B+ atual (NULL se esgotada). */
+    int leaf_position;                                      /**< Próxima posição de leaf. */
+    AVLIndex outer_stack[AVL_CURSOR_MAX_DEPTH];             /**< Fileiras ainda não visitadas (percurso em ordem). */
+    AVLIndex inner_stack[AVL_CURSOR_MAX_DEPTH];             /**< Nós da fileira ainda não visitados (layout AVL). */
+    BTreeBranch* branch_stack[AVL_CURSOR_MAX_DEPTH];        /**< Caminho até a folha atual (layout B+). */
+    int branch_position[AVL_CURSOR_MAX_DEPTH];              /**< Filho seguido em cada nó de branch_stack. */
+} AVLCursor;
+
 /**
  * @brief Obtém o valor de um elemento da matriz.
  *
@@ -86,6 +245,46 @@ AVLStatus get_element_avl(AVLMatrix* matrix, int i, int j, float* out_value);
  */
 AVLStatus insert_element_avl(AVLMatrix* matrix, float value, int i, int j);
 
+/**
+ * @brief Callback de upsert_element_avl: decide o novo valor de um elemento.
+ *
+ * @param current valor atual do elemento (0.0 se ausente).
+ * @param existed 1 se o elemento está armazenado.
+ * @param context ponteiro repassado por upsert_element_avl.
+ * @return Novo valor; 0.0 remove o elemento (ou deixa de criá-lo).
+ */
+typedef float (*AVLUpsertFunction)(float current, int existed, void* context);
+
+/**
+ * @brief Atualiza um elemento a partir do seu valor atual com uma única descida por árvore.
+ *
+ * Substitui a sequência get_element_avl + insert_element_avl (ou delete_element_avl):
+ * update é chamado exatamente uma vez e o resultado é gravado na árvore principal e na
+ * transposta sem novas buscas. Um resultado nulo remove o elemento. update não deve
+ * modificar matrizes AVL.
+ *
+ * @param matrix ponteiro para a matriz AVL.
+ * @param i índice da linha.
+ * @param j índice da coluna.
+ * @param update função que calcula o novo valor.
+ * @param context ponteiro repassado a update.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus upsert_element_avl(AVLMatrix* matrix, int i, int j, AVLUpsertFunction update, void* context);
+
+/**
+ * @brief Soma delta ao elemento (i, j) com uma única descida por árvore.
+ *
+ * Insere o elemento se ele não existir e o remove se a soma resultar em zero.
+ *
+ * @param matrix ponteiro para a matriz AVL.
+ * @param delta valor a ser somado.
+ * @param i índice da linha.
+ * @param j índice da coluna.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus accumulate_element_avl(AVLMatrix* matrix, float delta, int i, int j);
+
 /**
  * @brief Remove um elemento da matriz.
  *
@@ -96,6 +295,62 @@ AVLStatus insert_element_avl(AVLMatrix* matrix, float value, int i, int j);
  */
 AVLStatus delete_element_avl(AVLMatrix* matrix, int i, int j);
 
+/**
+ * @brief Posiciona um cursor no início da matriz (linhas em ordem crescente, colunas em ordem em cada linha).
+ *
+ * @param matrix ponteiro para a matriz AVL.
+ * @param cursor cursor a inicializar.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus begin_matrix_cursor_avl(AVLMatrix* matrix, AVLCursor* cursor);
+
+/**
+ * @brief Posiciona um cursor no início da linha i.
+ *
+ * @param matrix ponteiro para a matriz AVL.
+ * @param i índice da linha.
+ * @param cursor cursor a inicializar.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus begin_row_cursor_avl(AVLMatrix* matrix, int i, AVLCursor* cursor);
+
+/**
+ * @brief Posiciona um cursor nos elementos da linha i com coluna em [low, high).
+ *
+ * O início custa uma descida (O(log nnz da linha)), sem visitar as colunas anteriores a low.
+ *
+ * @param matrix ponteiro para a matriz AVL.
+ * @param i índice da linha.
+ * @param low primeira coluna (inclusiva).
+ * @param high última coluna (exclusiva).
+ * @param cursor cursor a inicializar.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus begin_row_range_cursor_avl(AVLMatrix* matrix, int i, int low, int high, AVLCursor* cursor);
+
+/**
+ * @brief Posiciona um cursor no início da coluna j, percorrida em transposed_root.
+ *
+ * No modo ::AVL_TRANSPOSE_LAZY a transposta é reconstruída antes, se estiver desatualizada.
+ *
+ * @param matrix ponteiro para a matriz AVL.
+ * @param j índice da coluna.
+ * @param cursor cursor a inicializar.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus begin_column_cursor_avl(AVLMatrix* matrix, int j, AVLCursor* cursor);
+
+/**
+ * @brief Avança o cursor para o próximo elemento não nulo.
+ *
+ * @param cursor cursor inicializado por uma das funções begin_*_cursor_avl.
+ * @param i saída: linha do elemento.
+ * @param j saída: coluna do elemento.
+ * @param value saída: valor do elemento.
+ * @return 1 se um elemento foi produzido, 0 se o percurso terminou.
+ */
+int next_cursor_avl(AVLCursor* cursor, int* i, int* j, float* value);
+
 /**
  * @brief Transpõe a matriz.
  *
@@ -104,9 +359,22 @@ AVLStatus delete_element_avl(AVLMatrix* matrix, int i, int j);
  */
 AVLStatus transpose_avl(AVLMatrix* matrix);
 
+/**
+ * @brief Define a política de manutenção da árvore transposta.
+ *
+ * Ao voltar para ::AVL_TRANSPOSE_EAGER, uma transposta desatualizada é reconstruída.
+ *
+ * @param matrix ponteiro para a matriz AVL.
+ * @param mode nova política.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus set_transpose_mode_avl(AVLMatrix* matrix, AVLTransposeMode mode);
+
 /**
  * @brief Calcula B = a * A (possivelmente in-place).
  *
+ * Com o pool global inicializado, as árvores principal e transposta são escaladas em paralelo.
+ *
  * @param A matriz de entrada.
  * @param B matriz de saída (pode ser a mesma que A).
  * @param a fator escalar.
@@ -117,6 +385,8 @@ AVLStatus scalar_mul_avl(AVLMatrix* A, AVLMatrix* B, float a);
 /**
  * @brief Calcula C = A + B.
  *
+ * Com o pool global inicializado, as árvores principal e transposta são intercaladas em paralelo.
+ *
  * @param A primeira matriz de entrada.
  * @param B segunda matriz de entrada.
  * @param C matriz resultado.
@@ -127,6 +397,8 @@ AVLStatus sum_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C);
 /**
  * @brief Calcula C = A * B (sem suporte a in-place).
  *
+ * Usa o pool global, se inicializado (ver matrix_mul_parallel_avl).
+ *
  * @param A matriz esquerda.
  * @param B matriz direita.
  * @param C matriz resultado pré-alocada com dimensões corretas.
@@ -134,6 +406,63 @@ AVLStatus sum_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C);
  */
 AVLStatus matrix_mul_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C);
 
+/**
+ * @brief Multiplica duas matrizes AVL usando um pool de threads.
+ *
+ * As linhas de A são divididas em várias fatias contíguas por participante, com número
+ * parecido de multiplicações (estimado por nnz das linhas de B tocadas); fatias que
+ * demoram mais que o previsto são compensadas por roubo de trabalho. Cada participante
+ * usa um acumulador próprio e cada fatia vetores próprios; ao final as fatias são
+ * concatenadas e as árvores de C montadas de uma vez (principal e transposta em paralelo),
+ * sem locks. matrix_mul_avl chama esta função com o pool global.
+ *
+ * @param A matriz esquerda.
+ * @param B matriz direita.
+ * @param C matriz resultado pré-alocada com dimensões corretas.
+ * @param pool pool que executa as fatias (NULL para sequencial).
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus matrix_mul_parallel_avl(AVLMatrix* A, AVLMatrix* B, AVLMatrix* C, ThreadPool* pool);
+
+/**
+ * @brief Calcula y = matrix * x.
+ *
+ * Percorre main_root em ordem com um cursor; cada linha é um produto escalar com x.
+ *
+ * @param matrix ponteiro para a matriz.
+ * @param x vetor de m posições.
+ * @param y saída: vetor de n posições (não pode sobrepor x).
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus spmv_avl(AVLMatrix* matrix, const float* x, float* y);
+
+/**
+ * @brief Calcula y = matrix^T * x.
+ *
+ * Também percorre main_root, espalhando cada linha i em y com peso x[i], então não
+ * depende de transposed_root (nem a reconstrói no modo preguiçoso).
+ *
+ * @param matrix ponteiro para a matriz.
+ * @param x vetor de n posições.
+ * @param y saída: vetor de m posições (não pode sobrepor x).
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus spmv_transposed_avl(AVLMatrix* matrix, const float* x, float* y);
+
+/**
+ * @brief Exporta a matriz no formato CSR, com colunas crescentes em cada linha.
+ *
+ * Custo O(n + k), sem alocar nós. Os três vetores são alocados com malloc e
+ * pertencem ao chamador.
+ *
+ * @param matrix matriz de origem.
+ * @param row_ptr saída: vetor de n+1 posições; a linha i ocupa [row_ptr[i], row_ptr[i+1]).
+ * @param columns saída: colunas dos k elementos.
+ * @param values saída: valores paralelos a columns.
+ * @return Código ::AVLStatus indicando sucesso ou motivo da falha.
+ */
+AVLStatus to_csr_avl(AVLMatrix* matrix, int** row_ptr, int** columns, float** values);
+
 /**
  * @brief Converte um código ::AVLStatus em mensagem textual.
  *
@@ -151,6 +480,49 @@ const char* avl_status_string(AVLStatus status);
  */
 AVLMatrix* create_matrix_avl(int n, int m);
 
+/**
+ * @brief Cria uma matriz vazia de dimensões n x m com a estrutura de fileira escolhida.
+ *
+ * @param n número de linhas (não negativo).
+ * @param m número de colunas (não negativo).
+ * @param layout estrutura das fileiras (::AVLInnerLayout).
+ * @return Ponteiro para nova matriz ou NULL em caso de parâmetros inválidos.
+ */
+AVLMatrix* create_matrix_avl_with_layout(int n, int m, AVLInnerLayout layout);
+
+/**
+ * @brief Cria uma matriz n x m a partir de triplas (I[t], J[t], values[t]) em tempo linear.
+ *
+ * As triplas são ordenadas por radix sort em (linha, coluna) e as árvores são montadas
+ * já perfeitamente balanceadas, sem rotações; a árvore transposta vem de uma segunda
+ * ordenação por contagem. O resultado equivale a inserir as triplas em ordem com
+ * insert_element_avl (a última repetida prevalece), exceto que valores nulos são ignorados.
+ *
+ * @param n número de linhas (não negativo).
+ * @param m número de colunas (não negativo).
+ * @param k número de triplas.
+ * @param I índices de linha.
+ * @param J índices de coluna.
+ * @param values valores.
+ * @param threads 2 para construir as árvores principal e transposta em paralelo no pool global
+ * (se inicializado); 1 para sequencial.
+ * @return Ponteiro para nova matriz (modo ::AVL_TRANSPOSE_EAGER) ou NULL se algum parâmetro for inválido.
+ */
+AVLMatrix* create_matrix_avl_from_triplets(int n, int m, int k, const int* I, const int* J, const float* values, int threads);
+
+/**
+ * @brief Cria uma cópia de source em O(1), compartilhando os nós (copy-on-write).
+ *
+ * As duas matrizes passam a compartilhar as árvores; cada escrita posterior em qualquer
+ * uma delas copia apenas os nós do caminho que altera (O(log n) no layout ::AVL_INNER_AVL;
+ * no layout ::AVL_INNER_BTREE a fileira alterada é copiada inteira). Cópias não devem ser
+ * modificadas em threads diferentes ao mesmo tempo.
+ *
+ * @param source matriz copiada.
+ * @return Ponteiro para a nova matriz ou NULL se source for inválida.
+ */
+AVLMatrix* copy_matrix_avl(AVLMatrix* source);
+
 /**
  * @brief Libera a memória associada à uma matriz AVL.
  *
@@ -0,0 +1,625 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bcsr_matrix.h"
+#include "thread_pool.h"
+
+#define BCSR_GRAIN 64                //menor bloco de linhas de blocos dos produtos paralelos
+#define BCSR_PARALLEL_VALUES 32768   //posições armazenadas abaixo das quais os produtos rodam na thread chamadora
+
+#if defined(__GNUC__)
+#define BCSR_INLINE static inline __attribute__((always_inline)) /**< Corpo genérico especializado por tamanho de bloco constante. */
+#else
+#define BCSR_INLINE static inline
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define BCSR_X86_KERNELS 1 /**< Núcleos AVX2/FMA compilados com atributos target e escolhidos em tempo de execução. */
+#endif
+
+/**
+ * @brief Encerramento imediato em caso de falha de alocação.
+ *
+ * Imprime uma mensagem de erro em stderr e aborta o processo usando EXIT_FAILURE.
+ */
+static void _allocation_fail(){
+    fprintf(stderr, "Error: memory allocation failed.\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Comparador de inteiros para qsort.
+ */
+static int _compare_int(const void* a, const void* b){
+    int x = *(const int*) a;
+    int y = *(const int*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Tamanhos de bloco aceitos na construção.
+ */
+static int _valid_block_size(int block_size){
+    return block_size == 2 || block_size == 4 || block_size == 8;
+}
+
+/**
+ * @brief Obtém a matriz por linhas.
+ *
+ * @param source matriz de origem.
+ * @param owned saída: cópia reorganizada a ser liberada pelo chamador, ou NULL se source já estiver em CSR.
+ * @return source ou a cópia em CSR.
+ */
+static CSRMatrix* _rows_view(CSRMatrix* source, CSRMatrix** owned){
+    *owned = NULL;
+    if(source->order == CSR_ORDER_ROWS){
+        return source;
+    }
+    *owned = create_csr_matrix_from_csr(source, CSR_ORDER_ROWS);
+    return *owned;
+}
+
+/**
+ * @brief Conta os blocos b x b não vazios de uma matriz em CSR.
+ *
+ * @param matrix matriz em CSR.
+ * @param block_size b.
+ * @param block_ptr saída opcional: block_rows + 1 posições com o início de cada linha de blocos.
+ * @return Número de blocos.
+ */
+static int _count_blocks(const CSRMatrix* matrix, int block_size, int* block_ptr){
+    int block_rows = (matrix->rows + block_size - 1) / block_size;
+    int block_columns = (matrix->columns + block_size - 1) / block_size;
+    //marker[bc] guarda a última linha de blocos que tocou a coluna de blocos bc.
+    int* marker = malloc(sizeof(int) * (block_columns > 0 ? block_columns : 1));
+    if(!marker){
+        _allocation_fail();
+    }
+    for(int bc = 0; bc < block_columns; bc++){
+        marker[bc] = -1;
+    }
+    int count = 0;
+    if(block_ptr){
+        block_ptr[0] = 0;
+    }
+    for(int R = 0; R < block_rows; R++){
+        int row_end = (R + 1) * block_size < matrix->rows ? (R + 1) * block_size : matrix->rows;
+        for(int r = R * block_size; r < row_end; r++){
+            for(int p = matrix->ptr[r]; p < matrix->ptr[r + 1]; p++){
+                int bc = matrix->indices[p] / block_size;
+                if(marker[bc] != R){
+                    marker[bc] = R;
+                    count++;
+                }
+            }
+        }
+        if(block_ptr){
+            block_ptr[R + 1] = count;
+        }
+    }
+    free(marker);
+    return count;
+}
+
+/**
+ * @brief Preenche a análise de um tamanho de bloco para uma matriz em CSR.
+ */
+static void _analyze(const CSRMatrix* matrix, int block_size, BCSRFillAnalysis* out){
+    out->block_size = block_size;
+    if(block_size == 1){
+        out->blocks = matrix->nnz;
+        out->fill_ratio = 1.0;
+        out->bytes = sizeof(int) * ((size_t) matrix->rows + 1) + (sizeof(int) + sizeof(float)) * (size_t) matrix->nnz;
+        return;
+    }
+    int block_rows = (matrix->rows + block_size - 1) / block_size;
+    out->blocks = _count_blocks(matrix, block_size, NULL);
+    size_t stored = (size_t) out->blocks * block_size * block_size;
+    out->fill_ratio = matrix->nnz > 0 ? (double) stored / matrix->nnz : 1.0;
+    out->bytes = sizeof(int) * ((size_t) block_rows + 1) + sizeof(int) * (size_t) out->blocks + sizeof(float) * stored;
+}
+
+/**
+ * @brief Escolhe, entre os candidatos, o formato com menos bytes; empates ficam com o bloco menor.
+ *
+ * @param matrix matriz em CSR.
+ * @param include_csr 1 para incluir o próprio CSR (block_size 1) entre os candidatos.
+ * @return Tamanho de bloco escolhido.
+ */
+static int _best_block_size(const CSRMatrix* matrix, int include_csr){
+    const int candidates[] = {1, 2, 4, 8};
+    int best = 0;
+    size_t best_bytes = 0;
+    for(int c = include_csr ? 0 : 1; c < 4; c++){
+        BCSRFillAnalysis analysis;
+        _analyze(matrix, candidates[c], &analysis);
+        if(!best || analysis.bytes < best_bytes){
+            best = candidates[c];
+            best_bytes = analysis.bytes;
+        }
+    }
+    return best;
+}
+
+BCSRStatus analyze_fill_bcsr(CSRMatrix* source, int block_size, BCSRFillAnalysis* out){
+    if(!source){
+        return BCSR_ERROR_NULL_MATRIX;
+    }
+    if(!out || (block_size != 1 && !_valid_block_size(block_size))){
+        return BCSR_ERROR_INVALID_ARGUMENT;
+    }
+    CSRMatrix* owned;
+    _analyze(_rows_view(source, &owned), block_size, out);
+    free_csr_matrix(owned);
+    return BCSR_STATUS_OK;
+}
+
+BCSRStatus recommend_block_size_bcsr(CSRMatrix* source, int* out_block_size){
+    if(!source){
+        return BCSR_ERROR_NULL_MATRIX;
+    }
+    if(!out_block_size){
+        return BCSR_ERROR_INVALID_ARGUMENT;
+    }
+    CSRMatrix* owned;
+    *out_block_size = _best_block_size(_rows_view(source, &owned), 1);
+    free_csr_matrix(owned);
+    return BCSR_STATUS_OK;
+}
+
+BCSRMatrix* create_bcsr_matrix_from_csr(CSRMatrix* source, int block_size){
+    if(!source || (block_size != BCSR_BLOCK_AUTO && !_valid_block_size(block_size))){
+        return NULL;
+    }
+    CSRMatrix* owned;
+    const CSRMatrix* matrix = _rows_view(source, &owned);
+    if(block_size == BCSR_BLOCK_AUTO){
+        block_size = _best_block_size(matrix, 0);
+    }
+
+    BCSRMatrix* result = malloc(sizeof(BCSRMatrix));
+    if(!result){
+        _allocation_fail();
+    }
+    int area = block_size * block_size;
+    int block_columns = (matrix->columns + block_size - 1) / block_size;
+    result->rows = matrix->rows;
+    result->columns = matrix->columns;
+    result->nnz = matrix->nnz;
+    result->block_size = block_size;
+    result->block_rows = (matrix->rows + block_size - 1) / block_size;
+    result->block_ptr = malloc(sizeof(int) * ((size_t) result->block_rows + 1));
+    if(!result->block_ptr){
+        _allocation_fail();
+    }
+    result->block_count = _count_blocks(matrix, block_size, result->block_ptr);
+    result->block_columns = malloc(sizeof(int) * (result->block_count > 0 ? (size_t) result->block_count : 1));
+    result->values = calloc(result->block_count > 0 ? (size_t) result->block_count * area : 1, sizeof(float));
+    int* marker = malloc(sizeof(int) * (block_columns > 0 ? block_columns : 1));
+    int* slot = malloc(sizeof(int) * (block_columns > 0 ? block_columns : 1));
+    if(!result->block_columns || !result->values || !marker || !slot){
+        _allocation_fail();
+    }
+    for(int bc = 0; bc < block_columns; bc++){
+        marker[bc] = -1;
+    }
+
+    for(int R = 0; R < result->block_rows; R++){
+        int row_begin = R * block_size;
+        int row_end = row_begin + block_size < matrix->rows ? row_begin + block_size : matrix->rows;
+        //Colunas de blocos tocadas pela linha de blocos, em ordem crescente, e a posição de cada uma.
+        int* columns = &result->block_columns[result->block_ptr[R]];
+        int touched = 0;
+        for(int r = row_begin; r < row_end; r++){
+            for(int p = matrix->ptr[r]; p < matrix->ptr[r + 1]; p++){
+                int bc = matrix->indices[p] / block_size;
+                if(marker[bc] != R){
+                    marker[bc] = R;
+                    columns[touched++] = bc;
+                }
+            }
+        }
+        qsort(columns, touched, sizeof(int), _compare_int);
+        for(int t = 0; t < touched; t++){
+            slot[columns[t]] = result->block_ptr[R] + t;
+        }
+        for(int r = row_begin; r < row_end; r++){
+            for(int p = matrix->ptr[r]; p < matrix->ptr[r + 1]; p++){
+                int column = matrix->indices[p];
+                float* block = &result->values[(size_t) slot[column / block_size] * area];
+                block[(column % block_size) * block_size + (r - row_begin)] = matrix->values[p];
+            }
+        }
+    }
+
+    free(marker);
+    free(slot);
+    free_csr_matrix(owned);
+    return result;
+}
+
+BCSRMatrix* create_bcsr_matrix_from_avl(AVLMatrix* source, int block_size){
+    if(block_size != BCSR_BLOCK_AUTO && !_valid_block_size(block_size)){
+        return NULL;
+    }
+    CSRMatrix* csr = create_csr_matrix_from_avl(source);
+    if(!csr){
+        return NULL;
+    }
+    BCSRMatrix* result = create_bcsr_matrix_from_csr(csr, block_size);
+    free_csr_matrix(csr);
+    return result;
+}
+
+BCSRMatrix* create_bcsr_matrix_from_hash(HashMatrix* source, int block_size){
+    if(block_size != BCSR_BLOCK_AUTO && !_valid_block_size(block_size)){
+        return NULL;
+    }
+    CSRMatrix* csr = create_csr_matrix_from_hash(source);
+    if(!csr){
+        return NULL;
+    }
+    BCSRMatrix* result = create_bcsr_matrix_from_csr(csr, block_size);
+    free_csr_matrix(csr);
+    return result;
+}
+
+/**
+ * @brief Produto das linhas de blocos [begin, end) com um vetor, para um intervalo de linhas de blocos.
+ */
+typedef void (*_SpmvKernel)(const BCSRMatrix* A, const float* x, float* y, int begin, int end);
+
+/**
+ * @brief Produto das linhas de blocos [begin, end) com uma matriz densa de k colunas.
+ */
+typedef void (*_SpmmKernel)(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end);
+
+/**
+ * @brief Corpo escalar de y = A * x; com block_size constante, os laços do bloco são desenrolados.
+ *
+ * O bloco da última coluna de blocos só lê as colunas que existem em x.
+ */
+BCSR_INLINE void _spmv_scalar_body(const BCSRMatrix* A, const float* x, float* y, int begin, int end, int block_size){
+    int area = block_size * block_size;
+    for(int R = begin; R < end; R++){
+        float accumulator[8] = {0.0f};
+        for(int p = A->block_ptr[R]; p < A->block_ptr[R + 1]; p++){
+            const float* block = &A->values[(size_t) p * area];
+            int c0 = A->block_columns[p] * block_size;
+            int width = A->columns - c0 < block_size ? A->columns - c0 : block_size;
+            for(int j = 0; j < width; j++){
+                float x_value = x[c0 + j];
+                for(int i = 0; i < block_size; i++){
+                    accumulator[i] += block[j * block_size + i] * x_value;
+                }
+            }
+        }
+        int r0 = R * block_size;
+        int height = A->rows - r0 < block_size ? A->rows - r0 : block_size;
+        for(int i = 0; i < height; i++){
+            y[r0 + i] = accumulator[i];
+        }
+    }
+}
+
+static void _spmv_2x2(const BCSRMatrix* A, const float* x, float* y, int begin, int end){
+    _spmv_scalar_body(A, x, y, begin, end, 2);
+}
+
+static void _spmv_4x4(const BCSRMatrix* A, const float* x, float* y, int begin, int end){
+    _spmv_scalar_body(A, x, y, begin, end, 4);
+}
+
+static void _spmv_8x8(const BCSRMatrix* A, const float* x, float* y, int begin, int end){
+    _spmv_scalar_body(A, x, y, begin, end, 8);
+}
+
+/**
+ * @brief Corpo escalar de Y = A * X, acumulando cada coluna do bloco como axpy sobre as k colunas.
+ */
+BCSR_INLINE void _spmm_scalar_body(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end, int block_size){
+    int area = block_size * block_size;
+    for(int R = begin; R < end; R++){
+        int r0 = R * block_size;
+        int height = A->rows - r0 < block_size ? A->rows - r0 : block_size;
+        memset(&Y[(size_t) r0 * k], 0, sizeof(float) * (size_t) height * k);
+        for(int p = A->block_ptr[R]; p < A->block_ptr[R + 1]; p++){
+            const float* block = &A->values[(size_t) p * area];
+            int c0 = A->block_columns[p] * block_size;
+            int width = A->columns - c0 < block_size ? A->columns - c0 : block_size;
+            for(int j = 0; j < width; j++){
+                const float* x_row = &X[(size_t) (c0 + j) * k];
+                for(int i = 0; i < height; i++){
+                    float a = block[j * block_size + i];
+                    if(a == 0.0f){
+                        continue;
+                    }
+                    float* y_row = &Y[(size_t) (r0 + i) * k];
+                    for(int c = 0; c < k; c++){
+                        y_row[c] += a * x_row[c];
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void _spmm_2x2(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end){
+    _spmm_scalar_body(A, X, k, Y, begin, end, 2);
+}
+
+static void _spmm_4x4(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end){
+    _spmm_scalar_body(A, X, k, Y, begin, end, 4);
+}
+
+static void _spmm_8x8(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end){
+    _spmm_scalar_body(A, X, k, Y, begin, end, 8);
+}
+
+#ifdef BCSR_X86_KERNELS
+/**
+ * @brief Núcleo 4x4 de y = A * x: cada coluna do bloco entra com um FMA de 4 floats.
+ */
+__attribute__((target("avx2,fma")))
+static void _spmv_4x4_avx2(const BCSRMatrix* A, const float* x, float* y, int begin, int end){
+    for(int R = begin; R < end; R++){
+        __m128 accumulator = _mm_setzero_ps();
+        for(int p = A->block_ptr[R]; p < A->block_ptr[R + 1]; p++){
+            const float* block = &A->values[(size_t) p * 16];
+            int c0 = A->block_columns[p] * 4;
+            if(c0 + 4 <= A->columns){
+                accumulator = _mm_fmadd_ps(_mm_loadu_ps(&block[0]), _mm_set1_ps(x[c0]), accumulator);
+                accumulator = _mm_fmadd_ps(_mm_loadu_ps(&block[4]), _mm_set1_ps(x[c0 + 1]), accumulator);
+                accumulator = _mm_fmadd_ps(_mm_loadu_ps(&block[8]), _mm_set1_ps(x[c0 + 2]), accumulator);
+                accumulator = _mm_fmadd_ps(_mm_loadu_ps(&block[12]), _mm_set1_ps(x[c0 + 3]), accumulator);
+                continue;
+            }
+            for(int j = 0; c0 + j < A->columns; j++){
+                accumulator = _mm_fmadd_ps(_mm_loadu_ps(&block[j * 4]), _mm_set1_ps(x[c0 + j]), accumulator);
+            }
+        }
+        int r0 = R * 4;
+        if(r0 + 4 <= A->rows){
+            _mm_storeu_ps(&y[r0], accumulator);
+            continue;
+        }
+        float partial[4];
+        _mm_storeu_ps(partial, accumulator);
+        for(int i = 0; r0 + i < A->rows; i++){
+            y[r0 + i] = partial[i];
+        }
+    }
+}
+
+/**
+ * @brief Núcleo 8x8 de y = A * x: cada coluna do bloco entra com um FMA de 8 floats.
+ */
+__attribute__((target("avx2,fma")))
+static void _spmv_8x8_avx2(const BCSRMatrix* A, const float* x, float* y, int begin, int end){
+    for(int R = begin; R < end; R++){
+        __m256 accumulator = _mm256_setzero_ps();
+        for(int p = A->block_ptr[R]; p < A->block_ptr[R + 1]; p++){
+            const float* block = &A->values[(size_t) p * 64];
+            int c0 = A->block_columns[p] * 8;
+            int width = A->columns - c0 < 8 ? A->columns - c0 : 8;
+            if(width == 8){
+                for(int j = 0; j < 8; j++){
+                    accumulator = _mm256_fmadd_ps(_mm256_loadu_ps(&block[j * 8]), _mm256_set1_ps(x[c0 + j]), accumulator);
+                }
+                continue;
+            }
+            for(int j = 0; j < width; j++){
+                accumulator = _mm256_fmadd_ps(_mm256_loadu_ps(&block[j * 8]), _mm256_set1_ps(x[c0 + j]), accumulator);
+            }
+        }
+        int r0 = R * 8;
+        if(r0 + 8 <= A->rows){
+            _mm256_storeu_ps(&y[r0], accumulator);
+            continue;
+        }
+        float partial[8];
+        _mm256_storeu_ps(partial, accumulator);
+        for(int i = 0; r0 + i < A->rows; i++){
+            y[r0 + i] = partial[i];
+        }
+    }
+}
+
+/**
+ * @brief Corpo vetorial de Y = A * X por faixas de 8 colunas.
+ *
+ * Para cada faixa, as block_size linhas de Y ficam em registradores enquanto todos os
+ * blocos da linha de blocos são aplicados; cada elemento do bloco custa um FMA. As
+ * colunas de Y que não completam uma faixa usam o caminho escalar.
+ */
+__attribute__((target("avx2,fma")))
+BCSR_INLINE void _spmm_avx2_body(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end, int block_size){
+    int area = block_size * block_size;
+    for(int R = begin; R < end; R++){
+        int r0 = R * block_size;
+        int height = A->rows - r0 < block_size ? A->rows - r0 : block_size;
+        int c = 0;
+        for(; c + 8 <= k; c += 8){
+            __m256 accumulator[8];
+            for(int i = 0; i < block_size; i++){
+                accumulator[i] = _mm256_setzero_ps();
+            }
+            for(int p = A->block_ptr[R]; p < A->block_ptr[R + 1]; p++){
+                const float* block = &A->values[(size_t) p * area];
+                int c0 = A->block_columns[p] * block_size;
+                int width = A->columns - c0 < block_size ? A->columns - c0 : block_size;
+                for(int j = 0; j < width; j++){
+                    __m256 x_values = _mm256_loadu_ps(&X[(size_t) (c0 + j) * k + c]);
+                    for(int i = 0; i < block_size; i++){
+                        accumulator[i] = _mm256_fmadd_ps(_mm256_set1_ps(block[j * block_size + i]), x_values, accumulator[i]);
+                    }
+                }
+            }
+            for(int i = 0; i < height; i++){
+                _mm256_storeu_ps(&Y[(size_t) (r0 + i) * k + c], accumulator[i]);
+            }
+        }
+        if(c == k){
+            continue;
+        }
+        for(int i = 0; i < height; i++){
+            for(int t = c; t < k; t++){
+                Y[(size_t) (r0 + i) * k + t] = 0.0f;
+            }
+        }
+        for(int p = A->block_ptr[R]; p < A->block_ptr[R + 1]; p++){
+            const float* block = &A->values[(size_t) p * area];
+            int c0 = A->block_columns[p] * block_size;
+            int width = A->columns - c0 < block_size ? A->columns - c0 : block_size;
+            for(int j = 0; j < width; j++){
+                const float* x_row = &X[(size_t) (c0 + j) * k];
+                for(int i = 0; i < height; i++){
+                    float a = block[j * block_size + i];
+                    float* y_row = &Y[(size_t) (r0 + i) * k];
+                    for(int t = c; t < k; t++){
+                        y_row[t] += a * x_row[t];
+                    }
+                }
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void _spmm_2x2_avx2(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end){
+    _spmm_avx2_body(A, X, k, Y, begin, end, 2);
+}
+
+__attribute__((target("avx2,fma")))
+static void _spmm_4x4_avx2(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end){
+    _spmm_avx2_body(A, X, k, Y, begin, end, 4);
+}
+
+__attribute__((target("avx2,fma")))
+static void _spmm_8x8_avx2(const BCSRMatrix* A, const float* X, int k, float* Y, int begin, int end){
+    _spmm_avx2_body(A, X, k, Y, begin, end, 8);
+}
+#endif
+
+/**
+ * @brief Informa se os núcleos vetoriais devem ser usados.
+ *
+ * Segue a variante de get_spmv_kernel_csr, então forçar ::CSR_KERNEL_SCALAR também
+ * desliga os núcleos vetoriais dos blocos.
+ */
+static int _vector_kernels(){
+#ifdef BCSR_X86_KERNELS
+    if(get_spmv_kernel_csr() == CSR_KERNEL_SCALAR){
+        return 0;
+    }
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Produto com vetor dividido entre as threads do pool.
+ */
+typedef struct BCSRSpmvJob{
+    _SpmvKernel kernel;
+    const BCSRMatrix* A;
+    const float* x;
+    float* y;
+} BCSRSpmvJob;
+
+static void _spmv_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    BCSRSpmvJob* job = context;
+    job->kernel(job->A, job->x, job->y, begin, end);
+}
+
+/**
+ * @brief Produto com matriz densa dividido entre as threads do pool.
+ */
+typedef struct BCSRSpmmJob{
+    _SpmmKernel kernel;
+    const BCSRMatrix* A;
+    const float* X;
+    int k;
+    float* Y;
+} BCSRSpmmJob;
+
+static void _spmm_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    BCSRSpmmJob* job = context;
+    job->kernel(job->A, job->X, job->k, job->Y, begin, end);
+}
+
+/**
+ * @brief Pool usado pelos produtos: o global, se a matriz for grande o bastante.
+ */
+static ThreadPool* _product_pool(const BCSRMatrix* A){
+    size_t stored = (size_t) A->block_count * A->block_size * A->block_size;
+    return stored >= BCSR_PARALLEL_VALUES ? thread_pool_global() : NULL;
+}
+
+BCSRStatus spmv_bcsr(BCSRMatrix* A, const float* x, float* y){
+    if(!A){
+        return BCSR_ERROR_NULL_MATRIX;
+    }
+    if(!x || !y){
+        return BCSR_ERROR_INVALID_ARGUMENT;
+    }
+    _SpmvKernel kernel = A->block_size == 2 ? _spmv_2x2 : A->block_size == 4 ? _spmv_4x4 : _spmv_8x8;
+#ifdef BCSR_X86_KERNELS
+    if(_vector_kernels() && A->block_size == 4){
+        kernel = _spmv_4x4_avx2;
+    }
+    else if(_vector_kernels() && A->block_size == 8){
+        kernel = _spmv_8x8_avx2;
+    }
+#endif
+    //Cada linha de blocos escreve apenas as próprias posições de y, então os trechos do pool não conflitam.
+    BCSRSpmvJob job = {kernel, A, x, y};
+    parallel_for_thread_pool(_product_pool(A), 0, A->block_rows, BCSR_GRAIN, THREAD_POOL_STEALING, _spmv_task, &job);
+    return BCSR_STATUS_OK;
+}
+
+BCSRStatus spmm_bcsr(BCSRMatrix* A, const float* X, int k, float* Y){
+    if(!A){
+        return BCSR_ERROR_NULL_MATRIX;
+    }
+    if(!X || !Y || k < 1){
+        return BCSR_ERROR_INVALID_ARGUMENT;
+    }
+    _SpmmKernel kernel = A->block_size == 2 ? _spmm_2x2 : A->block_size == 4 ? _spmm_4x4 : _spmm_8x8;
+#ifdef BCSR_X86_KERNELS
+    if(_vector_kernels()){
+        kernel = A->block_size == 2 ? _spmm_2x2_avx2 : A->block_size == 4 ? _spmm_4x4_avx2 : _spmm_8x8_avx2;
+    }
+#endif
+    BCSRSpmmJob job = {kernel, A, X, k, Y};
+    parallel_for_thread_pool(_product_pool(A), 0, A->block_rows, BCSR_GRAIN, THREAD_POOL_STEALING, _spmm_task, &job);
+    return BCSR_STATUS_OK;
+}
+
+const char* bcsr_status_string(BCSRStatus status){
+    switch(status){
+        case BCSR_STATUS_OK:
+            return "Operation completed successfully";
+        case BCSR_ERROR_NULL_MATRIX:
+            return "Matrix pointer is NULL";
+        case BCSR_ERROR_INVALID_ARGUMENT:
+            return "Invalid argument";
+        default:
+            return "Unknown error";
+    }
+}
+
+void free_bcsr_matrix(BCSRMatrix* matrix){
+    if(!matrix){
+        return;
+    }
+    free(matrix->block_ptr);
+    free(matrix->block_columns);
+    free(matrix->values);
+    free(matrix);
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <stddef.h>
+#include "csr_matrix.h"
+
+/**
+ * @file bcsr_matrix.h
+ * @brief Matriz esparsa em blocos densos b x b (formato BCSR), com núcleos por tamanho de bloco.
+ */
+
+#define BCSR_BLOCK_AUTO 0 /**< Tamanho de bloco escolhido por recommend_block_size_bcsr. */
+
+/**
+ * @brief Matriz esparsa comprimida por linhas de blocos, somente leitura depois de construída.
+ *
+ * As linhas são agrupadas em block_rows = ceil(rows / b) linhas de blocos; a linha de
+ * blocos R ocupa as posições [block_ptr[R], block_ptr[R+1]) de block_columns, em ordem
+ * crescente. O bloco p cobre as linhas [R*b, R*b + b) e as colunas
+ * [block_columns[p]*b, block_columns[p]*b + b), e seus b*b valores ficam em
+ * values[p*b*b ...] por coluna (o elemento (i, j) do bloco em j*b + i), para que o
+ * produto acumule uma coluna inteira do bloco com uma única instrução vetorial.
+ * Posições do bloco sem elemento (preenchimento) e as que passam da borda da matriz
+ * valem zero.
+ */
+typedef struct BCSRMatrix{
+    int rows, columns;   //dimensões lógicas
+    int nnz;             //elementos da matriz de origem
+    int block_size;      //b: 2, 4 ou 8
+    int block_rows;      //ceil(rows / b)
+    int block_count;     //blocos armazenados
+    int* block_ptr;      //block_rows + 1 posições
+    int* block_columns;  //block_count posições, crescentes dentro de cada linha de blocos
+    float* values;       //block_count * b * b posições
+} BCSRMatrix;
+
+/**
+ * @brief Custo de guardar uma matriz em blocos de um tamanho.
+ */
+typedef struct BCSRFillAnalysis{
+    int block_size;    //tamanho analisado (1 representa o próprio CSR)
+    int blocks;        //blocos não vazios (nnz quando block_size = 1)
+    double fill_ratio; //posições armazenadas / nnz (1 sem preenchimento)
+    size_t bytes;      //memória dos vetores no formato
+} BCSRFillAnalysis;
+
+/**
+ * @brief Códigos de retorno das operações na matriz em blocos.
+ */
+typedef enum {
+    BCSR_STATUS_OK = 0,                 /**< Operação concluída com sucesso. */
+    BCSR_ERROR_NULL_MATRIX = -1,        /**< Ponteiro de matriz nulo. */
+    BCSR_ERROR_INVALID_ARGUMENT = -4    /**< Parâmetro inválido. */
+} BCSRStatus;
+
+/**
+ * @brief Calcula o número de blocos e o preenchimento que a matriz teria com blocos b x b.
+ *
+ * Custo O(rows + columns / b + nnz), sem montar a matriz em blocos. Uma matriz em CSC é
+ * analisada a partir de uma cópia reorganizada.
+ *
+ * @param source matriz de origem.
+ * @param block_size 1 (o próprio CSR), 2, 4 ou 8.
+ * @param out saída: análise do formato.
+ * @return Código ::BCSRStatus indicando sucesso ou motivo da falha.
+ */
+BCSRStatus analyze_fill_bcsr(CSRMatrix* source, int block_size, BCSRFillAnalysis* out);
+
+/**
+ * @brief Recomenda o formato com menor tráfego de memória no produto matriz-vetor.
+ *
+ * O produto é limitado pela memória, então cada candidato (CSR, 2x2, 4x4 e 8x8) é
+ * avaliado pelos bytes que precisa ler, medidos por analyze_fill_bcsr: blocos trocam um
+ * índice por elemento por um índice por bloco, mas pagam os zeros de preenchimento.
+ * Matrizes vindas de malhas, com sub-blocos densos, costumam favorecer blocos; matrizes
+ * aleatórias ficam em CSR.
+ *
+ * @param source matriz de origem.
+ * @param out_block_size saída: 1 (manter CSR), 2, 4 ou 8.
+ * @return Código ::BCSRStatus indicando sucesso ou motivo da falha.
+ */
+BCSRStatus recommend_block_size_bcsr(CSRMatrix* source, int* out_block_size);
+
+/**
+ * @brief Monta a matriz em blocos a partir de uma matriz comprimida.
+ *
+ * @param source matriz de origem (CSR ou CSC).
+ * @param block_size 2, 4, 8 ou ::BCSR_BLOCK_AUTO (o melhor tamanho de bloco segundo
+ * recommend_block_size_bcsr, mesmo que CSR fosse recomendado).
+ * @return Ponteiro para a nova matriz ou NULL se algum parâmetro for inválido.
+ */
+BCSRMatrix* create_bcsr_matrix_from_csr(CSRMatrix* source, int block_size);
+
+/**
+ * @brief Monta a matriz em blocos a partir de uma matriz AVL.
+ *
+ * @param source matriz de origem.
+ * @param block_size 2, 4, 8 ou ::BCSR_BLOCK_AUTO.
+ * @return Ponteiro para a nova matriz ou NULL se algum parâmetro for inválido.
+ */
+BCSRMatrix* create_bcsr_matrix_from_avl(AVLMatrix* source, int block_size);
+
+/**
+ * @brief Monta a matriz em blocos a partir de uma matriz hash.
+ *
+ * A transposição e o fator escalar pendentes são respeitados.
+ *
+ * @param source matriz de origem.
+ * @param block_size 2, 4, 8 ou ::BCSR_BLOCK_AUTO.
+ * @return Ponteiro para a nova matriz ou NULL se algum parâmetro for inválido.
+ */
+BCSRMatrix* create_bcsr_matrix_from_hash(HashMatrix* source, int block_size);
+
+/**
+ * @brief Calcula y = A * x.
+ *
+ * Cada tamanho de bloco tem seu núcleo: 2x2 escalar desenrolado, 4x4 com FMA em 4
+ * floats e 8x8 com FMA em 8 floats (AVX2), escolhidos em tempo de execução. A variante
+ * vetorial é usada quando get_spmv_kernel_csr não é ::CSR_KERNEL_SCALAR. Com o pool global
+ * inicializado, as linhas de blocos de matrizes grandes são divididas entre as threads.
+ *
+ * @param A ponteiro para a matriz.
+ * @param x vetor de A->columns posições.
+ * @param y saída: vetor de A->rows posições (não pode sobrepor x).
+ * @return Código ::BCSRStatus indicando sucesso ou motivo da falha.
+ */
+BCSRStatus spmv_bcsr(BCSRMatrix* A, const float* x, float* y);
+
+/**
+ * @brief Calcula Y = A * X, com X e Y densos de k colunas.
+ *
+ * X tem A->columns linhas e Y tem A->rows linhas, ambos por linha (o elemento (i, c)
+ * em i * k + c). O núcleo mantém as b linhas de Y de uma faixa de 8 colunas em
+ * registradores enquanto percorre os blocos da linha de blocos.
+ *
+ * @param A ponteiro para a matriz.
+ * @param X matriz densa de A->columns x k.
+ * @param k número de colunas de X e Y (ao menos 1).
+ * @param Y saída: matriz densa de A->rows x k (não pode sobrepor X).
+ * @return Código ::BCSRStatus indicando sucesso ou motivo da falha.
+ */
+BCSRStatus spmm_bcsr(BCSRMatrix* A, const float* X, int k, float* Y);
+
+/**
+ * @brief Converte um código de status em uma mensagem legível.
+ *
+ * @param status código de status.
+ * @return Mensagem descritiva.
+ */
+const char* bcsr_status_string(BCSRStatus status);
+
+/**
+ * @brief Libera a matriz e seus vetores.
+ *
+ * @param matrix ponteiro para a matriz (pode ser NULL).
+ */
+void free_bcsr_matrix(BCSRMatrix* matrix);
@@ -0,0 +1,897 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "csr_matrix.h"
+#include "thread_pool.h"
+
+#define CSR_SPMV_GRAIN 256            //menor bloco de fileiras do produto paralelo
+#define CSR_SPMV_PARALLEL_NNZ 32768   //abaixo disso o produto roda na thread chamadora
+#define CSR_SPGEMM_SLICES_PER_THREAD 8 //fatias do produto de matrizes por participante do pool
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define CSR_X86_KERNELS 1 /**< Variantes AVX2/AVX-512 compiladas com atributos target e escolhidas em tempo de execução. */
+#endif
+
+/**
+ * @brief Encerramento imediato em caso de falha de alocação.
+ *
+ * Imprime uma mensagem de erro em stderr e aborta o processo usando EXIT_FAILURE.
+ */
+static void _allocation_fail(){
+    fprintf(stderr, "Error: memory allocation failed.\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Número de fileiras (linhas em CSR, colunas em CSC) de uma matriz na direção order.
+ */
+static int _outer_count(const CSRMatrix* matrix, CSROrder order){
+    return order == CSR_ORDER_ROWS ? matrix->rows : matrix->columns;
+}
+
+/**
+ * @brief Aloca os três vetores de uma matriz comprimida.
+ *
+ * ptr sai zerado; indices e values têm ao menos uma posição, para que malloc(0) não
+ * seja confundido com falha.
+ *
+ * @param outer número de fileiras.
+ * @param capacity posições de indices e values.
+ * @param ptr, indices, values saída: vetores alocados.
+ */
+static void _alloc_arrays(int outer, int capacity, int** ptr, int** indices, float** values){
+    *ptr = calloc((size_t) outer + 1, sizeof(int));
+    *indices = malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    *values = malloc(sizeof(float) * (capacity > 0 ? capacity : 1));
+    if(!*ptr || !*indices || !*values){
+        _allocation_fail();
+    }
+}
+
+/**
+ * @brief Substitui o conteúdo de uma matriz, liberando os vetores anteriores.
+ *
+ * Os vetores anteriores só são liberados aqui, então podem ter sido lidos pelo
+ * cálculo dos novos (operações com resultado igual a um dos operandos).
+ *
+ * @param matrix matriz a ser substituída.
+ * @param order direção dos novos vetores.
+ * @param nnz número de elementos.
+ * @param ptr, indices, values novos vetores (a matriz passa a ser dona deles).
+ */
+static void _replace(CSRMatrix* matrix, CSROrder order, int nnz, int* ptr, int* indices, float* values){
+    free(matrix->ptr);
+    free(matrix->indices);
+    free(matrix->values);
+    matrix->order = order;
+    matrix->nnz = nnz;
+    matrix->ptr = ptr;
+    matrix->indices = indices;
+    matrix->values = values;
+}
+
+/**
+ * @brief Troca a direção de compressão por ordenação por contagem.
+ *
+ * As fileiras de origem são visitadas em ordem crescente, então os índices de cada
+ * fileira de destino também saem em ordem crescente.
+ *
+ * @param outer fileiras da origem.
+ * @param inner fileiras do destino.
+ * @param ptr, indices, values vetores de origem.
+ * @param t_ptr, t_indices, t_values saída: vetores na outra direção.
+ */
+static void _transpose_arrays(int outer, int inner, const int* ptr, const int* indices, const float* values, int** t_ptr, int** t_indices, float** t_values){
+    int nnz = ptr[outer];
+    _alloc_arrays(inner, nnz, t_ptr, t_indices, t_values);
+    int* next = malloc(sizeof(int) * (inner > 0 ? inner : 1));
+    if(!next){
+        _allocation_fail();
+    }
+    for(int p = 0; p < nnz; p++){
+        (*t_ptr)[indices[p] + 1]++;
+    }
+    for(int c = 0; c < inner; c++){
+        (*t_ptr)[c + 1] += (*t_ptr)[c];
+        next[c] = (*t_ptr)[c];
+    }
+    for(int r = 0; r < outer; r++){
+        for(int p = ptr[r]; p < ptr[r + 1]; p++){
+            int position = next[indices[p]]++;
+            (*t_indices)[position] = r;
+            (*t_values)[position] = values[p];
+        }
+    }
+    free(next);
+}
+
+/**
+ * @brief Obtém os vetores de uma matriz na direção pedida.
+ *
+ * Se a matriz já estiver em order, devolve os próprios vetores; caso contrário,
+ * devolve uma cópia reorganizada que deve ser liberada pelo chamador.
+ *
+ * @param matrix matriz de origem.
+ * @param order direção desejada.
+ * @param ptr, indices, values saída: vetores na direção order.
+ * @return 1 se os vetores devolvidos foram alocados, 0 se pertencem à matriz.
+ */
+static int _arrays_in_order(const CSRMatrix* matrix, CSROrder order, int** ptr, int** indices, float** values){
+    if(matrix->order == order){
+        *ptr = matrix->ptr;
+        *indices = matrix->indices;
+        *values = matrix->values;
+        return 0;
+    }
+    _transpose_arrays(_outer_count(matrix, matrix->order), _outer_count(matrix, order),
+                      matrix->ptr, matrix->indices, matrix->values, ptr, indices, values);
+    return 1;
+}
+
+/**
+ * @brief Comparador de inteiros para qsort.
+ */
+static int _compare_int(const void* a, const void* b){
+    int x = *(const int*) a;
+    int y = *(const int*) b;
+    return (x > y) - (x < y);
+}
+
+CSRMatrix* create_csr_matrix(int rows, int columns){
+    if(rows < 0 || columns < 0){
+        fprintf(stderr, "Error: matrix dimensions must be non-negative.\n");
+        return NULL;
+    }
+    CSRMatrix* matrix = malloc(sizeof(CSRMatrix));
+    if(!matrix){
+        _allocation_fail();
+    }
+    matrix->rows = rows;
+    matrix->columns = columns;
+    matrix->nnz = 0;
+    matrix->order = CSR_ORDER_ROWS;
+    _alloc_arrays(rows, 0, &matrix->ptr, &matrix->indices, &matrix->values);
+    return matrix;
+}
+
+CSRMatrix* create_csr_matrix_from_avl(AVLMatrix* source){
+    int *ptr, *indices;
+    float* values;
+    if(to_csr_avl(source, &ptr, &indices, &values) != AVL_STATUS_OK){
+        return NULL;
+    }
+    CSRMatrix* matrix = malloc(sizeof(CSRMatrix));
+    if(!matrix){
+        _allocation_fail();
+    }
+    matrix->rows = source->n;
+    matrix->columns = source->m;
+    matrix->nnz = source->k;
+    matrix->order = CSR_ORDER_ROWS;
+    matrix->ptr = ptr;
+    matrix->indices = indices;
+    matrix->values = values;
+    return matrix;
+}
+
+CSRMatrix* create_csr_matrix_from_hash(HashMatrix* source){
+    int *ptr, *indices;
+    float* values;
+    if(to_csr_hash(source, &ptr, &indices, &values) != HASH_STATUS_OK){
+        return NULL;
+    }
+    CSRMatrix* matrix = malloc(sizeof(CSRMatrix));
+    if(!matrix){
+        _allocation_fail();
+    }
+    matrix->rows = source->is_transposed ? source->columns : source->rows;
+    matrix->columns = source->is_transposed ? source->rows : source->columns;
+    matrix->nnz = ptr[matrix->rows];
+    matrix->order = CSR_ORDER_ROWS;
+    matrix->ptr = ptr;
+    matrix->indices = indices;
+    matrix->values = values;
+    return matrix;
+}
+
+CSRMatrix* create_csr_matrix_from_csr(CSRMatrix* source, CSROrder order){
+    if(!source || (order != CSR_ORDER_ROWS && order != CSR_ORDER_COLUMNS)){
+        return NULL;
+    }
+    int *ptr, *indices;
+    float* values;
+    //Na outra direção a reorganização já é a cópia; na mesma, os vetores são duplicados.
+    if(!_arrays_in_order(source, order, &ptr, &indices, &values)){
+        int outer = _outer_count(source, order);
+        _alloc_arrays(outer, source->nnz, &ptr, &indices, &values);
+        memcpy(ptr, source->ptr, sizeof(int) * ((size_t) outer + 1));
+        memcpy(indices, source->indices, sizeof(int) * source->nnz);
+        memcpy(values, source->values, sizeof(float) * source->nnz);
+    }
+    CSRMatrix* matrix = malloc(sizeof(CSRMatrix));
+    if(!matrix){
+        _allocation_fail();
+    }
+    matrix->rows = source->rows;
+    matrix->columns = source->columns;
+    matrix->nnz = source->nnz;
+    matrix->order = order;
+    matrix->ptr = ptr;
+    matrix->indices = indices;
+    matrix->values = values;
+    return matrix;
+}
+
+CSRStatus get_element_csr(CSRMatrix* matrix, int i, int j, float* out_value){
+    if(!matrix){
+        return CSR_ERROR_NULL_MATRIX;
+    }
+    if(!out_value){
+        return CSR_ERROR_INVALID_ARGUMENT;
+    }
+    if(i < 0 || i >= matrix->rows || j < 0 || j >= matrix->columns){
+        return CSR_ERROR_OUT_OF_BOUNDS;
+    }
+    int outer = matrix->order == CSR_ORDER_ROWS ? i : j;
+    int key = matrix->order == CSR_ORDER_ROWS ? j : i;
+
+    //Busca binária pelo primeiro índice >= key dentro da fileira.
+    int low = matrix->ptr[outer];
+    int high = matrix->ptr[outer + 1];
+    while(low < high){
+        int middle = low + (high - low) / 2;
+        if(matrix->indices[middle] < key){
+            low = middle + 1;
+        }
+        else{
+            high = middle;
+        }
+    }
+    if(low < matrix->ptr[outer + 1] && matrix->indices[low] == key){
+        *out_value = matrix->values[low];
+        return CSR_STATUS_OK;
+    }
+    *out_value = 0.0f;
+    return CSR_STATUS_NOT_FOUND;
+}
+
+CSRStatus transpose_csr(CSRMatrix* matrix){
+    if(!matrix){
+        return CSR_ERROR_NULL_MATRIX;
+    }
+    int temp = matrix->rows;
+    matrix->rows = matrix->columns;
+    matrix->columns = temp;
+    matrix->order = matrix->order == CSR_ORDER_ROWS ? CSR_ORDER_COLUMNS : CSR_ORDER_ROWS;
+    return CSR_STATUS_OK;
+}
+
+CSRStatus convert_order_csr(CSRMatrix* matrix, CSROrder order){
+    if(!matrix){
+        return CSR_ERROR_NULL_MATRIX;
+    }
+    if(order != CSR_ORDER_ROWS && order != CSR_ORDER_COLUMNS){
+        return CSR_ERROR_INVALID_ARGUMENT;
+    }
+    if(matrix->order == order){
+        return CSR_STATUS_OK;
+    }
+    int *ptr, *indices;
+    float* values;
+    _arrays_in_order(matrix, order, &ptr, &indices, &values);
+    _replace(matrix, order, matrix->nnz, ptr, indices, values);
+    return CSR_STATUS_OK;
+}
+
+CSRStatus scalar_mul_csr(CSRMatrix* A, CSRMatrix* B, float a){
+    if(!A || !B){
+        return CSR_ERROR_NULL_MATRIX;
+    }
+    if(A->rows != B->rows || A->columns != B->columns){
+        return CSR_ERROR_DIMENSION_MISMATCH;
+    }
+    int outer = _outer_count(A, A->order);
+    int *ptr, *indices;
+    float* values;
+    _alloc_arrays(outer, a == 0.0f ? 0 : A->nnz, &ptr, &indices, &values);
+
+    //Produtos que resultam em zero (a = 0 ou underflow) não são guardados.
+    int count = 0;
+    if(a != 0.0f){
+        for(int r = 0; r < outer; r++){
+            for(int p = A->ptr[r]; p < A->ptr[r + 1]; p++){
+                float value = A->values[p] * a;
+                if(value != 0.0f){
+                    indices[count] = A->indices[p];
+                    values[count] = value;
+                    count++;
+                }
+            }
+            ptr[r + 1] = count;
+        }
+    }
+    _replace(B, A->order, count, ptr, indices, values);
+    return CSR_STATUS_OK;
+}
+
+CSRStatus sum_csr(CSRMatrix* A, CSRMatrix* B, CSRMatrix* C){
+    if(!A || !B || !C){
+        return CSR_ERROR_NULL_MATRIX;
+    }
+    if(A->rows != B->rows || A->columns != B->columns || A->rows != C->rows || A->columns != C->columns){
+        return CSR_ERROR_DIMENSION_MISMATCH;
+    }
+    int *b_ptr, *b_indices;
+    float* b_values;
+    int owned = _arrays_in_order(B, A->order, &b_ptr, &b_indices, &b_values);
+
+    int outer = _outer_count(A, A->order);
+    int *ptr, *indices;
+    float* values;
+    _alloc_arrays(outer, A->nnz + B->nnz, &ptr, &indices, &values);
+
+    //Intercalação de duas sequências ordenadas por fileira; somas nulas são descartadas.
+    int count = 0;
+    for(int r = 0; r < outer; r++){
+        int p = A->ptr[r], p_end = A->ptr[r + 1];
+        int q = b_ptr[r], q_end = b_ptr[r + 1];
+        while(p < p_end || q < q_end){
+            int key;
+            float value;
+            if(q == q_end || (p < p_end && A->indices[p] < b_indices[q])){
+                key = A->indices[p];
+                value = A->values[p++];
+            }
+            else if(p == p_end || b_indices[q] < A->indices[p]){
+                key = b_indices[q];
+                value = b_values[q++];
+            }
+            else{
+                key = A->indices[p];
+                value = A->values[p++] + b_values[q++];
+            }
+            if(value != 0.0f){
+                indices[count] = key;
+                values[count] = value;
+                count++;
+            }
+        }
+        ptr[r + 1] = count;
+    }
+
+    if(owned){
+        free(b_ptr);
+        free(b_indices);
+        free(b_values);
+    }
+    _replace(C, A->order, count, ptr, indices, values);
+    return CSR_STATUS_OK;
+}
+
+/**
+ * @brief Fileiras [begin, end) do fator esquerdo calculadas como uma unidade de trabalho do produto.
+ *
+ * Cada fatia tem vetores de saída próprios; nada é compartilhado para escrita, então
+ * as threads não usam locks.
+ */
+typedef struct CSRMultiplySlice{
+    int begin, end;  //fileiras [begin, end) do fator esquerdo
+    int* ptr;        //saída: end - begin + 1 posições, relativas ao início da fatia
+    int* indices;    //saída: índices do resultado
+    float* values;   //saída: valores paralelos a indices
+    int count;       //saída: elementos da fatia
+} CSRMultiplySlice;
+
+/**
+ * @brief Acumulador esparso de um participante do pool, reaproveitado entre as fatias que ele executa.
+ *
+ * Valores densos, marcador da última fileira que tocou cada índice e lista dos índices
+ * tocados. Como cada fileira pertence a uma única fatia, o marcador nunca precisa ser limpo.
+ */
+typedef struct CSRMultiplyScratch{
+    float* accumulator;
+    int* marker;
+    int* touched;
+} CSRMultiplyScratch;
+
+/**
+ * @brief Produto dividido em fatias, executado pelo pool.
+ */
+typedef struct CSRMultiplyJob{
+    const int *l_ptr, *l_indices, *r_ptr, *r_indices;
+    const float *l_values, *r_values;
+    int inner;                   //índices possíveis do resultado (tamanho do acumulador)
+    int sorted;                  //ordenar os índices de cada fileira
+    CSRMultiplySlice* slices;
+    CSRMultiplyScratch* scratch; //um por participante, alocado na primeira fatia que ele executa
+} CSRMultiplyJob;
+
+/**
+ * @brief Calcula as fileiras de uma fatia do produto por Gustavson.
+ */
+static void _multiply_slice(const CSRMultiplyJob* job, CSRMultiplyScratch* scratch, CSRMultiplySlice* slice){
+    int capacity = job->l_ptr[slice->end] - job->l_ptr[slice->begin];
+    _alloc_arrays(slice->end - slice->begin, capacity, &slice->ptr, &slice->indices, &slice->values);
+    if(capacity < 1){
+        capacity = 1;
+    }
+    float* accumulator = scratch->accumulator;
+    int* marker = scratch->marker;
+    int* touched = scratch->touched;
+
+    int count = 0;
+    for(int r = slice->begin; r < slice->end; r++){
+        int touched_count = 0;
+        for(int p = job->l_ptr[r]; p < job->l_ptr[r + 1]; p++){
+            int middle = job->l_indices[p];
+            float l_value = job->l_values[p];
+            for(int q = job->r_ptr[middle]; q < job->r_ptr[middle + 1]; q++){
+                int c = job->r_indices[q];
+                if(marker[c] != r){
+                    marker[c] = r;
+                    accumulator[c] = l_value * job->r_values[q];
+                    touched[touched_count++] = c;
+                }
+                else{
+                    accumulator[c] += l_value * job->r_values[q];
+                }
+            }
+        }
+
+        if(job->sorted){
+            qsort(touched, touched_count, sizeof(int), _compare_int);
+        }
+        if(count + touched_count > capacity){
+            while(count + touched_count > capacity){
+                capacity = capacity * 2;
+            }
+            slice->indices = realloc(slice->indices, sizeof(int) * capacity);
+            slice->values = realloc(slice->values, sizeof(float) * capacity);
+            if(!slice->indices || !slice->values){
+                _allocation_fail();
+            }
+        }
+        for(int t = 0; t < touched_count; t++){
+            int c = touched[t];
+            if(accumulator[c] != 0.0f){
+                slice->indices[count] = c;
+                slice->values[count] = accumulator[c];
+                count++;
+            }
+        }
+        slice->ptr[r + 1 - slice->begin] = count;
+    }
+    slice->count = count;
+}
+
+/**
+ * @brief Tarefa do pool: calcula as fatias [begin, end) com o acumulador do participante worker.
+ */
+static void _multiply_slices_task(int begin, int end, int worker, void* context){
+    CSRMultiplyJob* job = context;
+    CSRMultiplyScratch* scratch = &job->scratch[worker];
+    if(!scratch->accumulator){
+        size_t inner = job->inner > 0 ? (size_t) job->inner : 1;
+        scratch->accumulator = malloc(sizeof(float) * inner);
+        scratch->marker = malloc(sizeof(int) * inner);
+        scratch->touched = malloc(sizeof(int) * inner);
+        if(!scratch->accumulator || !scratch->marker || !scratch->touched){
+            _allocation_fail();
+        }
+        for(int c = 0; c < job->inner; c++){
+            scratch->marker[c] = -1;
+        }
+    }
+    for(int s = begin; s < end; s++){
+        _multiply_slice(job, scratch, &job->slices[s]);
+    }
+}
+
+/**
+ * @brief Divide as fileiras do fator esquerdo em fatias contíguas com número parecido de operações.
+ *
+ * O custo estimado da fileira r é o número de multiplicações de Gustavson, a soma de
+ * nnz(right(p,:)) para cada left(r,p); fileiras longas ou que tocam fileiras densas do
+ * fator direito pesam mais.
+ *
+ * @param outer fileiras do fator esquerdo.
+ * @param l_ptr, l_indices fator esquerdo.
+ * @param r_ptr ponteiros de fileira do fator direito.
+ * @param parts número de fatias.
+ * @param bounds saída: parts+1 posições; a fatia t ocupa as fileiras [bounds[t], bounds[t+1]).
+ */
+static void _partition_rows(int outer, const int* l_ptr, const int* l_indices, const int* r_ptr, int parts, int* bounds){
+    long long* work = malloc(sizeof(long long) * ((size_t) outer + 1));
+    if(!work){
+        _allocation_fail();
+    }
+    work[0] = 0;
+    for(int r = 0; r < outer; r++){
+        long long flops = 0;
+        for(int p = l_ptr[r]; p < l_ptr[r + 1]; p++){
+            flops += r_ptr[l_indices[p] + 1] - r_ptr[l_indices[p]];
+        }
+        work[r + 1] = work[r] + flops + 1; //+1: fileiras vazias ainda custam uma iteração
+    }
+    bounds[0] = 0;
+    int row = 0;
+    for(int t = 1; t < parts; t++){
+        long long target = work[outer] * t / parts;
+        while(row < outer && work[row] < target){
+            row++;
+        }
+        bounds[t] = row;
+    }
+    bounds[parts] = outer;
+    free(work);
+}
+
+int gustavson_csr(ThreadPool* pool, int outer, int inner, const int* l_ptr, const int* l_indices, const float* l_values,
+                  const int* r_ptr, const int* r_indices, const float* r_values, int sorted,
+                  int** ptr, int** indices, float** values){
+    //Várias fatias por participante: as de custo mal estimado são compensadas por roubo de trabalho.
+    int workers = thread_pool_size(pool);
+    int parts = workers == 1 ? 1 : workers * CSR_SPGEMM_SLICES_PER_THREAD;
+    if(parts > outer){
+        parts = outer;
+    }
+    if(parts < 1){
+        _alloc_arrays(outer, 0, ptr, indices, values);
+        return 0;
+    }
+    int* bounds = malloc(sizeof(int) * ((size_t) parts + 1));
+    CSRMultiplySlice* slices = malloc(sizeof(CSRMultiplySlice) * parts);
+    CSRMultiplyScratch* scratch = calloc(workers, sizeof(CSRMultiplyScratch));
+    if(!bounds || !slices || !scratch){
+        _allocation_fail();
+    }
+    _partition_rows(outer, l_ptr, l_indices, r_ptr, parts, bounds);
+    for(int s = 0; s < parts; s++){
+        slices[s] = (CSRMultiplySlice){bounds[s], bounds[s + 1], NULL, NULL, NULL, 0};
+    }
+    CSRMultiplyJob job = {l_ptr, l_indices, r_ptr, r_indices, l_values, r_values, inner, sorted, slices, scratch};
+    parallel_for_thread_pool(pool, 0, parts, 1, THREAD_POOL_STEALING, _multiply_slices_task, &job);
+    for(int w = 0; w < workers; w++){
+        free(scratch[w].accumulator);
+        free(scratch[w].marker);
+        free(scratch[w].touched);
+    }
+
+    //Montagem: as fatias são contíguas e em ordem, então basta concatená-las.
+    int count = 0;
+    if(parts == 1){
+        *ptr = slices[0].ptr;
+        *indices = slices[0].indices;
+        *values = slices[0].values;
+        count = slices[0].count;
+    }
+    else{
+        for(int s = 0; s < parts; s++){
+            count += slices[s].count;
+        }
+        _alloc_arrays(outer, count, ptr, indices, values);
+        int offset = 0;
+        for(int s = 0; s < parts; s++){
+            for(int r = slices[s].begin; r < slices[s].end; r++){
+                (*ptr)[r + 1] = offset + slices[s].ptr[r + 1 - slices[s].begin];
+            }
+            memcpy(&(*indices)[offset], slices[s].indices, sizeof(int) * slices[s].count);
+            memcpy(&(*values)[offset], slices[s].values, sizeof(float) * slices[s].count);
+            offset += slices[s].count;
+            free(slices[s].ptr);
+            free(slices[s].indices);
+            free(slices[s].values);
+        }
+    }
+    free(bounds);
+    free(slices);
+    free(scratch);
+    return count;
+}
+
+CSRStatus matrix_mul_csr(CSRMatrix* A, CSRMatrix* B, CSRMatrix* C){
+    if(!A || !B || !C){
+        return CSR_ERROR_NULL_MATRIX;
+    }
+    if(A->columns != B->rows || C->rows != A->rows || C->columns != B->columns){
+        return CSR_ERROR_DIMENSION_MISMATCH;
+    }
+    int *b_ptr, *b_indices;
+    float* b_values;
+    int owned = _arrays_in_order(B, A->order, &b_ptr, &b_indices, &b_values);
+
+    int *ptr, *indices;
+    float* values;
+    int count;
+    if(A->order == CSR_ORDER_ROWS){
+        count = gustavson_csr(thread_pool_global(), A->rows, B->columns, A->ptr, A->indices, A->values,
+                              b_ptr, b_indices, b_values, 1, &ptr, &indices, &values);
+    }
+    else{
+        //Em CSC, os vetores de B e A são as linhas de B^T e A^T: C^T = B^T A^T sai em CSR, isto é, C em CSC.
+        count = gustavson_csr(thread_pool_global(), B->columns, A->rows, b_ptr, b_indices, b_values,
+                              A->ptr, A->indices, A->values, 1, &ptr, &indices, &values);
+    }
+
+    if(owned){
+        free(b_ptr);
+        free(b_indices);
+        free(b_values);
+    }
+    _replace(C, A->order, count, ptr, indices, values);
+    return CSR_STATUS_OK;
+}
+
+/**
+ * @brief Produto escalar de cada fileira com x: y[r] = soma de values[p] * x[indices[p]].
+ */
+typedef void (*_GatherKernel)(int outer, const int* ptr, const int* indices, const float* values, const float* x, float* y);
+
+/**
+ * @brief Espalhamento de cada fileira: y[indices[p]] += values[p] * x[r], com y já zerado.
+ */
+typedef void (*_ScatterKernel)(int outer, const int* ptr, const int* indices, const float* values, const float* x, float* y);
+
+static CSRKernel _spmv_kernel = CSR_KERNEL_AUTO; //variante pedida por set_spmv_kernel_csr
+static CSRKernel _best_kernel = CSR_KERNEL_AUTO; //melhor variante do processador, resolvida uma vez
+static pthread_once_t _best_kernel_once = PTHREAD_ONCE_INIT; //a primeira chamada pode vir de várias threads
+
+static void _gather_scalar(int outer, const int* ptr, const int* indices, const float* values, const float* x, float* y){
+    for(int r = 0; r < outer; r++){
+        float sum = 0.0f;
+        for(int p = ptr[r]; p < ptr[r + 1]; p++){
+            sum += values[p] * x[indices[p]];
+        }
+        y[r] = sum;
+    }
+}
+
+static void _scatter_scalar(int outer, const int* ptr, const int* indices, const float* values, const float* x, float* y){
+    for(int r = 0; r < outer; r++){
+        float x_value = x[r];
+        if(x_value == 0.0f){
+            continue;
+        }
+        for(int p = ptr[r]; p < ptr[r + 1]; p++){
+            y[indices[p]] += values[p] * x_value;
+        }
+    }
+}
+
+#ifdef CSR_X86_KERNELS
+/**
+ * @brief Variante AVX2 de _gather_scalar: 8 elementos por passo, resto da fileira escalar.
+ *
+ * Fileiras com menos de 8 elementos não entram no caminho vetorial, evitando a
+ * redução horizontal.
+ */
+__attribute__((target("avx2,fma")))
+static void _gather_avx2(int outer, const int* ptr, const int* indices, const float* values, const float* x, float* y){
+    for(int r = 0; r < outer; r++){
+        int p = ptr[r];
+        int end = ptr[r + 1];
+        float sum = 0.0f;
+        if(end - p >= 8){
+            __m256 accumulator = _mm256_setzero_ps();
+            for(; p + 8 <= end; p += 8){
+                __m256i index = _mm256_loadu_si256((const __m256i*) &indices[p]);
+                __m256 x_values = _mm256_i32gather_ps(x, index, 4);
+                accumulator = _mm256_fmadd_ps(_mm256_loadu_ps(&values[p]), x_values, accumulator);
+            }
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(accumulator), _mm256_extractf128_ps(accumulator, 1));
+            half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            half = _mm_add_ss(half, _mm_movehdup_ps(half));
+            sum = _mm_cvtss_f32(half);
+        }
+        for(; p < end; p++){
+            sum += values[p] * x[indices[p]];
+        }
+        y[r] = sum;
+    }
+}
+
+/**
+ * @brief Variante AVX-512 de _gather_scalar: 16 elementos por passo, resto com máscara.
+ */
+__attribute__((target("avx512f")))
+static void _gather_avx512(int outer, const int* ptr, const int* indices, const float* values, const float* x, float* y){
+    for(int r = 0; r < outer; r++){
+        int p = ptr[r];
+        int end = ptr[r + 1];
+        __m512 accumulator = _mm512_setzero_ps();
+        for(; p + 16 <= end; p += 16){
+            __m512i index = _mm512_loadu_si512(&indices[p]);
+            __m512 x_values = _mm512_i32gather_ps(index, x, 4);
+            accumulator = _mm512_fmadd_ps(_mm512_loadu_ps(&values[p]), x_values, accumulator);
+        }
+        if(p < end){
+            __mmask16 mask = (__mmask16) ((1u << (end - p)) - 1);
+            __m512i index = _mm512_maskz_loadu_epi32(mask, &indices[p]);
+            __m512 x_values = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, index, x, 4);
+            accumulator = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &values[p]), x_values, accumulator);
+        }
+        y[r] = _mm512_reduce_add_ps(accumulator);
+    }
+}
+
+/**
+ * @brief Variante AVX-512 de _scatter_scalar.
+ *
+ * Os índices de uma fileira são distintos, então o scatter de um passo nunca grava
+ * duas vezes na mesma posição de y.
+ */
+__attribute__((target("avx512f")))
+static void _scatter_avx512(int outer, const int* ptr, const int* indices, const float* values, const float* x, float* y){
+    for(int r = 0; r < outer; r++){
+        float x_value = x[r];
+        if(x_value == 0.0f){
+            continue;
+        }
+        __m512 broadcast = _mm512_set1_ps(x_value);
+        int p = ptr[r];
+        int end = ptr[r + 1];
+        for(; p + 16 <= end; p += 16){
+            __m512i index = _mm512_loadu_si512(&indices[p]);
+            __m512 y_values = _mm512_i32gather_ps(index, y, 4);
+            y_values = _mm512_fmadd_ps(_mm512_loadu_ps(&values[p]), broadcast, y_values);
+            _mm512_i32scatter_ps(y, index, y_values, 4);
+        }
+        for(; p < end; p++){
+            y[indices[p]] += values[p] * x_value;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Indica se o processador executa a variante.
+ */
+static int _kernel_supported(CSRKernel kernel){
+    switch(kernel){
+        case CSR_KERNEL_AUTO:
+        case CSR_KERNEL_SCALAR:
+            return 1;
+#ifdef CSR_X86_KERNELS
+        case CSR_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case CSR_KERNEL_AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return 0;
+    }
+}
+
+CSRStatus set_spmv_kernel_csr(CSRKernel kernel){
+    if(!_kernel_supported(kernel)){
+        return CSR_ERROR_INVALID_ARGUMENT;
+    }
+    _spmv_kernel = kernel;
+    return CSR_STATUS_OK;
+}
+
+/**
+ * @brief Resolve _best_kernel; executada uma única vez, por pthread_once.
+ */
+static void _resolve_best_kernel(void){
+    _best_kernel = _kernel_supported(CSR_KERNEL_AVX512) ? CSR_KERNEL_AVX512
+                 : _kernel_supported(CSR_KERNEL_AVX2) ? CSR_KERNEL_AVX2
+                 : CSR_KERNEL_SCALAR;
+}
+
+CSRKernel get_spmv_kernel_csr(void){
+    if(_spmv_kernel != CSR_KERNEL_AUTO){
+        return _spmv_kernel;
+    }
+    pthread_once(&_best_kernel_once, _resolve_best_kernel);
+    return _best_kernel;
+}
+
+/**
+ * @brief Produto escalar por fileira dividido entre as threads do pool.
+ */
+typedef struct CSRGatherJob{
+    _GatherKernel kernel;
+    const int* ptr;
+    const int* indices;
+    const float* values;
+    const float* x;
+    float* y;
+} CSRGatherJob;
+
+/**
+ * @brief Calcula as fileiras [begin, end); como ptr guarda posições absolutas, basta deslocá-lo.
+ */
+static void _gather_rows_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    CSRGatherJob* job = context;
+    job->kernel(end - begin, job->ptr + begin, job->indices, job->values, job->x, job->y + begin);
+}
+
+/**
+ * @brief Calcula y = M * x (transposed = 0) ou y = M^T * x (transposed = 1).
+ *
+ * Quando a fileira armazenada coincide com a posição de y, cada y é um produto escalar
+ * (gather); caso contrário, cada fileira é espalhada em y (scatter).
+ */
+static CSRStatus _spmv(CSRMatrix* matrix, const float* x, float* y, int transposed){
+    if(!matrix){
+        return CSR_ERROR_NULL_MATRIX;
+    }
+    if(!x || !y){
+        return CSR_ERROR_INVALID_ARGUMENT;
+    }
+    CSRKernel kernel = get_spmv_kernel_csr();
+    int outer = _outer_count(matrix, matrix->order);
+    int gather = (matrix->order == CSR_ORDER_ROWS) != transposed;
+    if(gather){
+        _GatherKernel gather_kernel = _gather_scalar;
+#ifdef CSR_X86_KERNELS
+        if(kernel == CSR_KERNEL_AVX512){
+            gather_kernel = _gather_avx512;
+        }
+        else if(kernel == CSR_KERNEL_AVX2){
+            gather_kernel = _gather_avx2;
+        }
+#endif
+        //Cada fileira escreve apenas o próprio y, então os blocos do pool não conflitam.
+        CSRGatherJob job = {gather_kernel, matrix->ptr, matrix->indices, matrix->values, x, y};
+        ThreadPool* pool = matrix->nnz >= CSR_SPMV_PARALLEL_NNZ ? thread_pool_global() : NULL;
+        parallel_for_thread_pool(pool, 0, outer, CSR_SPMV_GRAIN, THREAD_POOL_STEALING, _gather_rows_task, &job);
+        return CSR_STATUS_OK;
+    }
+
+    int length = transposed ? matrix->columns : matrix->rows;
+    for(int t = 0; t < length; t++){
+        y[t] = 0.0f;
+    }
+    _ScatterKernel scatter_kernel = _scatter_scalar;
+#ifdef CSR_X86_KERNELS
+    if(kernel == CSR_KERNEL_AVX512){
+        scatter_kernel = _scatter_avx512;
+    }
+#endif
+    scatter_kernel(outer, matrix->ptr, matrix->indices, matrix->values, x, y);
+    return CSR_STATUS_OK;
+}
+
+CSRStatus spmv_csr(CSRMatrix* A, const float* x, float* y){
+    return _spmv(A, x, y, 0);
+}
+
+CSRStatus spmv_transposed_csr(CSRMatrix* A, const float* x, float* y){
+    return _spmv(A, x, y, 1);
+}
+
+const char* csr_status_string(CSRStatus status){
+    switch(status){
+        case CSR_STATUS_OK:
+            return "Operation completed successfully";
+        case CSR_STATUS_NOT_FOUND:
+            return "Element not found";
+        case CSR_ERROR_NULL_MATRIX:
+            return "Matrix pointer is NULL";
+        case CSR_ERROR_OUT_OF_BOUNDS:
+            return "Indices out of bounds";
+        case CSR_ERROR_DIMENSION_MISMATCH:
+            return "Matrix dimensions mismatch";
+        case CSR_ERROR_INVALID_ARGUMENT:
+            return "Invalid argument";
+        default:
+            return "Unknown error";
+    }
+}
+
+void free_csr_matrix(CSRMatrix* matrix){
+    if(!matrix){
+        return;
+    }
+    free(matrix->ptr);
+    free(matrix->indices);
+    free(matrix->values);
+    free(matrix);
+}
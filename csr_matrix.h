@@ -0,0 +1,264 @@
+#pragma once
+#include "avl_matrix.h"
+#include "hash_matrix.h"
+
+/**
+ * @file csr_matrix.h
+ * @brief Matriz esparsa congelada em vetores contíguos (formatos CSR e CSC).
+ */
+
+/**
+ * @brief Direção de compressão dos vetores da matriz.
+ */
+typedef enum {
+    CSR_ORDER_ROWS = 0,   /**< CSR: ptr percorre as linhas e indices guarda colunas. */
+    CSR_ORDER_COLUMNS = 1 /**< CSC: ptr percorre as colunas e indices guarda linhas. */
+} CSROrder;
+
+/**
+ * @brief Matriz esparsa comprimida, somente leitura depois de construída.
+ *
+ * Sendo outer = rows no formato CSR e outer = columns no CSC, a fileira r ocupa as
+ * posições [ptr[r], ptr[r+1]) de indices e values, com índices em ordem crescente.
+ * Os três vetores são contíguos, então percorrer a matriz é um acesso sequencial e o
+ * custo é 4 * (outer + 1) + 8 * nnz bytes.
+ *
+ * A transposição apenas troca rows com columns e inverte order: os mesmos vetores
+ * lidos como CSC descrevem a transposta da matriz lida como CSR.
+ */
+typedef struct CSRMatrix{
+    int rows, columns; //dimensões lógicas
+    int nnz;           //número de elementos não nulos
+    CSROrder order;
+    int* ptr;          //outer + 1 posições
+    int* indices;      //nnz posições, crescentes dentro de cada fileira
+    float* values;     //nnz posições, paralelos a indices
+} CSRMatrix;
+
+/**
+ * @brief Implementação do produto matriz-vetor.
+ *
+ * ::CSR_KERNEL_AUTO escolhe, na primeira chamada, a melhor variante que o processador
+ * executa; as demais forçam uma variante (útil para comparações).
+ */
+typedef enum {
+    CSR_KERNEL_AUTO = 0,   /**< Melhor variante disponível em tempo de execução (padrão). */
+    CSR_KERNEL_SCALAR = 1, /**< Laço escalar, disponível em qualquer processador. */
+    CSR_KERNEL_AVX2 = 2,   /**< Gathers de 8 floats com AVX2 e FMA. */
+    CSR_KERNEL_AVX512 = 3  /**< Gathers e scatters de 16 floats com AVX-512F, com máscara no resto da fileira. */
+} CSRKernel;
+
+/**
+ * @brief Códigos de retorno das operações na matriz comprimida.
+ */
+typedef enum {
+    CSR_STATUS_OK = 0,                 /**< Operação concluída com sucesso. */
+    CSR_STATUS_NOT_FOUND = 1,          /**< Elemento solicitado não existe. */
+    CSR_ERROR_NULL_MATRIX = -1,        /**< Ponteiro de matriz nulo. */
+    CSR_ERROR_OUT_OF_BOUNDS = -2,      /**< Índices fora dos limites da matriz. */
+    CSR_ERROR_DIMENSION_MISMATCH = -3, /**< Incompatibilidade de dimensões entre matrizes. */
+    CSR_ERROR_INVALID_ARGUMENT = -4    /**< Parâmetro inválido. */
+} CSRStatus;
+
+/**
+ * @brief Cria uma matriz comprimida vazia, no formato CSR.
+ *
+ * Serve de destino para as operações, que substituem os vetores do resultado.
+ *
+ * @param rows número de linhas.
+ * @param columns número de colunas.
+ * @return Ponteiro para a nova matriz ou NULL se as dimensões forem inválidas.
+ */
+CSRMatrix* create_csr_matrix(int rows, int columns);
+
+/**
+ * @brief Congela uma matriz AVL no formato CSR.
+ *
+ * Custo O(n + k): as linhas já estão ordenadas na árvore.
+ *
+ * @param source matriz de origem.
+ * @return Ponteiro para a nova matriz ou NULL se source for inválida.
+ */
+CSRMatrix* create_csr_matrix_from_avl(AVLMatrix* source);
+
+/**
+ * @brief Congela uma matriz hash no formato CSR.
+ *
+ * Custo O(linhas + colunas + count), para qualquer estratégia de armazenamento;
+ * a transposição e o fator escalar pendentes são respeitados.
+ *
+ * @param source matriz de origem.
+ * @return Ponteiro para a nova matriz ou NULL se source for inválida.
+ */
+CSRMatrix* create_csr_matrix_from_hash(HashMatrix* source);
+
+/**
+ * @brief Copia uma matriz comprimida, na direção pedida.
+ *
+ * Custo O(linhas + colunas + nnz): uma única passada de ordenação por contagem
+ * quando as direções diferem, ou uma cópia direta dos vetores.
+ *
+ * @param source matriz de origem.
+ * @param order direção da cópia.
+ * @return Ponteiro para a nova matriz ou NULL se source ou order forem inválidos.
+ */
+CSRMatrix* create_csr_matrix_from_csr(CSRMatrix* source, CSROrder order);
+
+/**
+ * @brief Obtém o valor de um elemento por busca binária na fileira.
+ *
+ * @param matrix ponteiro para a matriz.
+ * @param i índice de linha.
+ * @param j índice de coluna.
+ * @param out_value saída: valor do elemento (0 se ausente).
+ * @return ::CSR_STATUS_OK, ::CSR_STATUS_NOT_FOUND ou código de erro.
+ */
+CSRStatus get_element_csr(CSRMatrix* matrix, int i, int j, float* out_value);
+
+/**
+ * @brief Transpõe a matriz em O(1), alternando entre CSR e CSC.
+ *
+ * @param matrix ponteiro para a matriz.
+ * @return Código ::CSRStatus indicando sucesso ou motivo da falha.
+ */
+CSRStatus transpose_csr(CSRMatrix* matrix);
+
+/**
+ * @brief Reorganiza os vetores para a direção pedida, sem mudar a matriz lógica.
+ *
+ * Custo O(rows + columns + nnz) por ordenação por contagem; nenhum custo se a
+ * matriz já estiver em order.
+ *
+ * @param matrix ponteiro para a matriz.
+ * @param order direção desejada.
+ * @return Código ::CSRStatus indicando sucesso ou motivo da falha.
+ */
+CSRStatus convert_order_csr(CSRMatrix* matrix, CSROrder order);
+
+/**
+ * @brief Calcula B = a * A, com B na mesma direção de A.
+ *
+ * A e B podem ser a mesma matriz.
+ *
+ * @param A matriz de origem.
+ * @param B matriz resultado (mesmas dimensões de A).
+ * @param a fator escalar.
+ * @return Código ::CSRStatus indicando sucesso ou motivo da falha.
+ */
+CSRStatus scalar_mul_csr(CSRMatrix* A, CSRMatrix* B, float a);
+
+/**
+ * @brief Calcula C = A + B por intercalação das fileiras ordenadas.
+ *
+ * O resultado fica na direção de A; se B estiver na outra direção, uma cópia
+ * reorganizada é usada. C pode ser a mesma matriz que A ou B.
+ *
+ * @param A primeira parcela.
+ * @param B segunda parcela.
+ * @param C matriz resultado.
+ * @return Código ::CSRStatus indicando sucesso ou motivo da falha.
+ */
+CSRStatus sum_csr(CSRMatrix* A, CSRMatrix* B, CSRMatrix* C);
+
+/**
+ * @brief Calcula C = A * B pelo algoritmo de Gustavson.
+ *
+ * Com A em CSR, C(i,:) acumula A(i,p) * B(p,:) e sai em CSR; com A em CSC, o mesmo
+ * é feito por colunas e C sai em CSC. B é reorganizado para a direção de A quando
+ * necessário. C pode ser a mesma matriz que A ou B. Com o pool global inicializado, as
+ * fileiras são divididas entre as threads (ver gustavson_csr).
+ *
+ * @param A primeiro fator.
+ * @param B segundo fator.
+ * @param C matriz resultado (A->rows x B->columns).
+ * @return Código ::CSRStatus indicando sucesso ou motivo da falha.
+ */
+CSRStatus matrix_mul_csr(CSRMatrix* A, CSRMatrix* B, CSRMatrix* C);
+
+/**
+ * @brief Produto de dois pares de vetores comprimidos na mesma direção (Gustavson).
+ *
+ * Núcleo comum aos produtos das matrizes CSR, AVL e hash, que achatam os operandos e
+ * chamam esta função. A fileira r do resultado acumula left(r, p) * right(p, :) em um
+ * acumulador denso. As fileiras de left são divididas em fatias contíguas com número
+ * parecido de multiplicações, várias por participante do pool, e cada participante
+ * reaproveita o próprio acumulador entre as fatias que executa.
+ *
+ * @param pool pool que executa as fatias (NULL: thread chamadora).
+ * @param outer fileiras de left e do resultado.
+ * @param inner índices possíveis nas fileiras de right (e do resultado).
+ * @param l_ptr, l_indices, l_values fator esquerdo.
+ * @param r_ptr, r_indices, r_values fator direito.
+ * @param sorted se diferente de zero, os índices de cada fileira do resultado saem em
+ * ordem crescente; caso contrário, na ordem em que foram tocados.
+ * @param ptr, indices, values saída: resultado (outer + 1, count e count posições;
+ * indices e values têm ao menos uma), alocado com malloc.
+ * @return Número de elementos do resultado (somas nulas são descartadas).
+ */
+int gustavson_csr(ThreadPool* pool, int outer, int inner, const int* l_ptr, const int* l_indices, const float* l_values,
+                  const int* r_ptr, const int* r_indices, const float* r_values, int sorted,
+                  int** ptr, int** indices, float** values);
+
+/**
+ * @brief Calcula y = A * x.
+ *
+ * Em CSR cada y[i] é o produto escalar da linha i com x, lido com gathers vetoriais
+ * quando a variante escolhida permite; em CSC cada coluna j espalha x[j] * A(:,j) em y
+ * (scatter, vetorial apenas com AVX-512, pois os índices de uma fileira são distintos).
+ * Com o pool global inicializado, o caso CSR de matrizes grandes é dividido em blocos de
+ * linhas com roubo de trabalho; o scatter continua sequencial.
+ * As variantes vetoriais somam em outra ordem, então o resultado pode diferir do
+ * escalar no último bit.
+ *
+ * @param A ponteiro para a matriz.
+ * @param x vetor de A->columns posições.
+ * @param y saída: vetor de A->rows posições (não pode sobrepor x).
+ * @return Código ::CSRStatus indicando sucesso ou motivo da falha.
+ */
+CSRStatus spmv_csr(CSRMatrix* A, const float* x, float* y);
+
+/**
+ * @brief Calcula y = A^T * x sem transpor a matriz.
+ *
+ * Usa os mesmos vetores de spmv_csr com os papéis trocados: em CSR é um scatter por
+ * linha e em CSC um produto escalar por coluna.
+ *
+ * @param A ponteiro para a matriz.
+ * @param x vetor de A->rows posições.
+ * @param y saída: vetor de A->columns posições (não pode sobrepor x).
+ * @return Código ::CSRStatus indicando sucesso ou motivo da falha.
+ */
+CSRStatus spmv_transposed_csr(CSRMatrix* A, const float* x, float* y);
+
+/**
+ * @brief Escolhe a variante usada por spmv_csr e spmv_transposed_csr.
+ *
+ * A escolha vale para todo o processo; não deve ser alterada enquanto outra thread
+ * executa um produto.
+ *
+ * @param kernel variante desejada.
+ * @return ::CSR_ERROR_INVALID_ARGUMENT se o processador não executa a variante.
+ */
+CSRStatus set_spmv_kernel_csr(CSRKernel kernel);
+
+/**
+ * @brief Informa a variante efetivamente usada (nunca ::CSR_KERNEL_AUTO).
+ *
+ * @return Variante em uso.
+ */
+CSRKernel get_spmv_kernel_csr(void);
+
+/**
+ * @brief Converte um código de status em uma mensagem legível.
+ *
+ * @param status código de status.
+ * @return Mensagem descritiva.
+ */
+const char* csr_status_string(CSRStatus status);
+
+/**
+ * @brief Libera a matriz e seus vetores.
+ *
+ * @param matrix ponteiro para a matriz (pode ser NULL).
+ */
+void free_csr_matrix(CSRMatrix* matrix);
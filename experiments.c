@@ -3,36 +3,46 @@
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
+#include <pthread.h>
 #include "hash_matrix.h"
 #include "avl_matrix.h"
+#include "sharded_hash_matrix.h"
+#include "csr_matrix.h"
+#include "bcsr_matrix.h"
+#include "thread_pool.h"
 
 static void _allocation_fail(){
     fprintf(stderr, "Error: memory allocation failed.\n");
     exit(EXIT_FAILURE);
 }
 
+/**
+ * @brief Callback de generate_data: marca a posição e informa se ela já estava marcada.
+ */
+static float _mark_visited(float current, int existed, void* context){
+    (void) current;
+    *(int*) context = existed;
+    return 1.0f;
+}
+
 void generate_data(int n, int m, int k, int* I, int* J, float* Data){
     AVLMatrix* visited = create_matrix_avl(n, m);
     if(!visited){
         _allocation_fail();
     }
+    set_transpose_mode_avl(visited, AVL_TRANSPOSE_LAZY); //só consultas por posição: a transposta nunca é usada
 
     for(int count = 0; count < k;){
         int i = rand() % n;
         int j = rand() % m;
 
-        float already = 0.0f;
-        AVLStatus status = get_element_avl(visited, i, j, &already);
+        int already = 0;
+        AVLStatus status = upsert_element_avl(visited, i, j, _mark_visited, &already);
         if(status != AVL_STATUS_OK){
             free_matrix_avl(visited);
             _allocation_fail();
         }
-        if(already == 0.0f){
-            status = insert_element_avl(visited, 1.0f, i, j);
-            if(status != AVL_STATUS_OK){
-                free_matrix_avl(visited);
-                _allocation_fail();
-            }
+        if(!already){
             I[count] = i;
             J[count] = j;
             Data[count] = ((float) rand()) / ((float) RAND_MAX);
@@ -89,53 +99,59 @@ HashStatus fill_hash_matrix(HashMatrix* matrix, int k, int* I, int* J, float* Da
     return HASH_STATUS_OK;
 }
 
-static unsigned long long int _count_i_nodes_size(InnerNode* inner_tree){
-    if(!inner_tree){
-        return 0;
-    }
-
-    unsigned long long int left = _count_i_nodes_size(inner_tree-> left);
-    unsigned long long int right = _count_i_nodes_size(inner_tree->right);
-    return left + right + (unsigned long long int)sizeof(InnerNode);
-}
-
-static unsigned long long int _count_o_nodes_size(OuterNode* outer_tree){
-    if(!outer_tree){
+static unsigned long long int _avl_matrix_size(AVLMatrix* matrix){
+    if(!matrix){
         return 0;
     }
-    unsigned long long int left = _count_o_nodes_size(outer_tree->left);
-    unsigned long long int right = _count_o_nodes_size(outer_tree->right);
-    return left + right + (unsigned long long int)sizeof(OuterNode) + _count_i_nodes_size(outer_tree->inner_tree);
+    return (unsigned long long int)sizeof(AVLMatrix) + 2 * sizeof(AVLArena) + matrix->main_arena->bytes + matrix->transposed_arena->bytes;
 }
 
-static unsigned long long int _avl_matrix_size(AVLMatrix* matrix){
+static unsigned long long int _csr_matrix_size(CSRMatrix* matrix){
     if(!matrix){
         return 0;
     }
-    return (unsigned long long int)sizeof(AVLMatrix) + _count_o_nodes_size(matrix->main_root) + _count_o_nodes_size(matrix->transposed_root); 
+    unsigned long long int outer = matrix->order == CSR_ORDER_ROWS ? matrix->rows : matrix->columns;
+    return (unsigned long long int) sizeof(CSRMatrix) + (outer + 1) * sizeof(int) + (unsigned long long int) matrix->nnz * (sizeof(int) + sizeof(float));
 }
 
 static unsigned long long int _dense_matrix_size(int n, int m){
     return (unsigned long long int)n * (unsigned long long int)m * (unsigned long long int)sizeof(float);
 }
 
-static unsigned long long int _bucket_size(Node* bucket){
-    if(!bucket){
-        return 0;
-    }
-
-    return (unsigned long long int)sizeof(Node) + _bucket_size(bucket->next);
+/* Tamanho real de um bloco do malloc da glibc: cabeçalho de 8 bytes, arredondado a 16, mínimo 32. */
+static unsigned long long int _malloc_chunk_size(unsigned long long int request){
+    unsigned long long int chunk = (request + 8 + 15) & ~15ULL;
+    return chunk < 32 ? 32 : chunk;
 }
 
 static unsigned long long int _hash_matrix_size(HashMatrix* matrix){
     if(!matrix){
         return 0;
     }
-    unsigned long long int bucket_acc = 0;
-    for(int i = 0; i < matrix->capacity; i++){
-        bucket_acc = bucket_acc + (unsigned long long int) sizeof(Node*) + _bucket_size(matrix->buckets[i]);
+    if(matrix->storage == HASH_STORAGE_OPEN){
+        return (unsigned long long int) sizeof(HashMatrix) + (unsigned long long int) matrix->capacity * (sizeof(unsigned long long) + sizeof(float));
+    }
+    if(matrix->storage == HASH_STORAGE_ROWS){ //tabela de linhas + dois vetores (colunas e valores) por linha
+        unsigned long long int rows_acc = _malloc_chunk_size(sizeof(HashRow) * matrix->capacity);
+        for(int i = 0; i < matrix->capacity; i++){
+            if(matrix->row_table[i].row != -1){
+                rows_acc += _malloc_chunk_size(sizeof(int) * matrix->row_table[i].capacity);
+                rows_acc += _malloc_chunk_size(sizeof(float) * matrix->row_table[i].capacity);
+            }
+        }
+        return (unsigned long long int) sizeof(HashMatrix) + rows_acc;
     }
-    return (unsigned long long int) sizeof(HashMatrix) + bucket_acc;
+    unsigned long long int bucket_acc = (unsigned long long int) matrix->capacity * (unsigned long long int) sizeof(Node*);
+    return (unsigned long long int) sizeof(HashMatrix) + bucket_acc + matrix->pool.bytes;
+}
+
+/* Bytes economizados pelo pool em relação a um malloc por nó (pode ser negativo em matrizes pequenas). */
+static long long int _hash_pool_saved_size(HashMatrix* matrix){
+    if(!matrix || matrix->storage != HASH_STORAGE_CHAINED){
+        return 0;
+    }
+    unsigned long long int per_node = (unsigned long long int) matrix->count * _malloc_chunk_size(sizeof(Node));
+    return (long long int) per_node - (long long int) matrix->pool.bytes;
 }
 
 static double _delta_t_ns(struct timespec a, struct timespec b){
@@ -187,6 +203,625 @@ static void dense_mul(float** A, float** B, float** C, int n, int k, int m){
     }
 }
 
+/* Experimentos de tempo da matriz hash, parametrizados pela estratégia de armazenamento.
+   times recebe, nesta ordem: get, set, transpose, scalar, sum, mul (em ns). */
+static void _hash_time_experiment(HashStorage storage, const char* label, int matrix_length, float sparsity, int k, int* I, int* J, float* Data, double* times){
+    struct timespec t0, t1;
+    printf("%s setup (n=%d, sparsity=%.12f)\n", label, matrix_length, sparsity);
+    HashMatrix* H1 = create_hash_matrix_with_storage(matrix_length, matrix_length, storage);
+    HashMatrix* H2 = create_hash_matrix_with_storage(matrix_length, matrix_length, storage);
+    HashMatrix* H_scalar = create_hash_matrix_with_storage(matrix_length, matrix_length, storage);
+    HashMatrix* H_sum = create_hash_matrix_with_storage(matrix_length, matrix_length, storage);
+    HashMatrix* H_mul = create_hash_matrix_with_storage(matrix_length, matrix_length, storage);
+    if(!H1 || !H2 || !H_scalar || !H_sum || !H_mul){
+        _allocation_fail();
+    }
+    HashStatus hstatus = fill_hash_matrix(H1, k, I, J, Data);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    hstatus = fill_hash_matrix(H2, k, I, J, Data);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    int pos_h = rand() % k;
+    int ih = I[pos_h];
+    int jh = J[pos_h];
+    printf("%s get (n=%d, sparsity=%.12f)\n", label, matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    float hval = get_element_hash(H1, ih, jh);
+    (void)hval;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    times[0] = _delta_t_ns(t0, t1);
+    printf("%s set (n=%d, sparsity=%.12f)\n", label, matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    hstatus = set_element_hash(H1, ih, jh, 3.14f);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    times[1] = _delta_t_ns(t0, t1);
+    printf("%s transpose (n=%d, sparsity=%.12f)\n", label, matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    hstatus = transpose_hash(H1);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    times[2] = _delta_t_ns(t0, t1);
+    hstatus = transpose_hash(H1);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    printf("%s scalar mul (n=%d, sparsity=%.12f)\n", label, matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    hstatus = matrix_scalar_multiplication_hash(H1, H_scalar, 3.0f);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    times[3] = _delta_t_ns(t0, t1);
+    printf("%s sum (n=%d, sparsity=%.12f)\n", label, matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    hstatus = matrix_addition_hash(H1, H2, H_sum);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    times[4] = _delta_t_ns(t0, t1);
+    printf("%s mul (n=%d, sparsity=%.12f)\n", label, matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    hstatus = matrix_multiplication_hash(H1, H2, H_mul);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(hstatus != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    times[5] = _delta_t_ns(t0, t1);
+
+    free_hash_matrix(H1);
+    free_hash_matrix(H2);
+    free_hash_matrix(H_scalar);
+    free_hash_matrix(H_sum);
+    free_hash_matrix(H_mul);
+}
+
+/* Experimentos de tempo da matriz comprimida, congelada a partir de uma matriz hash (conversão fora da medição).
+   times recebe, nesta ordem: get, set, transpose, scalar, sum, mul (em ns); set vale -1, pois o formato não aceita escritas. */
+static void _csr_time_experiment(int matrix_length, float sparsity, int k, int* I, int* J, float* Data, double* times){
+    struct timespec t0, t1;
+    printf("CSR setup (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
+    HashMatrix* source = create_hash_matrix_with_storage(matrix_length, matrix_length, HASH_STORAGE_ROWS);
+    if(!source || fill_hash_matrix(source, k, I, J, Data) != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    CSRMatrix* C1 = create_csr_matrix_from_hash(source);
+    CSRMatrix* C2 = create_csr_matrix_from_hash(source);
+    CSRMatrix* C_scalar = create_csr_matrix(matrix_length, matrix_length);
+    CSRMatrix* C_sum = create_csr_matrix(matrix_length, matrix_length);
+    CSRMatrix* C_mul = create_csr_matrix(matrix_length, matrix_length);
+    free_hash_matrix(source);
+    if(!C1 || !C2 || !C_scalar || !C_sum || !C_mul){
+        _allocation_fail();
+    }
+    int pos_c = rand() % k;
+    printf("CSR get (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
+    float cval;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    CSRStatus cstatus = get_element_csr(C1, I[pos_c], J[pos_c], &cval);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(cstatus != CSR_STATUS_OK && cstatus != CSR_STATUS_NOT_FOUND){
+        _allocation_fail();
+    }
+    times[0] = _delta_t_ns(t0, t1);
+    times[1] = -1.0;
+    printf("CSR transpose (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    cstatus = transpose_csr(C1);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(cstatus != CSR_STATUS_OK){
+        _allocation_fail();
+    }
+    times[2] = _delta_t_ns(t0, t1);
+    transpose_csr(C1);
+    printf("CSR scalar mul (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    cstatus = scalar_mul_csr(C1, C_scalar, 3.0f);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(cstatus != CSR_STATUS_OK){
+        _allocation_fail();
+    }
+    times[3] = _delta_t_ns(t0, t1);
+    printf("CSR sum (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    cstatus = sum_csr(C1, C2, C_sum);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(cstatus != CSR_STATUS_OK){
+        _allocation_fail();
+    }
+    times[4] = _delta_t_ns(t0, t1);
+    printf("CSR mul (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    cstatus = matrix_mul_csr(C1, C2, C_mul);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(cstatus != CSR_STATUS_OK){
+        _allocation_fail();
+    }
+    times[5] = _delta_t_ns(t0, t1);
+
+    free_csr_matrix(C1);
+    free_csr_matrix(C2);
+    free_csr_matrix(C_scalar);
+    free_csr_matrix(C_sum);
+    free_csr_matrix(C_mul);
+}
+
+/* Preenche I,J,Data com uma banda de largura 2*half_width+1 em torno da diagonal (half_width = 0 gera a diagonal). */
+static int _band_data(int n, int half_width, int* I, int* J, float* Data){
+    int count = 0;
+    for(int i = 0; i < n; i++){
+        for(int j = i - half_width; j <= i + half_width; j++){
+            if(j >= 0 && j < n){
+                I[count] = i;
+                J[count] = j;
+                Data[count] = 1.0f;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+static void _probe_experiment(FILE* file, const char* pattern, HashStorage storage, int n, int k, int* I, int* J, float* Data){
+    HashMatrix* matrix = create_hash_matrix_with_storage(n, n, storage);
+    if(!matrix || fill_hash_matrix(matrix, k, I, J, Data) != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    HashProbeStats stats;
+    hash_probe_stats(matrix, &stats);
+    fprintf(file, "%s, %s, %d, %d, %d, %.4f, %d\n",
+            pattern, storage == HASH_STORAGE_OPEN ? "open" : "chained",
+            n, stats.count, stats.capacity, stats.mean_length, stats.max_length);
+    free_hash_matrix(matrix);
+}
+
+/* Mede a latência de cada set_element_hash durante o preenchimento; grava a média e o pior caso. */
+static void _latency_experiment(FILE* file, HashResizeMode mode, int n, int k, int* I, int* J, float* Data){
+    struct timespec t0, t1;
+    HashMatrix* matrix = create_hash_matrix(n, n);
+    if(!matrix || set_resize_mode_hash(matrix, mode) != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    double total = 0.0;
+    double worst = 0.0;
+    for(int count = 0; count < k; count++){
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        set_element_hash(matrix, I[count], J[count], Data[count]);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double elapsed = _delta_t_ns(t0, t1);
+        total += elapsed;
+        if(elapsed > worst){
+            worst = elapsed;
+        }
+    }
+    fprintf(file, "%s, %d, %d, %.1f, %.0f\n",
+            mode == HASH_RESIZE_INCREMENTAL ? "incremental" : "immediate", n, k, total / k, worst);
+    free_hash_matrix(matrix);
+}
+
+/* Compara o preenchimento elemento a elemento com a construção em bloco a partir de triplas. */
+static void _load_experiment(FILE* file, int n, int k){
+    struct timespec t0, t1;
+    int* I = (int*) malloc(sizeof(int) * k);
+    int* J = (int*) malloc(sizeof(int) * k);
+    float* Data = (float*) malloc(sizeof(float) * k);
+    if(!I || !J || !Data){
+        _allocation_fail();
+    }
+    for(int count = 0; count < k; count++){ //Posições repetidas são permitidas; ambos os caminhos mantêm o último valor.
+        I[count] = rand() % n;
+        J[count] = rand() % n;
+        Data[count] = ((float) rand()) / ((float) RAND_MAX);
+    }
+    printf("Hash load (n=%d, k=%d)\n", n, k);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    HashMatrix* filled = create_hash_matrix(n, n);
+    if(!filled || fill_hash_matrix(filled, k, I, J, Data) != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double fill_t = _delta_t_ns(t0, t1);
+    free_hash_matrix(filled);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    HashMatrix* bulk = create_hash_matrix_from_triplets(n, n, k, I, J, Data, HASH_DUPLICATES_OVERWRITE);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if(!bulk){
+        _allocation_fail();
+    }
+    double bulk_t = _delta_t_ns(t0, t1);
+    free_hash_matrix(bulk);
+    fprintf(file, "%d, %d, %.0f, %.0f\n", n, k, fill_t, bulk_t);
+    free(I);
+    free(J);
+    free(Data);
+}
+
+/* Fatia das triplas inserida por uma thread; global_lock != NULL indica a HashMatrix única com mutex global. */
+typedef struct {
+    HashMatrix* matrix;
+    pthread_mutex_t* global_lock;
+    ShardedHashMatrix* sharded;
+    const int* I;
+    const int* J;
+    const float* Data;
+    int begin, end;
+} InsertSlice;
+
+static void* _insert_worker(void* argument){
+    InsertSlice* slice = (InsertSlice*) argument;
+    for(int count = slice->begin; count < slice->end; count++){
+        if(slice->sharded){
+            set_element_sharded_hash(slice->sharded, slice->I[count], slice->J[count], slice->Data[count]);
+        } else {
+            pthread_mutex_lock(slice->global_lock);
+            set_element_hash(slice->matrix, slice->I[count], slice->J[count], slice->Data[count]);
+            pthread_mutex_unlock(slice->global_lock);
+        }
+    }
+    return NULL;
+}
+
+/* Distribui k inserções entre threads produtoras e devolve o tempo total em ns. */
+static double _run_insert_threads(int threads, HashMatrix* matrix, pthread_mutex_t* global_lock, ShardedHashMatrix* sharded, int k, int* I, int* J, float* Data){
+    struct timespec t0, t1;
+    pthread_t* ids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    InsertSlice* slices = (InsertSlice*) malloc(sizeof(InsertSlice) * threads);
+    if(!ids || !slices){
+        _allocation_fail();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int t = 0; t < threads; t++){
+        slices[t] = (InsertSlice){matrix, global_lock, sharded, I, J, Data, (int)((long long) k * t / threads), (int)((long long) k * (t + 1) / threads)};
+        if(pthread_create(&ids[t], NULL, _insert_worker, &slices[t]) != 0){
+            _allocation_fail();
+        }
+    }
+    for(int t = 0; t < threads; t++){
+        pthread_join(ids[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    free(ids);
+    free(slices);
+    return _delta_t_ns(t0, t1);
+}
+
+/* Compara produtores concorrentes serializados por um mutex global com a matriz particionada. */
+static void _sharded_experiment(FILE* file, int threads, int shards, int n, int k, int* I, int* J, float* Data){
+    printf("Sharded insert (threads=%d, shards=%d, k=%d)\n", threads, shards, k);
+    pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
+    HashMatrix* matrix = create_hash_matrix(n, n);
+    ShardedHashMatrix* sharded = create_sharded_hash_matrix(n, n, shards);
+    if(!matrix || !sharded){
+        _allocation_fail();
+    }
+    double global_t = _run_insert_threads(threads, matrix, &global_lock, NULL, k, I, J, Data);
+    double sharded_t = _run_insert_threads(threads, NULL, NULL, sharded, k, I, J, Data);
+    fprintf(file, "%d, %d, %d, %.0f, %.0f\n", threads, shards, k, global_t, sharded_t);
+    free_hash_matrix(matrix);
+    free_sharded_hash_matrix(sharded);
+}
+
+/* Grava uma linha do experimento de SpMV a partir do tempo médio por produto.
+   GFLOP/s conta 2 operações por elemento. A banda efetiva usa o tráfego mínimo do CSR:
+   valores e índices (8 bytes por elemento), um float de x por elemento (sem reuso de cache),
+   ptr e y (8 bytes por linha); serve de referência comum para todos os backends. */
+static void _spmv_record(FILE* file, const char* backend, int n, int m, int k, double ns){
+    double bytes = 12.0 * k + 8.0 * n + 4.0;
+    fprintf(file, "%s, %d, %d, %d, %.0f, %.3f, %.3f\n", backend, n, m, k, ns, 2.0 * k / ns, bytes / ns);
+}
+
+/* Mede y = A * x (e y = A^T * x) nos backends esparsos, repetindo o produto para diluir o relógio. */
+static void _spmv_experiment(FILE* file, int n, int m, int k, int* I, int* J, float* Data){
+    struct timespec t0, t1;
+    printf("SpMV (n=%d, m=%d, k=%d)\n", n, m, k);
+    int repetitions = 1 + 20000000 / (k + n);
+    float* x = (float*) malloc(sizeof(float) * m);
+    float* xt = (float*) malloc(sizeof(float) * n);
+    float* y = (float*) malloc(sizeof(float) * n);
+    float* yt = (float*) malloc(sizeof(float) * m);
+    if(!x || !xt || !y || !yt){
+        _allocation_fail();
+    }
+    for(int j = 0; j < m; j++){
+        x[j] = ((float) rand()) / ((float) RAND_MAX);
+    }
+    for(int i = 0; i < n; i++){
+        xt[i] = ((float) rand()) / ((float) RAND_MAX);
+    }
+
+    AVLMatrix* avl = create_matrix_avl(n, m);
+    HashMatrix* hash = create_hash_matrix(n, m);
+    HashMatrix* rows = create_hash_matrix_with_storage(n, m, HASH_STORAGE_ROWS);
+    if(!avl || !hash || !rows){
+        _allocation_fail();
+    }
+    set_transpose_mode_avl(avl, AVL_TRANSPOSE_LAZY);
+    if(fill_avl_matrix(avl, k, I, J, Data) != AVL_STATUS_OK
+       || fill_hash_matrix(hash, k, I, J, Data) != HASH_STATUS_OK || fill_hash_matrix(rows, k, I, J, Data) != HASH_STATUS_OK){
+        _allocation_fail();
+    }
+    CSRMatrix* csr = create_csr_matrix_from_hash(rows);
+    if(!csr){
+        _allocation_fail();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int r = 0; r < repetitions; r++){
+        spmv_avl(avl, x, y);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    _spmv_record(file, "avl", n, m, k, _delta_t_ns(t0, t1) / repetitions);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int r = 0; r < repetitions; r++){
+        spmv_hash(hash, x, y);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    _spmv_record(file, "hash", n, m, k, _delta_t_ns(t0, t1) / repetitions);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int r = 0; r < repetitions; r++){
+        spmv_hash(rows, x, y);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    _spmv_record(file, "hash_rows", n, m, k, _delta_t_ns(t0, t1) / repetitions);
+
+    const CSRKernel kernels[] = {CSR_KERNEL_SCALAR, CSR_KERNEL_AVX2, CSR_KERNEL_AVX512};
+    const char* kernel_names[] = {"csr_scalar", "csr_avx2", "csr_avx512"};
+    for(int t = 0; t < 3; t++){
+        if(set_spmv_kernel_csr(kernels[t]) != CSR_STATUS_OK){ //Variante não suportada pelo processador.
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(int r = 0; r < repetitions; r++){
+            spmv_csr(csr, x, y);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        _spmv_record(file, kernel_names[t], n, m, k, _delta_t_ns(t0, t1) / repetitions);
+    }
+    set_spmv_kernel_csr(CSR_KERNEL_AUTO);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int r = 0; r < repetitions; r++){
+        spmv_transposed_avl(avl, xt, yt);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    _spmv_record(file, "avl_transposed", n, m, k, _delta_t_ns(t0, t1) / repetitions);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int r = 0; r < repetitions; r++){
+        spmv_transposed_csr(csr, xt, yt);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    _spmv_record(file, "csr_transposed", n, m, k, _delta_t_ns(t0, t1) / repetitions);
+
+    free_matrix_avl(avl);
+    free_hash_matrix(hash);
+    free_hash_matrix(rows);
+    free_csr_matrix(csr);
+    free(x);
+    free(xt);
+    free(y);
+    free(yt);
+}
+
+/* Mede C = A * A com matrix_mul_parallel_avl e matrix_multiplication_parallel_hash em pools de cada tamanho.
+   A saída AVL fica no modo preguiçoso: a transposta de C é construída por uma única thread e esconderia o ganho. */
+static void _parallel_mul_experiment(FILE* file, int n, int k, int* I, int* J, float* Data){
+    struct timespec t0, t1;
+    const int THREADS[] = {1, 2, 4, 8, 16, 32};
+    AVLMatrix* avl = create_matrix_avl_from_triplets(n, n, k, I, J, Data, 2);
+    HashMatrix* hash = create_hash_matrix_from_triplets(n, n, k, I, J, Data, HASH_DUPLICATES_OVERWRITE);
+    if(!avl || !hash){
+        _allocation_fail();
+    }
+    for(int experiment = 0; experiment < 6; experiment++){
+        int threads = THREADS[experiment];
+        printf("Parallel mul (n=%d, k=%d, threads=%d)\n", n, k, threads);
+        AVLMatrix* avl_out = create_matrix_avl(n, n);
+        HashMatrix* hash_out = create_hash_matrix(n, n);
+        ThreadPool* pool = create_thread_pool(threads);
+        if(!avl_out || !hash_out || !pool){
+            _allocation_fail();
+        }
+        set_transpose_mode_avl(avl_out, AVL_TRANSPOSE_LAZY);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        AVLStatus avlstatus = matrix_mul_parallel_avl(avl, avl, avl_out, pool);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double avl_t = _delta_t_ns(t0, t1);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        HashStatus hashstatus = matrix_multiplication_parallel_hash(hash, hash, hash_out, pool);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double hash_t = _delta_t_ns(t0, t1);
+        if(avlstatus != AVL_STATUS_OK || hashstatus != HASH_STATUS_OK){
+            _allocation_fail();
+        }
+        fprintf(file, "%d, %d, %d, %d, %.0f, %.0f\n", n, k, threads, avl_out->k, avl_t, hash_t);
+        free_matrix_avl(avl_out);
+        free_hash_matrix(hash_out);
+        free_thread_pool(pool);
+    }
+    free_matrix_avl(avl);
+    free_hash_matrix(hash);
+}
+
+/* Produto y = A * x por linha, executado como laço do pool na comparação entre distribuições. */
+typedef struct ScheduleExperimentJob{
+    const CSRMatrix* matrix;
+    const float* x;
+    float* y;
+} ScheduleExperimentJob;
+
+static void _row_dot_task(int begin, int end, int worker, void* context){
+    (void) worker;
+    ScheduleExperimentJob* job = context;
+    const CSRMatrix* matrix = job->matrix;
+    for(int i = begin; i < end; i++){
+        float sum = 0.0f;
+        for(int p = matrix->ptr[i]; p < matrix->ptr[i + 1]; p++){
+            sum += matrix->values[p] * job->x[matrix->indices[p]];
+        }
+        job->y[i] = sum;
+    }
+}
+
+/* Compara blocos estáticos com roubo de trabalho em linhas de custo muito desigual: a linha i tem cerca de
+   max_row / (i + 1) elementos (lei de potência, com as linhas pesadas no início, como após ordenar vértices
+   por grau), então o primeiro bloco estático concentra quase todo o trabalho. */
+static void _schedule_experiment(FILE* file, int n, int max_row){
+    struct timespec t0, t1;
+    const int THREADS[] = {1, 2, 4, 8, 16, 32};
+    const int repetitions = 20;
+    long long total = 0;
+    for(int i = 0; i < n; i++){
+        total += (max_row + i) / (i + 1);
+    }
+    int k = (int) total;
+    int* I = (int*) malloc(sizeof(int) * k);
+    int* J = (int*) malloc(sizeof(int) * k);
+    float* Data = (float*) malloc(sizeof(float) * k);
+    float* x = (float*) malloc(sizeof(float) * n);
+    float* y = (float*) malloc(sizeof(float) * n);
+    if(!I || !J || !Data || !x || !y){
+        _allocation_fail();
+    }
+    int position = 0;
+    for(int i = 0; i < n; i++){
+        int length = (max_row + i) / (i + 1);
+        int stride = n / length; //colunas distintas e crescentes, uma por faixa
+        for(int t = 0; t < length; t++){
+            I[position] = i;
+            J[position] = t * stride + rand() % stride;
+            Data[position] = (float) rand() / (float) RAND_MAX + 0.5f;
+            position++;
+        }
+        x[i] = (float) rand() / (float) RAND_MAX;
+    }
+    HashMatrix* rows = create_hash_matrix_from_triplets(n, n, k, I, J, Data, HASH_DUPLICATES_OVERWRITE);
+    CSRMatrix* csr = rows ? create_csr_matrix_from_hash(rows) : NULL;
+    if(!csr){
+        _allocation_fail();
+    }
+    ScheduleExperimentJob job = {csr, x, y};
+
+    for(int experiment = 0; experiment < 6; experiment++){
+        int threads = THREADS[experiment];
+        printf("Schedule (n=%d, k=%d, threads=%d)\n", n, k, threads);
+        ThreadPool* pool = create_thread_pool(threads);
+        if(!pool){
+            _allocation_fail();
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(int r = 0; r < repetitions; r++){
+            parallel_for_thread_pool(pool, 0, n, 1, THREAD_POOL_STATIC, _row_dot_task, &job);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double static_t = _delta_t_ns(t0, t1) / repetitions;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(int r = 0; r < repetitions; r++){
+            parallel_for_thread_pool(pool, 0, n, 64, THREAD_POOL_STEALING, _row_dot_task, &job);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double stealing_t = _delta_t_ns(t0, t1) / repetitions;
+        fprintf(file, "%d, %d, %d, %d, %.0f, %.0f\n", n, max_row, k, threads, static_t, stealing_t);
+        free_thread_pool(pool);
+    }
+
+    free_hash_matrix(rows);
+    free_csr_matrix(csr);
+    free(I);
+    free(J);
+    free(Data);
+    free(x);
+    free(y);
+}
+
+/* Mede o formato em blocos contra o CSR: para cada tamanho de bloco (1 = CSR), a análise de preenchimento
+   e os tempos de y = A * x e de Y = A * X com SPMM_COLUMNS colunas densas. */
+static void _bcsr_experiment(FILE* file, const char* label, CSRMatrix* csr){
+    struct timespec t0, t1;
+    const int BLOCK_SIZES[] = {1, 2, 4, 8};
+    const int SPMM_COLUMNS = 16;
+    const int repetitions = 10;
+    int recommended = 1;
+    recommend_block_size_bcsr(csr, &recommended);
+    float* x = (float*) malloc(sizeof(float) * (size_t) csr->columns * SPMM_COLUMNS);
+    float* y = (float*) malloc(sizeof(float) * (size_t) csr->rows * SPMM_COLUMNS);
+    if(!x || !y){
+        _allocation_fail();
+    }
+    for(size_t t = 0; t < (size_t) csr->columns * SPMM_COLUMNS; t++){
+        x[t] = (float) rand() / (float) RAND_MAX;
+    }
+    for(int experiment = 0; experiment < 4; experiment++){
+        int block_size = BLOCK_SIZES[experiment];
+        printf("BCSR (%s, block=%d)\n", label, block_size);
+        BCSRFillAnalysis analysis;
+        analyze_fill_bcsr(csr, block_size, &analysis);
+        BCSRMatrix* bcsr = block_size > 1 ? create_bcsr_matrix_from_csr(csr, block_size) : NULL;
+        if(block_size > 1 && !bcsr){
+            _allocation_fail();
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(int r = 0; r < repetitions; r++){
+            if(bcsr){
+                spmv_bcsr(bcsr, x, y);
+            }
+            else{
+                spmv_csr(csr, x, y);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double spmv_t = _delta_t_ns(t0, t1) / repetitions;
+
+        //CSR não tem produto por matriz densa: a referência são SPMM_COLUMNS produtos matriz-vetor.
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if(bcsr){
+            spmm_bcsr(bcsr, x, SPMM_COLUMNS, y);
+        }
+        else{
+            for(int c = 0; c < SPMM_COLUMNS; c++){
+                spmv_csr(csr, &x[(size_t) c * csr->columns], &y[(size_t) c * csr->rows]);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double spmm_t = _delta_t_ns(t0, t1);
+
+        fprintf(file, "%s, %d, %d, %d, %d, %.3f, %zu, %.0f, %.0f, %d\n", label, csr->rows, block_size, analysis.blocks,
+                csr->nnz, analysis.fill_ratio, analysis.bytes, spmv_t, spmm_t, recommended);
+        free_bcsr_matrix(bcsr);
+    }
+    free(x);
+    free(y);
+}
+
+/* Mede memória e tempo médio de consulta de uma matriz AVL com o layout de fileira dado. */
+static void _inner_layout_experiment(FILE* file, AVLInnerLayout layout, int n, int m, int k, int* I, int* J, float* Data){
+    struct timespec t0, t1;
+    AVLMatrix* matrix = create_matrix_avl_with_layout(n, m, layout);
+    if(!matrix || fill_avl_matrix(matrix, k, I, J, Data) != AVL_STATUS_OK){
+        _allocation_fail();
+    }
+    volatile float sink = 0.0f;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int count = 0; count < k; count++){
+        float value;
+        get_element_avl(matrix, I[count], J[count], &value);
+        sink += value;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fprintf(file, "%s, %d, %d, %d, %llu, %.1f\n",
+            layout == AVL_INNER_BTREE ? "btree" : "avl", n, m, k, _avl_matrix_size(matrix), _delta_t_ns(t0, t1) / k);
+    free_matrix_avl(matrix);
+}
+
 int main(){
     srand(42);
     const int EXPERIMENT_MATRIX_LENGTH[] = {100, 100, 100, 100, 1000, 1000, 1000, 1000, 10000, 10000, 10000, 100000, 100000, 100000, 1000000, 1000000, 1000000};
@@ -202,7 +837,7 @@ int main(){
         fprintf(stderr, "Error: couldn't open or create size_experiments.csv.\n");
         return 1;
     }
-    fprintf(sizeExperimentsFile, "n,sparsity,k,dense_bytes,avl_bytes,hash_bytes\n");
+    fprintf(sizeExperimentsFile, "n,sparsity,k,dense_bytes,avl_bytes,hash_bytes,hash_open_bytes,hash_pool_saved_bytes,hash_rows_bytes,avl_lazy_bytes,avl_btree_bytes,csr_bytes\n");
 
     for(int experiment = 0; experiment < NUM_EXPERIMENTS; experiment++){ //Experimentos de tamanho na memória
         int matrix_length = EXPERIMENT_MATRIX_LENGTH[experiment];
@@ -242,6 +877,35 @@ int main(){
         }
         unsigned long long int avlmatrix_size = _avl_matrix_size(avlmatrix);
         free_matrix_avl(avlmatrix);
+        avlmatrix = create_matrix_avl(matrix_length, matrix_length);
+        set_transpose_mode_avl(avlmatrix, AVL_TRANSPOSE_LAZY);
+        avlstatus = fill_avl_matrix(avlmatrix, k, I, J, Data);
+        if(avlstatus != AVL_STATUS_OK){
+            fprintf(stderr, "Error filling lazy AVL matrix (status %d: %s).\n",
+                    avlstatus, avl_status_string(avlstatus));
+            free(I);
+            free(J);
+            free(Data);
+            free_matrix_avl(avlmatrix);
+            fclose(sizeExperimentsFile);
+            return 1;
+        }
+        unsigned long long int lazy_avlmatrix_size = _avl_matrix_size(avlmatrix);
+        free_matrix_avl(avlmatrix);
+        avlmatrix = create_matrix_avl_with_layout(matrix_length, matrix_length, AVL_INNER_BTREE);
+        avlstatus = fill_avl_matrix(avlmatrix, k, I, J, Data);
+        if(avlstatus != AVL_STATUS_OK){
+            fprintf(stderr, "Error filling B+ tree AVL matrix (status %d: %s).\n",
+                    avlstatus, avl_status_string(avlstatus));
+            free(I);
+            free(J);
+            free(Data);
+            free_matrix_avl(avlmatrix);
+            fclose(sizeExperimentsFile);
+            return 1;
+        }
+        unsigned long long int btree_avlmatrix_size = _avl_matrix_size(avlmatrix);
+        free_matrix_avl(avlmatrix);
         HashMatrix* hashmatrix;
         hashmatrix = create_hash_matrix(matrix_length, matrix_length);
         HashStatus hashstatus = fill_hash_matrix(hashmatrix, k, I, J, Data);
@@ -255,11 +919,42 @@ int main(){
             return 1;
         }
         unsigned long long int hashmatrix_size = _hash_matrix_size(hashmatrix);
+        long long int hash_pool_saved = _hash_pool_saved_size(hashmatrix);
+        free_hash_matrix(hashmatrix);
+        hashmatrix = create_hash_matrix_with_storage(matrix_length, matrix_length, HASH_STORAGE_OPEN);
+        hashstatus = fill_hash_matrix(hashmatrix, k, I, J, Data);
+        if(hashstatus != HASH_STATUS_OK){
+            fprintf(stderr, "Error filling open hash matrix (status %d).\n", hashstatus);
+            free(I);
+            free(J);
+            free(Data);
+            free_hash_matrix(hashmatrix);
+            fclose(sizeExperimentsFile);
+            return 1;
+        }
+        unsigned long long int open_hashmatrix_size = _hash_matrix_size(hashmatrix);
+        free_hash_matrix(hashmatrix);
+        hashmatrix = create_hash_matrix_with_storage(matrix_length, matrix_length, HASH_STORAGE_ROWS);
+        hashstatus = fill_hash_matrix(hashmatrix, k, I, J, Data);
+        if(hashstatus != HASH_STATUS_OK){
+            fprintf(stderr, "Error filling two-level hash matrix (status %d).\n", hashstatus);
+            free(I);
+            free(J);
+            free(Data);
+            free_hash_matrix(hashmatrix);
+            fclose(sizeExperimentsFile);
+            return 1;
+        }
+        unsigned long long int rows_hashmatrix_size = _hash_matrix_size(hashmatrix);
+        CSRMatrix* csrmatrix = create_csr_matrix_from_hash(hashmatrix);
+        unsigned long long int csrmatrix_size = _csr_matrix_size(csrmatrix);
+        free_csr_matrix(csrmatrix);
         free_hash_matrix(hashmatrix);
 
-        fprintf(sizeExperimentsFile, "%d, %.12f, %d, %llu, %llu, %llu\n",
+        fprintf(sizeExperimentsFile, "%d, %.12f, %d, %llu, %llu, %llu, %llu, %lld, %llu, %llu, %llu, %llu\n",
                 matrix_length, sparsity, k,
-                dense_matrix_size, avlmatrix_size, hashmatrix_size);
+                dense_matrix_size, avlmatrix_size, hashmatrix_size, open_hashmatrix_size, hash_pool_saved, rows_hashmatrix_size,
+                lazy_avlmatrix_size, btree_avlmatrix_size, csrmatrix_size);
 
         free(I);
         free(J);
@@ -273,7 +968,7 @@ int main(){
         fprintf(stderr, "Error: couldn't open or create time_experiments.csv.\n");
         return 1;
     }
-    fprintf(timeExperimentsFile, "n,sparsity,k,dense_get_ns,dense_set_ns,dense_trans_ns,dense_scalar_ns,dense_sum_ns,dense_mul_ns,avl_get_ns,avl_set_ns,avl_trans_ns,avl_scalar_ns,avl_sum_ns,avl_mul_ns,hash_get_ns,hash_set_ns,hash_trans_ns,hash_scalar_ns,hash_sum_ns,hash_mul_ns\n");
+    fprintf(timeExperimentsFile, "n,sparsity,k,dense_get_ns,dense_set_ns,dense_trans_ns,dense_scalar_ns,dense_sum_ns,dense_mul_ns,avl_get_ns,avl_set_ns,avl_trans_ns,avl_scalar_ns,avl_sum_ns,avl_mul_ns,hash_get_ns,hash_set_ns,hash_trans_ns,hash_scalar_ns,hash_sum_ns,hash_mul_ns,hash_open_get_ns,hash_open_set_ns,hash_open_trans_ns,hash_open_scalar_ns,hash_open_sum_ns,hash_open_mul_ns,csr_get_ns,csr_set_ns,csr_trans_ns,csr_scalar_ns,csr_sum_ns,csr_mul_ns\n");
     
     for(int experiment = 0; experiment < NUM_DENSE_EXPERIMENTS; experiment++){ //Experimentos de tempo até o limite do denso
         int matrix_length = EXPERIMENT_MATRIX_LENGTH[experiment];
@@ -358,8 +1053,8 @@ int main(){
         free(dense_sum_out);
         free(dense_mul_out);
         /* AVL */
-        AVLMatrix* A = create_matrix_avl(matrix_length, matrix_length);
-        AVLMatrix* B = create_matrix_avl(matrix_length, matrix_length);
+        AVLMatrix* A = create_matrix_avl_from_triplets(matrix_length, matrix_length, k, I, J, Data, 2);
+        AVLMatrix* B = create_matrix_avl_from_triplets(matrix_length, matrix_length, k, I, J, Data, 2);
         AVLMatrix* scalar_out = create_matrix_avl(matrix_length, matrix_length);
         AVLMatrix* sum_out = create_matrix_avl(matrix_length, matrix_length);
         AVLMatrix* mul_out = create_matrix_avl(matrix_length, matrix_length);
@@ -375,36 +1070,7 @@ int main(){
             fclose(timeExperimentsFile);
             return 1;
         }
-        AVLStatus avlstatus = fill_avl_matrix(A, k, I, J, Data);
-        if(avlstatus != AVL_STATUS_OK){
-            fprintf(stderr, "Error filling AVL matrix (status %d: %s).\n",
-                    avlstatus, avl_status_string(avlstatus));
-            free(I);
-            free(J);
-            free(Data);
-            free_matrix_avl(A);
-            free_matrix_avl(B);
-            free_matrix_avl(scalar_out);
-            free_matrix_avl(sum_out);
-            free_matrix_avl(mul_out);
-            fclose(timeExperimentsFile);
-            return 1;
-        }
-        avlstatus = fill_avl_matrix(B, k, I, J, Data);
-        if(avlstatus != AVL_STATUS_OK){
-            fprintf(stderr, "Error filling AVL matrix B (status %d: %s).\n",
-                    avlstatus, avl_status_string(avlstatus));
-            free(I);
-            free(J);
-            free(Data);
-            free_matrix_avl(A);
-            free_matrix_avl(B);
-            free_matrix_avl(scalar_out);
-            free_matrix_avl(sum_out);
-            free_matrix_avl(mul_out);
-            fclose(timeExperimentsFile);
-            return 1;
-        }
+        AVLStatus avlstatus;
         int pos = rand() % k;
         int i = I[pos];
         int j = J[pos];
@@ -543,93 +1209,28 @@ int main(){
         double avl_mul = _delta_t_ns(t0, t1);
 
         /* HASH */
-        printf("Hash setup (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        HashMatrix* H1 = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H2 = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H_scalar = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H_sum = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H_mul = create_hash_matrix(matrix_length, matrix_length);
-        if(!H1 || !H2 || !H_scalar || !H_sum || !H_mul){
-            _allocation_fail();
-        }
-        HashStatus hstatus = fill_hash_matrix(H1, k, I, J, Data);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        hstatus = fill_hash_matrix(H2, k, I, J, Data);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        int pos_h = rand() % k;
-        int ih = I[pos_h];
-        int jh = J[pos_h];
-        printf("Hash get (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        float hval = get_element_hash(H1, ih, jh);
-        (void)hval;
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        double hash_get_t = _delta_t_ns(t0, t1);
-        printf("Hash set (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = set_element_hash(H1, ih, jh, 3.14f);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_set_t = _delta_t_ns(t0, t1);
-        printf("Hash transpose (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = transpose_hash(H1);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_trans_t = _delta_t_ns(t0, t1);
-        hstatus = transpose_hash(H1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        printf("Hash scalar mul (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = matrix_scalar_multiplication_hash(H1, H_scalar, 3.0f);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_scalar = _delta_t_ns(t0, t1);
-        printf("Hash sum (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = matrix_addition_hash(H1, H2, H_sum);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_sum_t = _delta_t_ns(t0, t1);
-        printf("Hash mul (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = matrix_multiplication_hash(H1, H2, H_mul);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_mul_t = _delta_t_ns(t0, t1);
+        double hash_times[6];
+        double open_times[6];
+        _hash_time_experiment(HASH_STORAGE_CHAINED, "Hash", matrix_length, sparsity, k, I, J, Data, hash_times);
+        _hash_time_experiment(HASH_STORAGE_OPEN, "Open hash", matrix_length, sparsity, k, I, J, Data, open_times);
+
+        /* CSR */
+        double csr_times[6];
+        _csr_time_experiment(matrix_length, sparsity, k, I, J, Data, csr_times);
 
-        fprintf(timeExperimentsFile, "%d, %.12f, %d, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f\n",
+        fprintf(timeExperimentsFile, "%d, %.12f, %d, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f\n",
                 matrix_length, sparsity, k,
                 dense_get_t, dense_set_t, dense_trans_t, dense_scalar, dense_sum_t, dense_mul_t,
                 avl_get, avl_set, avl_trans, avl_scalar, avl_sum_t, avl_mul,
-                hash_get_t, hash_set_t, hash_trans_t, hash_scalar, hash_sum_t, hash_mul_t);
+                hash_times[0], hash_times[1], hash_times[2], hash_times[3], hash_times[4], hash_times[5],
+                open_times[0], open_times[1], open_times[2], open_times[3], open_times[4], open_times[5],
+                csr_times[0], csr_times[1], csr_times[2], csr_times[3], csr_times[4], csr_times[5]);
 
         free_matrix_avl(A);
         free_matrix_avl(B);
         free_matrix_avl(scalar_out);
         free_matrix_avl(sum_out);
         free_matrix_avl(mul_out);
-        free_hash_matrix(H1);
-        free_hash_matrix(H2);
-        free_hash_matrix(H_scalar);
-        free_hash_matrix(H_sum);
-        free_hash_matrix(H_mul);
         free(I);
         free(J);
         free(Data);
@@ -666,8 +1267,8 @@ int main(){
         double dense_sum_t = -1.0;
         double dense_mul_t = -1.0;
         /* AVL */
-        AVLMatrix* A = create_matrix_avl(matrix_length, matrix_length);
-        AVLMatrix* B = create_matrix_avl(matrix_length, matrix_length);
+        AVLMatrix* A = create_matrix_avl_from_triplets(matrix_length, matrix_length, k, I, J, Data, 2);
+        AVLMatrix* B = create_matrix_avl_from_triplets(matrix_length, matrix_length, k, I, J, Data, 2);
         AVLMatrix* scalar_out = create_matrix_avl(matrix_length, matrix_length);
         AVLMatrix* sum_out = create_matrix_avl(matrix_length, matrix_length);
         AVLMatrix* mul_out = create_matrix_avl(matrix_length, matrix_length);
@@ -683,36 +1284,7 @@ int main(){
             fclose(timeExperimentsFile);
             return 1;
         }
-        AVLStatus avlstatus = fill_avl_matrix(A, k, I, J, Data);
-        if(avlstatus != AVL_STATUS_OK){
-            fprintf(stderr, "Error filling AVL matrix (status %d: %s).\n",
-                    avlstatus, avl_status_string(avlstatus));
-            free(I);
-            free(J);
-            free(Data);
-            free_matrix_avl(A);
-            free_matrix_avl(B);
-            free_matrix_avl(scalar_out);
-            free_matrix_avl(sum_out);
-            free_matrix_avl(mul_out);
-            fclose(timeExperimentsFile);
-            return 1;
-        }
-        avlstatus = fill_avl_matrix(B, k, I, J, Data);
-        if(avlstatus != AVL_STATUS_OK){
-            fprintf(stderr, "Error filling AVL matrix B (status %d: %s).\n",
-                    avlstatus, avl_status_string(avlstatus));
-            free(I);
-            free(J);
-            free(Data);
-            free_matrix_avl(A);
-            free_matrix_avl(B);
-            free_matrix_avl(scalar_out);
-            free_matrix_avl(sum_out);
-            free_matrix_avl(mul_out);
-            fclose(timeExperimentsFile);
-            return 1;
-        }
+        AVLStatus avlstatus;
         int pos = rand() % k;
         int i = I[pos];
         int j = J[pos];
@@ -851,97 +1423,230 @@ int main(){
         double avl_mul = _delta_t_ns(t0, t1);
 
         /* HASH */
-        printf("Hash setup (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        HashMatrix* H1 = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H2 = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H_scalar = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H_sum = create_hash_matrix(matrix_length, matrix_length);
-        HashMatrix* H_mul = create_hash_matrix(matrix_length, matrix_length);
-        if(!H1 || !H2 || !H_scalar || !H_sum || !H_mul){
-            _allocation_fail();
-        }
-        HashStatus hstatus = fill_hash_matrix(H1, k, I, J, Data);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        hstatus = fill_hash_matrix(H2, k, I, J, Data);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        int pos_h = rand() % k;
-        int ih = I[pos_h];
-        int jh = J[pos_h];
-        printf("Hash get (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        float hval = get_element_hash(H1, ih, jh);
-        (void)hval;
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        double hash_get_t = _delta_t_ns(t0, t1);
-        printf("Hash set (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = set_element_hash(H1, ih, jh, 3.14f);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_set_t = _delta_t_ns(t0, t1);
-        printf("Hash transpose (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = transpose_hash(H1);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_trans_t = _delta_t_ns(t0, t1);
-        hstatus = transpose_hash(H1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        printf("Hash scalar mul (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = matrix_scalar_multiplication_hash(H1, H_scalar, 3.0f);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_scalar = _delta_t_ns(t0, t1);
-        printf("Hash sum (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = matrix_addition_hash(H1, H2, H_sum);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_sum_t = _delta_t_ns(t0, t1);
-        printf("Hash mul (n=%d, sparsity=%.12f)\n", matrix_length, sparsity);
-        clock_gettime(CLOCK_MONOTONIC, &t0);
-        hstatus = matrix_multiplication_hash(H1, H2, H_mul);
-        clock_gettime(CLOCK_MONOTONIC, &t1);
-        if(hstatus != HASH_STATUS_OK){
-            _allocation_fail();
-        }
-        double hash_mul_t = _delta_t_ns(t0, t1);
+        double hash_times[6];
+        double open_times[6];
+        _hash_time_experiment(HASH_STORAGE_CHAINED, "Hash", matrix_length, sparsity, k, I, J, Data, hash_times);
+        _hash_time_experiment(HASH_STORAGE_OPEN, "Open hash", matrix_length, sparsity, k, I, J, Data, open_times);
+
+        /* CSR */
+        double csr_times[6];
+        _csr_time_experiment(matrix_length, sparsity, k, I, J, Data, csr_times);
 
-        fprintf(timeExperimentsFile, "%d, %.12f, %d, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f\n",
+        fprintf(timeExperimentsFile, "%d, %.12f, %d, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f, %.0f\n",
                 matrix_length, sparsity, k,
                 dense_get_t, dense_set_t, dense_trans_t, dense_scalar, dense_sum_t, dense_mul_t,
                 avl_get, avl_set, avl_trans, avl_scalar, avl_sum_t, avl_mul,
-                hash_get_t, hash_set_t, hash_trans_t, hash_scalar, hash_sum_t, hash_mul_t);
+                hash_times[0], hash_times[1], hash_times[2], hash_times[3], hash_times[4], hash_times[5],
+                open_times[0], open_times[1], open_times[2], open_times[3], open_times[4], open_times[5],
+                csr_times[0], csr_times[1], csr_times[2], csr_times[3], csr_times[4], csr_times[5]);
 
         free_matrix_avl(A);
         free_matrix_avl(B);
         free_matrix_avl(scalar_out);
         free_matrix_avl(sum_out);
         free_matrix_avl(mul_out);
-        free_hash_matrix(H1);
-        free_hash_matrix(H2);
-        free_hash_matrix(H_scalar);
-        free_hash_matrix(H_sum);
-        free_hash_matrix(H_mul);
         free(I);
         free(J);
         free(Data);
     }
     fclose(timeExperimentsFile);
+
+    FILE* probeExperimentsFile = fopen("probe_experiments.csv", "w");
+    if(!probeExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create probe_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(probeExperimentsFile, "pattern,storage,n,k,capacity,mean_probe,max_probe\n");
+    const int PROBE_N = 100000;
+    const int PROBE_HALF_BAND = 2;
+    int probe_capacity = PROBE_N * (2 * PROBE_HALF_BAND + 1);
+    int* I = (int*) malloc(sizeof(int) * probe_capacity);
+    int* J = (int*) malloc(sizeof(int) * probe_capacity);
+    float* Data = (float*) malloc(sizeof(float) * probe_capacity);
+    if(!I || !J || !Data){
+        _allocation_fail();
+    }
+    for(int storage = HASH_STORAGE_CHAINED; storage <= HASH_STORAGE_OPEN; storage++){
+        int k = _band_data(PROBE_N, 0, I, J, Data);
+        _probe_experiment(probeExperimentsFile, "diagonal", (HashStorage) storage, PROBE_N, k, I, J, Data);
+        k = _band_data(PROBE_N, PROBE_HALF_BAND, I, J, Data);
+        _probe_experiment(probeExperimentsFile, "band", (HashStorage) storage, PROBE_N, k, I, J, Data);
+        generate_data(PROBE_N, PROBE_N, k, I, J, Data);
+        _probe_experiment(probeExperimentsFile, "random", (HashStorage) storage, PROBE_N, k, I, J, Data);
+    }
+    fclose(probeExperimentsFile);
+
+    FILE* latencyExperimentsFile = fopen("latency_experiments.csv", "w");
+    if(!latencyExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create latency_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(latencyExperimentsFile, "resize_mode,n,k,mean_set_ns,worst_set_ns\n");
+    int latency_k = probe_capacity;
+    generate_data(PROBE_N, PROBE_N, latency_k, I, J, Data);
+    _latency_experiment(latencyExperimentsFile, HASH_RESIZE_IMMEDIATE, PROBE_N, latency_k, I, J, Data);
+    _latency_experiment(latencyExperimentsFile, HASH_RESIZE_INCREMENTAL, PROBE_N, latency_k, I, J, Data);
+    fclose(latencyExperimentsFile);
+
+    FILE* loadExperimentsFile = fopen("load_experiments.csv", "w");
+    if(!loadExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create load_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(loadExperimentsFile, "n,k,hash_set_fill_ns,hash_triplets_ns\n");
+    const int LOAD_K[] = {100000, 1000000, 10000000};
+    for(int experiment = 0; experiment < 3; experiment++){
+        _load_experiment(loadExperimentsFile, 1000000, LOAD_K[experiment]);
+    }
+    fclose(loadExperimentsFile);
+
+    FILE* shardedExperimentsFile = fopen("sharded_experiments.csv", "w");
+    if(!shardedExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create sharded_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(shardedExperimentsFile, "threads,shards,k,global_lock_ns,sharded_ns\n");
+    const int SHARDED_SHARDS = 64;
+    const int SHARDED_THREADS[] = {1, 2, 4, 8};
+    generate_data(PROBE_N, PROBE_N, probe_capacity, I, J, Data);
+    for(int experiment = 0; experiment < 4; experiment++){
+        _sharded_experiment(shardedExperimentsFile, SHARDED_THREADS[experiment], SHARDED_SHARDS, PROBE_N, probe_capacity, I, J, Data);
+    }
+    fclose(shardedExperimentsFile);
+
+    FILE* layoutExperimentsFile = fopen("layout_experiments.csv", "w");
+    if(!layoutExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create layout_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(layoutExperimentsFile, "layout,n,m,k,bytes,mean_get_ns\n");
+    const int LAYOUT_N[] = {PROBE_N, PROBE_N / 100};
+    for(int experiment = 0; experiment < 2; experiment++){ //Com menos linhas, cada fileira é mais longa.
+        generate_data(LAYOUT_N[experiment], PROBE_N, probe_capacity, I, J, Data);
+        _inner_layout_experiment(layoutExperimentsFile, AVL_INNER_AVL, LAYOUT_N[experiment], PROBE_N, probe_capacity, I, J, Data);
+        _inner_layout_experiment(layoutExperimentsFile, AVL_INNER_BTREE, LAYOUT_N[experiment], PROBE_N, probe_capacity, I, J, Data);
+    }
+    fclose(layoutExperimentsFile);
+
+    FILE* spmvExperimentsFile = fopen("spmv_experiments.csv", "w");
+    if(!spmvExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create spmv_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(spmvExperimentsFile, "backend,n,m,k,ns,gflops,effective_gbytes_per_s\n");
+    for(int experiment = 0; experiment < 2; experiment++){ //Linhas curtas (5 por linha) e longas (500 por linha).
+        generate_data(LAYOUT_N[experiment], PROBE_N, probe_capacity, I, J, Data);
+        _spmv_experiment(spmvExperimentsFile, LAYOUT_N[experiment], PROBE_N, probe_capacity, I, J, Data);
+    }
+    fclose(spmvExperimentsFile);
+
+    FILE* parallelMulExperimentsFile = fopen("parallel_mul_experiments.csv", "w");
+    if(!parallelMulExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create parallel_mul_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(parallelMulExperimentsFile, "n,k,threads,nnz_c,avl_mul_ns,hash_mul_ns\n");
+    const int PARALLEL_MUL_N[] = {100000, 1000000};
+    const int PARALLEL_MUL_PER_ROW = 4;
+    for(int experiment = 0; experiment < 2; experiment++){
+        int n = PARALLEL_MUL_N[experiment];
+        int k = n * PARALLEL_MUL_PER_ROW;
+        int* mul_I = (int*) malloc(sizeof(int) * k);
+        int* mul_J = (int*) malloc(sizeof(int) * k);
+        float* mul_Data = (float*) malloc(sizeof(float) * k);
+        if(!mul_I || !mul_J || !mul_Data){
+            _allocation_fail();
+        }
+        generate_data(n, n, k, mul_I, mul_J, mul_Data);
+        _parallel_mul_experiment(parallelMulExperimentsFile, n, k, mul_I, mul_J, mul_Data);
+        free(mul_I);
+        free(mul_J);
+        free(mul_Data);
+    }
+    fclose(parallelMulExperimentsFile);
+
+    FILE* scheduleExperimentsFile = fopen("schedule_experiments.csv", "w");
+    if(!scheduleExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create schedule_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(scheduleExperimentsFile, "n,max_row,k,threads,static_ns,stealing_ns\n");
+    const int SCHEDULE_N[] = {100000, 1000000};
+    for(int experiment = 0; experiment < 2; experiment++){
+        _schedule_experiment(scheduleExperimentsFile, SCHEDULE_N[experiment], 100000);
+    }
+    fclose(scheduleExperimentsFile);
+
+    FILE* bcsrExperimentsFile = fopen("bcsr_experiments.csv", "w");
+    if(!bcsrExperimentsFile){
+        fprintf(stderr, "Error: couldn't open or create bcsr_experiments.csv.\n");
+        return 1;
+    }
+    fprintf(bcsrExperimentsFile, "matrix,n,block_size,blocks,nnz,fill_ratio,bytes,spmv_ns,spmm16_ns,recommended\n");
+    {
+        //Malha 2D de GRID x GRID nós com 4 graus de liberdade por nó e estêncil de 5 pontos: blocos 4x4 densos.
+        const int GRID = 200;
+        const int DOFS = 4;
+        int n = GRID * GRID * DOFS;
+        int k = GRID * GRID * 5 * DOFS * DOFS;
+        int* grid_I = (int*) malloc(sizeof(int) * k);
+        int* grid_J = (int*) malloc(sizeof(int) * k);
+        float* grid_Data = (float*) malloc(sizeof(float) * k);
+        if(!grid_I || !grid_J || !grid_Data){
+            _allocation_fail();
+        }
+        const int NEIGHBOR_X[] = {0, -1, 1, 0, 0};
+        const int NEIGHBOR_Y[] = {0, 0, 0, -1, 1};
+        int count = 0;
+        for(int gx = 0; gx < GRID; gx++){
+            for(int gy = 0; gy < GRID; gy++){
+                for(int neighbor = 0; neighbor < 5; neighbor++){
+                    int nx = gx + NEIGHBOR_X[neighbor];
+                    int ny = gy + NEIGHBOR_Y[neighbor];
+                    if(nx < 0 || nx >= GRID || ny < 0 || ny >= GRID){
+                        continue;
+                    }
+                    for(int a = 0; a < DOFS; a++){
+                        for(int b = 0; b < DOFS; b++){
+                            grid_I[count] = (gx * GRID + gy) * DOFS + a;
+                            grid_J[count] = (nx * GRID + ny) * DOFS + b;
+                            grid_Data[count] = (float) rand() / (float) RAND_MAX + 0.5f;
+                            count++;
+                        }
+                    }
+                }
+            }
+        }
+        HashMatrix* grid = create_hash_matrix_from_triplets(n, n, count, grid_I, grid_J, grid_Data, HASH_DUPLICATES_OVERWRITE);
+        CSRMatrix* grid_csr = grid ? create_csr_matrix_from_hash(grid) : NULL;
+        if(!grid_csr){
+            _allocation_fail();
+        }
+        _bcsr_experiment(bcsrExperimentsFile, "grid", grid_csr);
+        free_csr_matrix(grid_csr);
+        free_hash_matrix(grid);
+
+        //Mesmo tamanho e número de elementos, posições aleatórias.
+        for(int t = 0; t < count; t++){
+            grid_I[t] = rand() % n;
+            grid_J[t] = rand() % n;
+        }
+        HashMatrix* random = create_hash_matrix_from_triplets(n, n, count, grid_I, grid_J, grid_Data, HASH_DUPLICATES_OVERWRITE);
+        CSRMatrix* random_csr = random ? create_csr_matrix_from_hash(random) : NULL;
+        if(!random_csr){
+            _allocation_fail();
+        }
+        _bcsr_experiment(bcsrExperimentsFile, "random", random_csr);
+        free_csr_matrix(random_csr);
+        free_hash_matrix(random);
+        free(grid_I);
+        free(grid_J);
+        free(grid_Data);
+    }
+    fclose(bcsrExperimentsFile);
+
+    free(I);
+    free(J);
+    free(Data);
     return 0;
 }
@@ -1,11 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <math.h>
+#include <string.h>
 #include "hash_matrix.h"
+#include "csr_matrix.h"
 
 #define INITIAL_CAPACITY 16
 #define LOAD_FACTOR_UPPER 0.75
 #define LOAD_FACTOR_LOWER 0.25
+#define EMPTY_KEY 0xFFFFFFFFFFFFFFFFULL
+#define SLAB_INITIAL_NODES 64
+#define SLAB_MAX_NODES 4096
+#define MIGRATE_STEP_BUCKETS 4 //passo mínimo da migração incremental por operação
+#define BULK_PARTITIONS 256
+#define ROW_INITIAL_COLUMNS 4
 
 /**
  * @brief Encerramento imediato em caso de falha de alocação.
@@ -17,17 +26,757 @@ static void _allocation_fail(){
     exit(EXIT_FAILURE);
 }
 
+/**
+ * @brief Obtém um nó do pool da matriz.
+ *
+ * Reaproveita primeiro a lista livre; depois consome o slab atual; por último aloca
+ * um novo slab com o dobro de nós do anterior (limitado a SLAB_MAX_NODES).
+ *
+ * @param pool pool de nós da matriz.
+ * @return Ponteiro para um nó não inicializado.
+ */
+static Node* _pool_alloc(NodePool* pool){
+    if (pool->free_list != NULL){
+        Node* node = pool->free_list;
+        pool->free_list = node->next;
+        return node;
+    }
+
+    if (pool->slabs == NULL || pool->used == pool->slabs->capacity){
+        int capacity = SLAB_INITIAL_NODES;
+        if (pool->slabs != NULL){
+            capacity = pool->slabs->capacity * 2;
+            if (capacity > SLAB_MAX_NODES){
+                capacity = SLAB_MAX_NODES;
+            }
+        }
+        size_t size = sizeof(NodeSlab) + (size_t) capacity * sizeof(Node);
+        NodeSlab* slab = malloc(size);
+        if (slab == NULL){
+            _allocation_fail();
+        }
+        slab->next = pool->slabs;
+        slab->capacity = capacity;
+        pool->slabs = slab;
+        pool->used = 0;
+        pool->bytes += size;
+    }
+
+    return &pool->slabs->nodes[pool->used++];
+}
+
+/**
+ * @brief Garante que o slab atual tenha espaço para pelo menos nodes nós.
+ *
+ * Usado pela construção em bloco para que todos os nós venham de um único slab.
+ *
+ * @param pool pool de nós da matriz.
+ * @param nodes número de nós que serão alocados em seguida.
+ */
+static void _pool_reserve(NodePool* pool, int nodes){
+    if (nodes <= 0){
+        return;
+    }
+    if (pool->slabs != NULL && pool->slabs->capacity - pool->used >= nodes){
+        return;
+    }
+    size_t size = sizeof(NodeSlab) + (size_t) nodes * sizeof(Node);
+    NodeSlab* slab = malloc(size);
+    if (slab == NULL){
+        _allocation_fail();
+    }
+    slab->next = pool->slabs;
+    slab->capacity = nodes;
+    pool->slabs = slab;
+    pool->used = 0;
+    pool->bytes += size;
+}
+
+/**
+ * @brief Devolve um nó ao pool para reuso.
+ *
+ * @param pool pool de nós da matriz.
+ * @param node nó que deixou de ser usado.
+ */
+static void _pool_release(NodePool* pool, Node* node){
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+/**
+ * @brief Libera todos os slabs do pool de uma vez.
+ *
+ * @param pool pool de nós da matriz.
+ */
+static void _pool_destroy(NodePool* pool){
+    NodeSlab* slab = pool->slabs;
+    while (slab != NULL){
+        NodeSlab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->used = 0;
+    pool->bytes = 0;
+}
+
+/**
+ * @brief Empacota linha e coluna em uma única chave de 64 bits.
+ *
+ * Como os índices são não negativos, a chave nunca coincide com EMPTY_KEY.
+ *
+ * @param row índice de linha.
+ * @param column índice de coluna.
+ * @return chave (row << 32) | column.
+ */
+static unsigned long long _pack_key(int row, int column){
+    return ((unsigned long long)(unsigned int) row << 32) | (unsigned long long)(unsigned int) column;
+}
+
+/**
+ * @brief Extrai a linha de uma chave empacotada.
+ *
+ * @param key chave gerada por _pack_key.
+ */
+static int _key_row(unsigned long long key){
+    return (int)(key >> 32);
+}
+
+/**
+ * @brief Extrai a coluna de uma chave empacotada.
+ *
+ * @param key chave gerada por _pack_key.
+ */
+static int _key_column(unsigned long long key){
+    return (int)(key & 0xFFFFFFFFULL);
+}
+
+/**
+ * @brief Mistura os 64 bits de uma chave (finalizador do MurmurHash3).
+ *
+ * Cada bit de entrada afeta todos os bits de saída, de modo que padrões estruturados
+ * (diagonais, bandas, linhas ou colunas inteiras) se espalham uniformemente.
+ *
+ * @param key chave empacotada.
+ * @return chave misturada.
+ */
+static unsigned long long _mix64(unsigned long long key){
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+unsigned long long hash_mix(int row, int column){
+    return _mix64(_pack_key(row, column));
+}
+
 /**
  * @brief retorna um hash dados inteiros de linha, coluna, e capacidade.
  *
+ * A capacidade é sempre uma potência de dois, então o índice é obtido com uma
+ * máscara sobre os bits baixos da chave misturada, sem divisão.
+ *
  * @param row índice de linha.
  * @param column índice de coluna.
- * @param capacity capacidade total da tabela de espalhamento.
+ * @param capacity capacidade total da tabela de espalhamento (potência de dois).
  * @return o hash calculado.
  */
 unsigned int hash(int row, int column, int capacity){
-    unsigned long h = ((unsigned long) row * 31337 + (unsigned long) column * 2731)%capacity;
-    return (unsigned int) h;
+    return (unsigned int) (hash_mix(row, column) & (unsigned long long) (capacity - 1));
+}
+
+/**
+ * @brief Procura a posição de uma chave na tabela de endereçamento aberto.
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_OPEN.
+ * @param row índice de linha (já no sistema de coordenadas armazenado).
+ * @param column índice de coluna (já no sistema de coordenadas armazenado).
+ * @param empty_slot saída opcional (pode ser NULL): posição vazia que encerrou a sondagem,
+ *        onde a chave pode ser inserida sem nova sondagem se ela não existir.
+ * @return índice da posição ocupada pela chave, ou -1 se ela não existir.
+ */
+static int _open_find_slot(HashMatrix* matrix, int row, int column, int* empty_slot){
+    unsigned long long key = _pack_key(row, column);
+    unsigned int index = hash(row, column, matrix->capacity);
+
+    while (matrix->keys[index] != EMPTY_KEY){
+        if (matrix->keys[index] == key){
+            return (int) index;
+        }
+        index = (index + 1) & (matrix->capacity - 1);
+    }
+    if (empty_slot != NULL){
+        *empty_slot = (int) index;
+    }
+    return -1;
+}
+
+/**
+ * @brief Insere uma chave sabidamente ausente na primeira posição livre da sondagem.
+ *
+ * Não altera count nem verifica o load factor.
+ *
+ * @param keys vetor de chaves da tabela.
+ * @param values vetor de valores da tabela.
+ * @param capacity capacidade da tabela.
+ * @param key chave empacotada.
+ * @param data valor a armazenar.
+ */
+static void _open_place(unsigned long long* keys, float* values, int capacity, unsigned long long key, float data){
+    unsigned int index = hash(_key_row(key), _key_column(key), capacity);
+    while (keys[index] != EMPTY_KEY){
+        index = (index + 1) & (capacity - 1);
+    }
+    keys[index] = key;
+    values[index] = data;
+}
+
+/**
+ * @brief Remove a chave de uma posição deslocando para trás o restante do agrupamento.
+ *
+ * A remoção por deslocamento (backward shift) dispensa marcadores de remoção e
+ * mantém as sequências de sondagem curtas. Não altera count.
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_OPEN.
+ * @param slot posição ocupada a ser esvaziada.
+ */
+static void _open_remove_slot(HashMatrix* matrix, int slot){
+    int capacity = matrix->capacity;
+    int hole = slot;
+    int next = slot;
+
+    while (1){
+        next = (next + 1) & (capacity - 1);
+        unsigned long long key = matrix->keys[next];
+        if (key == EMPTY_KEY){
+            break;
+        }
+        int home = (int) hash(_key_row(key), _key_column(key), capacity);
+        //Se a posição ideal está ciclicamente em (hole, next], a chave pode continuar onde está.
+        bool stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (stays){
+            continue;
+        }
+        matrix->keys[hole] = key;
+        matrix->values[hole] = matrix->values[next];
+        hole = next;
+    }
+    matrix->keys[hole] = EMPTY_KEY;
+}
+
+/**
+ * @brief Aloca os vetores de uma tabela de endereçamento aberto vazia.
+ *
+ * @param capacity número de posições.
+ * @param keys saída: vetor de chaves, todas EMPTY_KEY.
+ * @param values saída: vetor de valores.
+ */
+static void _open_alloc(int capacity, unsigned long long** keys, float** values){
+    *keys = malloc(sizeof(unsigned long long) * capacity);
+    *values = malloc(sizeof(float) * capacity);
+    if (*keys == NULL || *values == NULL){
+        _allocation_fail();
+    }
+    for (int i = 0; i < capacity; i++){
+        (*keys)[i] = EMPTY_KEY;
+    }
+}
+
+/**
+ * @brief Aloca uma tabela de linhas com todas as posições vazias.
+ *
+ * @param capacity número de posições.
+ * @return tabela alocada.
+ */
+static HashRow* _rows_alloc(int capacity){
+    HashRow* table = malloc(sizeof(HashRow) * capacity);
+    if (table == NULL){
+        _allocation_fail();
+    }
+    for (int i = 0; i < capacity; i++){
+        table[i].row = -1;
+    }
+    return table;
+}
+
+/**
+ * @brief Procura uma linha na tabela de linhas (sondagem linear).
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_ROWS.
+ * @param row linha armazenada.
+ * @param empty_slot saída opcional (pode ser NULL): posição vazia que encerrou a sondagem.
+ * @return posição da linha, ou -1 se ela não tiver elementos.
+ */
+static int _rows_find_slot(HashMatrix* matrix, int row, int* empty_slot){
+    unsigned int index = hash(row, 0, matrix->capacity);
+
+    while (matrix->row_table[index].row != -1){
+        if (matrix->row_table[index].row == row){
+            return (int) index;
+        }
+        index = (index + 1) & (matrix->capacity - 1);
+    }
+    if (empty_slot != NULL){
+        *empty_slot = (int) index;
+    }
+    return -1;
+}
+
+/**
+ * @brief Reconstrói a tabela de linhas com uma nova capacidade, ignorando posições vazias.
+ *
+ * Os vetores de cada linha são apenas movidos, não copiados.
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_ROWS.
+ * @param new_capacity nova capacidade (potência de dois).
+ */
+static void _rows_rehash(HashMatrix* matrix, int new_capacity){
+    HashRow* new_table = _rows_alloc(new_capacity);
+
+    for (int i = 0; i < matrix->capacity; i++){
+        if (matrix->row_table[i].row == -1){
+            continue;
+        }
+        unsigned int index = hash(matrix->row_table[i].row, 0, new_capacity);
+        while (new_table[index].row != -1){
+            index = (index + 1) & (new_capacity - 1);
+        }
+        new_table[index] = matrix->row_table[i];
+    }
+
+    free(matrix->row_table);
+    matrix->row_table = new_table;
+    matrix->capacity = new_capacity;
+}
+
+/**
+ * @brief Remove uma linha vazia da tabela com deslocamento para trás (backward shift).
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_ROWS.
+ * @param slot posição ocupada pela linha, cujos vetores já foram liberados.
+ */
+static void _rows_remove_slot(HashMatrix* matrix, int slot){
+    int mask = matrix->capacity - 1;
+    int hole = slot;
+    int next = (slot + 1) & mask;
+
+    while (matrix->row_table[next].row != -1){
+        int home = (int) hash(matrix->row_table[next].row, 0, matrix->capacity);
+        //Desloca se a posição original de next não estiver no intervalo cíclico (hole, next].
+        if (((next - home) & mask) >= ((next - hole) & mask)){
+            matrix->row_table[hole] = matrix->row_table[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    matrix->row_table[hole].row = -1;
+}
+
+/**
+ * @brief Posição de uma coluna no vetor ordenado da linha (busca binária).
+ *
+ * @param row_entry linha armazenada.
+ * @param column coluna procurada.
+ * @return menor posição p tal que columns[p] >= column (count se não houver).
+ */
+static int _row_lower_bound(HashRow* row_entry, int column){
+    int low = 0;
+    int high = row_entry->count;
+    while (low < high){
+        int middle = low + (high - low) / 2;
+        if (row_entry->columns[middle] < column){
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Insere (column, data) na posição position do vetor ordenado da linha.
+ *
+ * @param row_entry linha armazenada.
+ * @param position posição obtida com _row_lower_bound.
+ * @param column coluna.
+ * @param data valor armazenado.
+ */
+static void _row_insert_at(HashRow* row_entry, int position, int column, float data){
+    if (row_entry->count == row_entry->capacity){
+        row_entry->capacity = row_entry->capacity == 0 ? ROW_INITIAL_COLUMNS : row_entry->capacity * 2;
+        row_entry->columns = realloc(row_entry->columns, sizeof(int) * row_entry->capacity);
+        row_entry->values = realloc(row_entry->values, sizeof(float) * row_entry->capacity);
+        if (row_entry->columns == NULL || row_entry->values == NULL){
+            _allocation_fail();
+        }
+    }
+    int tail = row_entry->count - position;
+    memmove(&row_entry->columns[position + 1], &row_entry->columns[position], sizeof(int) * tail);
+    memmove(&row_entry->values[position + 1], &row_entry->values[position], sizeof(float) * tail);
+    row_entry->columns[position] = column;
+    row_entry->values[position] = data;
+    row_entry->count++;
+}
+
+/**
+ * @brief Remove a posição position do vetor ordenado da linha.
+ *
+ * @param row_entry linha armazenada.
+ * @param position posição ocupada.
+ */
+static void _row_remove_at(HashRow* row_entry, int position){
+    int tail = row_entry->count - position - 1;
+    memmove(&row_entry->columns[position], &row_entry->columns[position + 1], sizeof(int) * tail);
+    memmove(&row_entry->values[position], &row_entry->values[position + 1], sizeof(float) * tail);
+    row_entry->count--;
+}
+
+/**
+ * @brief Libera os vetores de todas as linhas da tabela.
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_ROWS.
+ */
+static void _rows_free_vectors(HashMatrix* matrix){
+    for (int i = 0; i < matrix->capacity; i++){
+        if (matrix->row_table[i].row != -1){
+            free(matrix->row_table[i].columns);
+            free(matrix->row_table[i].values);
+        }
+    }
+}
+
+/**
+ * @brief Posição da linha na tabela, criando-a vazia se ainda não existir.
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_ROWS.
+ * @param target_row linha armazenada.
+ * @return Posição da linha em row_table.
+ */
+static int _rows_acquire_slot(HashMatrix* matrix, int target_row){
+    int empty_slot = -1;
+    int slot = _rows_find_slot(matrix, target_row, &empty_slot);
+    if (slot >= 0){
+        return slot;
+    }
+    if ((float)(matrix->row_count + 1) / matrix->capacity > LOAD_FACTOR_UPPER){
+        _rows_rehash(matrix, matrix->capacity * 2);
+        _rows_find_slot(matrix, target_row, &empty_slot);
+    }
+    matrix->row_table[empty_slot] = (HashRow){target_row, 0, 0, NULL, NULL};
+    matrix->row_count++;
+    return empty_slot;
+}
+
+/**
+ * @brief Par (coluna, valor) usado para ordenar uma linha.
+ */
+typedef struct HashRowEntry{
+    int column;
+    float data;
+} HashRowEntry;
+
+/**
+ * @brief Comparador de ::HashRowEntry por coluna, para qsort.
+ */
+static int _compare_row_entry(const void* a, const void* b){
+    int x = ((const HashRowEntry*) a)->column;
+    int y = ((const HashRowEntry*) b)->column;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ordena por coluna as linhas que inserções em bloco deixaram fora de ordem.
+ *
+ * Cada linha é verificada em O(count) e só as desordenadas são ordenadas, em
+ * O(count log count); inserir cada elemento na posição certa custaria O(count²) por linha.
+ *
+ * @param matrix matriz no modo ::HASH_STORAGE_ROWS.
+ */
+static void _rows_sort_columns(HashMatrix* matrix){
+    HashRowEntry* entries = NULL;
+    int entries_capacity = 0;
+    for (int i = 0; i < matrix->capacity; i++){
+        HashRow* row_entry = &matrix->row_table[i];
+        if (row_entry->row == -1){
+            continue;
+        }
+        int sorted = 1;
+        for (int p = 1; p < row_entry->count && sorted; p++){
+            sorted = row_entry->columns[p - 1] < row_entry->columns[p];
+        }
+        if (sorted){
+            continue;
+        }
+        if (row_entry->count > entries_capacity){
+            entries_capacity = row_entry->count;
+            entries = realloc(entries, sizeof(HashRowEntry) * entries_capacity);
+            if (entries == NULL){
+                _allocation_fail();
+            }
+        }
+        for (int p = 0; p < row_entry->count; p++){
+            entries[p] = (HashRowEntry){row_entry->columns[p], row_entry->values[p]};
+        }
+        qsort(entries, row_entry->count, sizeof(HashRowEntry), _compare_row_entry);
+        for (int p = 0; p < row_entry->count; p++){
+            row_entry->columns[p] = entries[p].column;
+            row_entry->values[p] = entries[p].data;
+        }
+    }
+    free(entries);
+}
+
+/**
+ * @brief Define ou acumula um elemento no modo ::HASH_STORAGE_ROWS.
+ *
+ * Uma sondagem localiza a linha e uma busca binária localiza a coluna. Linhas que
+ * ficam vazias saem da tabela, que cresce e encolhe pelos mesmos load factors.
+ *
+ * @param matrix matriz no modo de dois níveis.
+ * @param target_row linha armazenada.
+ * @param target_column coluna armazenada.
+ * @param value novo valor lógico (accumulate falso) ou parcela a somar (accumulate verdadeiro).
+ * @param accumulate se verdadeiro, soma value ao valor atual.
+ */
+static void _update_element_rows(HashMatrix* matrix, int target_row, int target_column, float value, bool accumulate){
+    int slot = _rows_find_slot(matrix, target_row, NULL);
+
+    if (slot < 0){
+        if (value == 0.0){
+            return;
+        }
+        slot = _rows_acquire_slot(matrix, target_row);
+    }
+
+    HashRow* row_entry = &matrix->row_table[slot];
+    int position = _row_lower_bound(row_entry, target_column);
+
+    if (position < row_entry->count && row_entry->columns[position] == target_column){
+        float data = accumulate ? row_entry->values[position] + value : value;
+        if (data != 0.0){
+            row_entry->values[position] = data;
+            return;
+        }
+        _row_remove_at(row_entry, position);
+        matrix->count--;
+    } else if (value != 0.0){
+        _row_insert_at(row_entry, position, target_column, value);
+        matrix->count++;
+    }
+
+    if (row_entry->count == 0){
+        free(row_entry->columns);
+        free(row_entry->values);
+        _rows_remove_slot(matrix, slot);
+        matrix->row_count--;
+        if ((float)matrix->row_count / matrix->capacity < LOAD_FACTOR_LOWER && matrix->capacity > INITIAL_CAPACITY){
+            _rows_rehash(matrix, matrix->capacity / 2);
+        }
+    }
+}
+
+/**
+ * @brief Cursor interno para percorrer os elementos armazenados, independente da estratégia.
+ */
+typedef struct {
+    int index;    /**< Bucket ou posição atual. */
+    Node* node;   /**< Próximo nó do bucket atual (apenas encadeamento). */
+    int position; /**< Próxima posição dentro da linha atual (apenas dois níveis). */
+} HashCursor;
+
+/**
+ * @brief Avança o cursor para o próximo elemento armazenado.
+ *
+ * As coordenadas retornadas são as armazenadas, sem aplicar is_transposed; o valor já
+ * inclui o fator scale. Durante uma migração incremental, a tabela antiga é percorrida
+ * depois da nova. No modo de dois níveis, os elementos de uma linha saem em sequência.
+ *
+ * @param matrix matriz percorrida.
+ * @param cursor cursor inicializado com {0, NULL, 0}.
+ * @param row saída: linha armazenada.
+ * @param column saída: coluna armazenada.
+ * @param data saída: valor.
+ * @return true se um elemento foi produzido, false ao final.
+ */
+static bool _next_entry(HashMatrix* matrix, HashCursor* cursor, int* row, int* column, float* data){
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        while (cursor->index < matrix->capacity){
+            HashRow* row_entry = &matrix->row_table[cursor->index];
+            if (row_entry->row != -1 && cursor->position < row_entry->count){
+                *row = row_entry->row;
+                *column = row_entry->columns[cursor->position];
+                *data = row_entry->values[cursor->position] * matrix->scale;
+                cursor->position++;
+                return true;
+            }
+            cursor->index++;
+            cursor->position = 0;
+        }
+        return false;
+    }
+
+    if (matrix->storage == HASH_STORAGE_OPEN){
+        while (cursor->index < matrix->capacity){
+            int i = cursor->index++;
+            if (matrix->keys[i] != EMPTY_KEY){
+                *row = _key_row(matrix->keys[i]);
+                *column = _key_column(matrix->keys[i]);
+                *data = matrix->values[i] * matrix->scale;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    while (cursor->node == NULL){
+        if (cursor->index < matrix->capacity){
+            cursor->node = matrix->buckets[cursor->index++];
+        } else if (matrix->old_buckets != NULL && cursor->index < matrix->capacity + matrix->old_capacity){
+            cursor->node = matrix->old_buckets[cursor->index++ - matrix->capacity];
+        } else {
+            return false;
+        }
+    }
+    *row = cursor->node->row;
+    *column = cursor->node->column;
+    *data = cursor->node->data * matrix->scale;
+    cursor->node = cursor->node->next;
+    return true;
+}
+
+/**
+ * @brief Migra até steps buckets da tabela antiga para a atual.
+ *
+ * Ao migrar o último bucket, a tabela antiga é liberada.
+ *
+ * @param matrix matriz no modo encadeado.
+ * @param steps número máximo de buckets a migrar.
+ */
+static void _migrate_buckets(HashMatrix* matrix, int steps){
+    while (steps > 0 && matrix->old_buckets != NULL){
+        Node* curr = matrix->old_buckets[matrix->migrate_index];
+        while (curr != NULL){
+            Node* next = curr->next;
+            unsigned int index = hash(curr->row, curr->column, matrix->capacity);
+            curr->next = matrix->buckets[index];
+            matrix->buckets[index] = curr;
+            curr = next;
+        }
+        matrix->old_buckets[matrix->migrate_index] = NULL;
+        matrix->migrate_index++;
+        steps--;
+
+        if (matrix->migrate_index == matrix->old_capacity){
+            free(matrix->old_buckets);
+            matrix->old_buckets = NULL;
+            matrix->old_capacity = 0;
+            matrix->migrate_index = 0;
+        }
+    }
+}
+
+/**
+ * @brief Conclui imediatamente uma migração incremental pendente.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ */
+static void _finish_migration(HashMatrix* matrix){
+    if (matrix->old_buckets != NULL){
+        _migrate_buckets(matrix, matrix->old_capacity - matrix->migrate_index);
+    }
+}
+
+/**
+ * @brief Inicia uma migração incremental para uma nova capacidade.
+ *
+ * Só aloca a nova tabela; os nós continuam na antiga até serem migrados. O passo por
+ * operação é escolhido para que a tabela antiga inteira seja migrada antes que count
+ * possa cruzar um dos limites de load factor da nova capacidade: sem isso, um
+ * encolhimento seguido de crescimento encontraria a migração anterior pendente e a
+ * concluiria de uma vez, em O(capacity).
+ *
+ * @param matrix matriz no modo encadeado.
+ * @param new_capacity nova quantidade de buckets (potência de dois).
+ */
+static void _start_migration(HashMatrix* matrix, int new_capacity){
+    _finish_migration(matrix); //só tem trabalho se o passo não acompanhou count (não deve ocorrer)
+
+    //Operações que alteram count até o próximo redimensionamento, com uma de folga.
+    int until_grow = (int) (new_capacity * LOAD_FACTOR_UPPER) - matrix->count - 1;
+    int until_shrink = matrix->count - (int) ceil(new_capacity * LOAD_FACTOR_LOWER);
+    int headroom = until_grow < until_shrink ? until_grow : until_shrink;
+    headroom = headroom > 1 ? headroom - 1 : 1;
+    int step = (matrix->capacity + headroom - 1) / headroom;
+    matrix->migrate_step = step > MIGRATE_STEP_BUCKETS ? step : MIGRATE_STEP_BUCKETS;
+
+    Node **new_buckets = calloc(new_capacity, sizeof(Node*));
+    if (new_buckets == NULL){
+        _allocation_fail();
+    }
+    matrix->old_buckets = matrix->buckets;
+    matrix->old_capacity = matrix->capacity;
+    matrix->migrate_index = 0;
+    matrix->buckets = new_buckets;
+    matrix->capacity = new_capacity;
+}
+
+/**
+ * @brief Reconstrói a tabela de espalhamento com uma nova capacidade.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param new_capacity nova quantidade de buckets ou posições (potência de dois).
+ */
+static void _rehash(HashMatrix* matrix, int new_capacity){
+    assert(new_capacity > 0 && (new_capacity & (new_capacity - 1)) == 0);
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        _rows_rehash(matrix, new_capacity);
+        return;
+    }
+    if (matrix->storage == HASH_STORAGE_OPEN){
+        unsigned long long* new_keys;
+        float* new_values;
+        _open_alloc(new_capacity, &new_keys, &new_values);
+
+        for (int i = 0; i < matrix->capacity; i++){
+            if (matrix->keys[i] != EMPTY_KEY){
+                _open_place(new_keys, new_values, new_capacity, matrix->keys[i], matrix->values[i]);
+            }
+        }
+
+        free(matrix->keys);
+        free(matrix->values);
+        matrix->keys = new_keys;
+        matrix->values = new_values;
+        matrix->capacity = new_capacity;
+        return;
+    }
+
+    _finish_migration(matrix);
+
+    Node **new_buckets = calloc(new_capacity, sizeof(Node*));
+    if (new_buckets == NULL){
+        _allocation_fail();
+    }
+
+    for(int i = 0; i < matrix->capacity; i++){
+        Node* curr = matrix->buckets[i];
+        while (curr != NULL){
+            Node* next = curr->next;
+            unsigned long new_index = hash(curr->row, curr->column, new_capacity);
+
+            curr->next = new_buckets[new_index];
+            new_buckets[new_index] = curr;
+            curr = next;
+        }
+    }
+
+    free(matrix->buckets);
+    matrix->buckets = new_buckets;
+    matrix->capacity = new_capacity;
 }
 
 /**
@@ -40,97 +789,654 @@ HashStatus resize(HashMatrix* matrix){
     if (matrix == NULL){
         return HASH_ERROR_NULL_MATRIX;
     }
+    if (matrix->storage == HASH_STORAGE_ROWS){ //a tabela de linhas cresce e encolhe em _update_element_rows
+        return HASH_STATUS_OK;
+    }
 
     int new_capacity = matrix->capacity;
-    
+
     if ((float)(matrix->count+1) / matrix->capacity > LOAD_FACTOR_UPPER){
         new_capacity = matrix->capacity *2;
     } else if ((float)(matrix->count) / matrix->capacity < LOAD_FACTOR_LOWER){
         new_capacity = matrix->capacity/2;
     }
 
-    if (new_capacity == matrix->capacity){
-        return HASH_STATUS_OK;
+    if (new_capacity == matrix->capacity){
+        return HASH_STATUS_OK;
+    }
+
+    if (matrix->resize_mode == HASH_RESIZE_INCREMENTAL){
+        _start_migration(matrix, new_capacity);
+    } else {
+        _rehash(matrix, new_capacity);
+    }
+    return HASH_STATUS_OK;
+}
+
+/**
+ * @brief Garante capacidade para total elementos sem ultrapassar LOAD_FACTOR_UPPER.
+ *
+ * Faz no máximo um rehash, em vez dos log(total) que inserções sucessivas causariam.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param total número de elementos que a matriz terá.
+ */
+static void _reserve(HashMatrix* matrix, int total){
+    if (matrix->storage == HASH_STORAGE_ROWS){ //o número de linhas não é conhecido de antemão
+        return;
+    }
+    int new_capacity = matrix->capacity;
+    while ((float) total / new_capacity > LOAD_FACTOR_UPPER){
+        new_capacity = new_capacity * 2;
+    }
+    if (new_capacity != matrix->capacity){
+        _rehash(matrix, new_capacity);
+    }
+}
+
+/**
+ * @brief Multiplica os valores armazenados por factor e redefine scale para 1.
+ *
+ * Elementos que se anulam (underflow) são removidos.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param factor fator a incorporar.
+ */
+static void _fold_scale(HashMatrix* matrix, float factor){
+    matrix->scale = 1.0f;
+
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        bool removed = false;
+        for (int i = 0; i < matrix->capacity; i++){
+            HashRow* row_entry = &matrix->row_table[i];
+            if (row_entry->row == -1){
+                continue;
+            }
+            int kept = 0;
+            for (int p = 0; p < row_entry->count; p++){
+                float data = row_entry->values[p] * factor;
+                if (data != 0.0){
+                    row_entry->columns[kept] = row_entry->columns[p];
+                    row_entry->values[kept] = data;
+                    kept++;
+                }
+            }
+            matrix->count -= row_entry->count - kept;
+            row_entry->count = kept;
+            if (kept == 0){
+                free(row_entry->columns);
+                free(row_entry->values);
+                row_entry->row = -1;
+                matrix->row_count--;
+                removed = true;
+            }
+        }
+        if (removed){
+            _rows_rehash(matrix, matrix->capacity);
+        }
+        return;
+    }
+
+    if (matrix->storage == HASH_STORAGE_OPEN){
+        bool removed = false;
+        for (int i = 0; i < matrix->capacity; i++){
+            if (matrix->keys[i] == EMPTY_KEY){
+                continue;
+            }
+            matrix->values[i] *= factor;
+            if (matrix->values[i] == 0.0){
+                //A tabela é reconstruída logo abaixo, então quebrar a sequência de sondagem aqui é seguro.
+                matrix->keys[i] = EMPTY_KEY;
+                matrix->count--;
+                removed = true;
+            }
+        }
+        if (removed){
+            _rehash(matrix, matrix->capacity);
+        }
+        return;
+    }
+
+    //Percorre também a tabela em migração, em vez de concluí-la, para não somar o custo do rehash.
+    for (int i = 0; i < matrix->capacity + matrix->old_capacity; i++){
+        Node** link = i < matrix->capacity ? &matrix->buckets[i] : &matrix->old_buckets[i - matrix->capacity];
+        while (*link != NULL){
+            Node* curr = *link;
+            curr->data *= factor;
+            if (curr->data == 0.0){
+                *link = curr->next;
+                _pool_release(&matrix->pool, curr);
+                matrix->count--;
+            } else {
+                link = &curr->next;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Prepara a matriz para uma escrita, incorporando o fator escalar pendente.
+ *
+ * As escritas guardam sempre o valor exato recebido: dividir por scale faria com que
+ * get_element_hash devolvesse um valor arredondado e poderia guardar como não nulo um
+ * valor que virou zero. Assim, apenas a primeira escrita depois de scale_hash paga o
+ * custo linear; o fator preguiçoso continua valendo para operações sobre a matriz inteira.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ */
+static void _prepare_write(HashMatrix* matrix){
+    if (matrix->scale != 1.0f){
+        _fold_scale(matrix, matrix->scale);
+    }
+}
+
+/**
+ * @brief Insere um elemento sabidamente ausente, sem busca nem verificação de load factor.
+ *
+ * O chamador deve ter reservado espaço com _reserve e, ao fim da sequência de inserções,
+ * chamar _finish_insert_absent: no modo ::HASH_STORAGE_ROWS o elemento é apenas anexado
+ * ao fim da linha, e a ordem das colunas é restaurada só no final.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param row linha armazenada.
+ * @param column coluna armazenada.
+ * @param data valor lógico não nulo.
+ */
+static void _insert_absent(HashMatrix* matrix, int row, int column, float data){
+    _prepare_write(matrix);
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        int slot = _rows_acquire_slot(matrix, row); //pode realocar row_table
+        HashRow* row_entry = &matrix->row_table[slot];
+        _row_insert_at(row_entry, row_entry->count, column, data);
+    } else if (matrix->storage == HASH_STORAGE_OPEN){
+        _open_place(matrix->keys, matrix->values, matrix->capacity, _pack_key(row, column), data);
+    } else {
+        unsigned int index = hash(row, column, matrix->capacity);
+        Node* node = _pool_alloc(&matrix->pool);
+        node->row = row;
+        node->column = column;
+        node->data = data;
+        node->next = matrix->buckets[index];
+        matrix->buckets[index] = node;
+    }
+    matrix->count++;
+}
+
+/**
+ * @brief Conclui uma sequência de _insert_absent, ordenando as linhas no modo ::HASH_STORAGE_ROWS.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ */
+static void _finish_insert_absent(HashMatrix* matrix){
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        _rows_sort_columns(matrix);
+    }
+}
+
+/**
+ * @brief Agrupa os elementos de uma matriz por linha lógica (formato CSR).
+ *
+ * Usa ordenação por contagem: um passo conta os elementos de cada linha e um
+ * segundo passo os distribui. A ordem das colunas dentro de cada linha é arbitrária.
+ *
+ * @param matrix matriz de origem (is_transposed é respeitado).
+ * @param rows número de linhas lógicas.
+ * @param row_ptr saída: vetor de rows+1 posições; a linha i ocupa [row_ptr[i], row_ptr[i+1]).
+ * @param columns saída: colunas lógicas dos elementos.
+ * @param values saída: valores dos elementos.
+ */
+static void _group_by_row(HashMatrix* matrix, int rows, int** row_ptr, int** columns, float** values){
+    *row_ptr = calloc((size_t) rows + 1, sizeof(int));
+    *columns = malloc(sizeof(int) * (matrix->count > 0 ? matrix->count : 1));
+    *values = malloc(sizeof(float) * (matrix->count > 0 ? matrix->count : 1));
+    int* next = malloc(sizeof(int) * (rows > 0 ? rows : 1));
+    if (*row_ptr == NULL || *columns == NULL || *values == NULL || next == NULL){
+        _allocation_fail();
+    }
+
+    //Dois níveis sem transposição: as linhas já estão agrupadas e ordenadas, basta copiá-las.
+    if (matrix->storage == HASH_STORAGE_ROWS && !matrix->is_transposed){
+        for (int i = 0; i < matrix->capacity; i++){
+            if (matrix->row_table[i].row != -1){
+                (*row_ptr)[matrix->row_table[i].row + 1] = matrix->row_table[i].count;
+            }
+        }
+        for (int i = 0; i < rows; i++){
+            (*row_ptr)[i + 1] += (*row_ptr)[i];
+        }
+        for (int i = 0; i < matrix->capacity; i++){
+            HashRow* row_entry = &matrix->row_table[i];
+            if (row_entry->row == -1){
+                continue;
+            }
+            int start = (*row_ptr)[row_entry->row];
+            memcpy(&(*columns)[start], row_entry->columns, sizeof(int) * row_entry->count);
+            for (int p = 0; p < row_entry->count; p++){
+                (*values)[start + p] = row_entry->values[p] * matrix->scale;
+            }
+        }
+        free(next);
+        return;
+    }
+
+    HashCursor cursor = {0, NULL, 0};
+    int stored_row, stored_column;
+    float data;
+    while (_next_entry(matrix, &cursor, &stored_row, &stored_column, &data)){
+        int row = matrix->is_transposed ? stored_column : stored_row;
+        (*row_ptr)[row + 1]++;
+    }
+    for (int i = 0; i < rows; i++){
+        (*row_ptr)[i + 1] += (*row_ptr)[i];
+        next[i] = (*row_ptr)[i];
+    }
+
+    cursor = (HashCursor){0, NULL, 0};
+    while (_next_entry(matrix, &cursor, &stored_row, &stored_column, &data)){
+        int row = matrix->is_transposed ? stored_column : stored_row;
+        int column = matrix->is_transposed ? stored_row : stored_column;
+        int position = next[row]++;
+        (*columns)[position] = column;
+        (*values)[position] = data;
+    }
+    free(next);
+}
+
+/**
+ * @brief Transpõe uma matriz agrupada por linha por ordenação por contagem.
+ *
+ * A ordenação é estável e visita as linhas de origem em ordem crescente, então as
+ * colunas da transposta saem ordenadas; aplicada duas vezes, ordena as colunas de
+ * cada linha da matriz original.
+ *
+ * @param rows linhas da origem.
+ * @param columns linhas da transposta.
+ * @param row_ptr, row_columns, row_values matriz de origem agrupada por linha.
+ * @param t_ptr, t_columns, t_values saída: transposta agrupada por linha.
+ */
+static void _transpose_grouped(int rows, int columns, const int* row_ptr, const int* row_columns, const float* row_values, int** t_ptr, int** t_columns, float** t_values){
+    int count = row_ptr[rows];
+    *t_ptr = calloc((size_t) columns + 1, sizeof(int));
+    *t_columns = malloc(sizeof(int) * (count > 0 ? count : 1));
+    *t_values = malloc(sizeof(float) * (count > 0 ? count : 1));
+    int* next = malloc(sizeof(int) * (columns > 0 ? columns : 1));
+    if (*t_ptr == NULL || *t_columns == NULL || *t_values == NULL || next == NULL){
+        _allocation_fail();
+    }
+    for (int p = 0; p < count; p++){
+        (*t_ptr)[row_columns[p] + 1]++;
+    }
+    for (int c = 0; c < columns; c++){
+        (*t_ptr)[c + 1] += (*t_ptr)[c];
+        next[c] = (*t_ptr)[c];
+    }
+    for (int r = 0; r < rows; r++){
+        for (int p = row_ptr[r]; p < row_ptr[r + 1]; p++){
+            int position = next[row_columns[p]]++;
+            (*t_columns)[position] = r;
+            (*t_values)[position] = row_values[p];
+        }
+    }
+    free(next);
+}
+
+/**
+ * @brief Verifica se a matriz resultado está corretamente inicializada.
+ *
+ * A matriz deve ser vazia.
+ *
+ * @param result ponteiro para a matriz resultado.
+ * @param expected_rows número esperado de linhas.
+ * @param expected_columns número esperado de colunas.
+ * @return true se a matriz estiver correta, false caso contrário.
+ */
+bool verify_result_matrix(HashMatrix* result, int expected_rows, int expected_columns){
+    if (result == NULL){
+        return false;
+    }
+
+    int rows = result->is_transposed ? result->columns : result->rows;
+    int columns = result->is_transposed ? result->rows : result->columns;
+    if (rows != expected_rows || columns != expected_columns){
+        return false;
+    }
+
+    if (result->count != 0){
+        return false;
+    }
+
+    return true;
+}
+
+HashMatrix* create_hash_matrix(int rows, int columns){
+    return create_hash_matrix_with_storage(rows, columns, HASH_STORAGE_CHAINED);
+}
+
+HashMatrix* create_hash_matrix_with_storage(int rows, int columns, HashStorage storage){
+    if (rows < 0 || columns < 0){
+        return NULL;
+    }
+    if (storage != HASH_STORAGE_CHAINED && storage != HASH_STORAGE_OPEN && storage != HASH_STORAGE_ROWS){
+        return NULL;
+    }
+
+    HashMatrix* matrix = malloc(sizeof(struct HashMatrix));
+    if (matrix == NULL){
+        _allocation_fail();
+    }
+
+    matrix->rows = rows;
+    matrix->columns = columns;
+    matrix->capacity = INITIAL_CAPACITY;
+    matrix->count = 0;
+    matrix->is_transposed = false;
+    matrix->storage = storage;
+    matrix->buckets = NULL;
+    matrix->keys = NULL;
+    matrix->values = NULL;
+    matrix->pool = (NodePool){NULL, NULL, 0, 0};
+    matrix->resize_mode = HASH_RESIZE_IMMEDIATE;
+    matrix->old_buckets = NULL;
+    matrix->old_capacity = 0;
+    matrix->migrate_index = 0;
+    matrix->migrate_step = MIGRATE_STEP_BUCKETS;
+    matrix->scale = 1.0f;
+    matrix->row_table = NULL;
+    matrix->row_count = 0;
+
+    if (storage == HASH_STORAGE_ROWS){
+        matrix->row_table = _rows_alloc(INITIAL_CAPACITY);
+        return matrix;
+    }
+
+    if (storage == HASH_STORAGE_OPEN){
+        _open_alloc(INITIAL_CAPACITY, &matrix->keys, &matrix->values);
+        return matrix;
+    }
+
+    matrix->buckets = calloc(INITIAL_CAPACITY, sizeof(Node*));
+    if (matrix->buckets == NULL){
+        free(matrix);
+        _allocation_fail();
+    }
+
+    return matrix;
+}
+
+/**
+ * @brief Procura um elemento no modo encadeado, em ambas as tabelas durante uma migração.
+ *
+ * @param matrix matriz no modo encadeado.
+ * @param row linha armazenada.
+ * @param column coluna armazenada.
+ * @return Endereço do ponteiro que aponta para o nó (permite removê-lo), ou NULL se ausente.
+ */
+static Node** _chained_find_link(HashMatrix* matrix, int row, int column){
+    Node** link = &matrix->buckets[hash(row, column, matrix->capacity)];
+    for (; *link != NULL; link = &(*link)->next){
+        if ((*link)->row == row && (*link)->column == column){
+            return link;
+        }
+    }
+    if (matrix->old_buckets == NULL){
+        return NULL;
+    }
+    link = &matrix->old_buckets[hash(row, column, matrix->old_capacity)];
+    for (; *link != NULL; link = &(*link)->next){
+        if ((*link)->row == row && (*link)->column == column){
+            return link;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Tripla (linha, coluna, valor) usada na partição da construção em bloco.
+ */
+typedef struct {
+    int row, column;
+    float data;
+} Triplet;
+
+HashMatrix* create_hash_matrix_from_triplets(int rows, int columns, int k, const int* I, const int* J, const float* Data, HashDuplicatePolicy policy){
+    if (k < 0 || (k > 0 && (I == NULL || J == NULL || Data == NULL))){
+        return NULL;
+    }
+    if (policy != HASH_DUPLICATES_SUM && policy != HASH_DUPLICATES_OVERWRITE){
+        return NULL;
+    }
+
+    bool in_bounds = true;
+    for (int t = 0; t < k; t++){
+        in_bounds &= (I[t] >= 0) & (I[t] < rows) & (J[t] >= 0) & (J[t] < columns);
+    }
+    if (!in_bounds){
+        return NULL;
+    }
+
+    HashMatrix* matrix = create_hash_matrix(rows, columns);
+    if (matrix == NULL){
+        return NULL;
+    }
+    if (k == 0){
+        return matrix;
+    }
+    _reserve(matrix, k);
+    _pool_reserve(&matrix->pool, k);
+
+    //Particiona as triplas pelos bits altos do bucket (ordenação por contagem, estável). Cada partição
+    //cobre uma faixa contígua e pequena de buckets, então a montagem das listas fica em cache.
+    int partitions = matrix->capacity < BULK_PARTITIONS ? matrix->capacity : BULK_PARTITIONS;
+    int shift = 0;
+    while ((partitions << shift) < matrix->capacity){
+        shift++;
+    }
+    int* start = calloc((size_t) partitions + 1, sizeof(int));
+    Triplet* triplets = malloc(sizeof(Triplet) * k);
+    if (start == NULL || triplets == NULL){
+        _allocation_fail();
+    }
+    for (int t = 0; t < k; t++){
+        start[(hash(I[t], J[t], matrix->capacity) >> shift) + 1]++;
+    }
+    for (int p = 0; p < partitions; p++){
+        start[p + 1] += start[p];
+    }
+    for (int t = 0; t < k; t++){
+        int p = (int) (hash(I[t], J[t], matrix->capacity) >> shift);
+        triplets[start[p]++] = (Triplet){I[t], J[t], Data[t]};
+    }
+
+    //A ordem de entrada é preservada dentro de cada bucket, o que garante HASH_DUPLICATES_OVERWRITE.
+    for (int t = 0; t < k; t++){
+        Triplet triplet = triplets[t];
+        Node** link = &matrix->buckets[hash(triplet.row, triplet.column, matrix->capacity)];
+        while (*link != NULL && ((*link)->row != triplet.row || (*link)->column != triplet.column)){
+            link = &(*link)->next;
+        }
+
+        if (*link == NULL){
+            if (triplet.data != 0.0){
+                Node* node = _pool_alloc(&matrix->pool);
+                node->row = triplet.row;
+                node->column = triplet.column;
+                node->data = triplet.data;
+                node->next = NULL;
+                *link = node;
+                matrix->count++;
+            }
+            continue;
+        }
+
+        float data = policy == HASH_DUPLICATES_SUM ? (*link)->data + triplet.data : triplet.data;
+        if (data == 0.0){
+            Node* curr = *link;
+            *link = curr->next;
+            _pool_release(&matrix->pool, curr);
+            matrix->count--;
+        } else {
+            (*link)->data = data;
+        }
+    }
+
+    free(start);
+    free(triplets);
+    return matrix;
+}
+
+float get_element_hash(HashMatrix* matrix, int row, int column){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+
+    int max_rows = matrix->is_transposed ? matrix->columns : matrix->rows;
+    int max_columns = matrix->is_transposed ? matrix->rows : matrix->columns;
+
+    if (row >= max_rows || row < 0 || column >= max_columns || column < 0){
+        return HASH_ERROR_OUT_OF_BOUNDS;
+    }
+
+    int target_row = matrix->is_transposed ? column : row;
+    int target_column = matrix->is_transposed ? row : column;
+
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        int slot = _rows_find_slot(matrix, target_row, NULL);
+        if (slot < 0){
+            return 0.0;
+        }
+        HashRow* row_entry = &matrix->row_table[slot];
+        int position = _row_lower_bound(row_entry, target_column);
+        bool found = position < row_entry->count && row_entry->columns[position] == target_column;
+        return found ? row_entry->values[position] * matrix->scale : 0.0;
     }
 
-    Node **new_buckets = calloc(new_capacity, sizeof(Node*));
-    if (new_buckets == NULL){
-        _allocation_fail();
+    if (matrix->storage == HASH_STORAGE_OPEN){
+        int slot = _open_find_slot(matrix, target_row, target_column, NULL);
+        return slot < 0 ? 0.0 : matrix->values[slot] * matrix->scale;
     }
 
-    for(int i = 0; i < matrix->capacity; i++){
-        Node* curr = matrix->buckets[i];
-        while (curr != NULL){
-            Node* next = curr->next;
-            unsigned long new_index = hash(curr->row, curr->column, new_capacity);
+    _migrate_buckets(matrix, matrix->migrate_step);
+    Node** link = _chained_find_link(matrix, target_row, target_column);
+    return link == NULL ? 0.0 : (*link)->data * matrix->scale;
+}
 
-            curr->next = new_buckets[new_index];
-            new_buckets[new_index] = curr;
-            curr = next;
+/**
+ * @brief Define ou acumula um elemento com uma única sondagem, no modo ::HASH_STORAGE_OPEN.
+ *
+ * @param matrix matriz no modo de endereçamento aberto.
+ * @param target_row linha armazenada.
+ * @param target_column coluna armazenada.
+ * @param value novo valor lógico (accumulate falso) ou parcela a somar (accumulate verdadeiro).
+ * @param accumulate se verdadeiro, soma value ao valor atual.
+ */
+static void _update_element_open(HashMatrix* matrix, int target_row, int target_column, float value, bool accumulate){
+    int empty_slot = -1;
+    int slot = _open_find_slot(matrix, target_row, target_column, &empty_slot);
+
+    if (slot >= 0){
+        float data = accumulate ? matrix->values[slot] + value : value;
+        if (data == 0.0){
+            _open_remove_slot(matrix, slot);
+            matrix->count--;
+            if ((float)matrix->count / matrix->capacity < LOAD_FACTOR_LOWER && matrix->capacity > INITIAL_CAPACITY) {
+                resize(matrix);
+            }
+        } else {
+            matrix->values[slot] = data;
         }
+        return;
     }
 
-    free(matrix->buckets);
-    matrix->buckets = new_buckets;
-    matrix->capacity = new_capacity;
-
-    return HASH_STATUS_OK;
+    if (value != 0.0){
+        if ((float)(matrix->count + 1) / matrix->capacity > LOAD_FACTOR_UPPER){
+            resize(matrix);
+            _open_place(matrix->keys, matrix->values, matrix->capacity, _pack_key(target_row, target_column), value);
+        } else {
+            matrix->keys[empty_slot] = _pack_key(target_row, target_column);
+            matrix->values[empty_slot] = value;
+        }
+        matrix->count++;
+    }
 }
 
 /**
- * @brief Verifica se a matriz resultado está corretamente inicializada.
- * 
- * A matriz deve ser vazia.
+ * @brief Define ou acumula um elemento com uma única busca, em coordenadas armazenadas.
  *
- * @param result ponteiro para a matriz resultado.
- * @param expected_rows número esperado de linhas.
- * @param expected_columns número esperado de colunas.
- * @return true se a matriz estiver correta, false caso contrário.
+ * Base comum de set_element_hash, accumulate_element_hash e dos kernels internos.
+ * Elementos cujo resultado é zero são removidos.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param target_row linha armazenada.
+ * @param target_column coluna armazenada.
+ * @param value novo valor lógico (accumulate falso) ou parcela a somar (accumulate verdadeiro).
+ * @param accumulate se verdadeiro, soma value ao valor atual.
  */
-bool verify_result_matrix(HashMatrix* result, int expected_rows, int expected_columns){
-    if (result == NULL){
-        return false;
+static void _update_element(HashMatrix* matrix, int target_row, int target_column, float value, bool accumulate){
+    _prepare_write(matrix);
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        _update_element_rows(matrix, target_row, target_column, value, accumulate);
+        return;
     }
-
-    int rows = result->is_transposed ? result->columns : result->rows;
-    int columns = result->is_transposed ? result->rows : result->columns;
-    if (rows != expected_rows || columns != expected_columns){
-        return false;
+    if (matrix->storage == HASH_STORAGE_OPEN){
+        _update_element_open(matrix, target_row, target_column, value, accumulate);
+        return;
     }
 
-    if (result->count != 0){
-        return false;
+    _migrate_buckets(matrix, matrix->migrate_step);
+    Node** link = _chained_find_link(matrix, target_row, target_column);
+
+    if (link != NULL){
+        Node* curr = *link;
+        float data = accumulate ? curr->data + value : value;
+        if (data == 0.0){
+            *link = curr->next;
+            _pool_release(&matrix->pool, curr);
+            matrix->count--;
+            if ((float)matrix->count / matrix->capacity < LOAD_FACTOR_LOWER && matrix->capacity > INITIAL_CAPACITY) {
+                resize(matrix);
+            }
+        } else {
+            curr->data = data;
+        }
+        return;
     }
 
-    return true;
-}
+    if (value != 0.0){
+        if ((float)(matrix->count + 1) / matrix->capacity > LOAD_FACTOR_UPPER){
+            resize(matrix);
+        }
+        unsigned int index = hash(target_row, target_column, matrix->capacity);
 
-HashMatrix* create_hash_matrix(int rows, int columns){
-    if (rows < 0 || columns < 0){
-        return NULL;
+        Node* new_Node = _pool_alloc(&matrix->pool);
+        new_Node->column = target_column;
+        new_Node->row = target_row;
+        new_Node->data = value;
+        new_Node->next = matrix->buckets[index];
+        matrix->buckets[index] = new_Node;
+        matrix->count++;
     }
+}
 
-    HashMatrix* matrix = malloc(sizeof(struct HashMatrix));
+HashStatus set_element_hash(HashMatrix* matrix, int row, int column, float data){
     if (matrix == NULL){
-        _allocation_fail();
-    } 
+        return HASH_ERROR_NULL_MATRIX;
+    }
 
-    matrix->rows = rows;
-    matrix->columns = columns;
-    matrix->capacity = INITIAL_CAPACITY;
-    matrix->count = 0;
-    matrix->is_transposed = false;
+    int max_rows = matrix->is_transposed ? matrix->columns : matrix->rows;
+    int max_columns = matrix->is_transposed ? matrix->rows : matrix->columns;
 
-    matrix->buckets = calloc(INITIAL_CAPACITY, sizeof(Node*));
-    if (matrix->buckets == NULL){
-        free(matrix);
-        _allocation_fail();
+    if (row >= max_rows || row < 0 || column >= max_columns || column < 0){
+        return HASH_ERROR_OUT_OF_BOUNDS;
     }
 
-    return matrix;
+    int target_row = matrix->is_transposed ? column : row;
+    int target_column = matrix->is_transposed ? row : column;
+
+    _update_element(matrix, target_row, target_column, data, false);
+    return HASH_STATUS_OK;
 }
 
-float get_element_hash(HashMatrix* matrix, int row, int column){
+HashStatus accumulate_element_hash(HashMatrix* matrix, int row, int column, float delta){
     if (matrix == NULL){
         return HASH_ERROR_NULL_MATRIX;
     }
@@ -145,84 +1451,176 @@ float get_element_hash(HashMatrix* matrix, int row, int column){
     int target_row = matrix->is_transposed ? column : row;
     int target_column = matrix->is_transposed ? row : column;
 
-    unsigned int index = hash(target_row, target_column, matrix->capacity);
+    _update_element(matrix, target_row, target_column, delta, true);
+    return HASH_STATUS_OK;
+}
+
+HashStatus get_row_hash(HashMatrix* matrix, int row, int* columns, float* values, int* count){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (columns == NULL || values == NULL || count == NULL){
+        return HASH_ERROR_INVALID_ARGUMENT;
+    }
+
+    int max_rows = matrix->is_transposed ? matrix->columns : matrix->rows;
+    if (row >= max_rows || row < 0){
+        return HASH_ERROR_OUT_OF_BOUNDS;
+    }
 
-    Node* curr = matrix->buckets[index];
-    while (curr != NULL){
-        if (curr->row == target_row && curr->column == target_column){
-            return curr->data;
+    *count = 0;
+    if (matrix->storage == HASH_STORAGE_ROWS && !matrix->is_transposed){
+        int slot = _rows_find_slot(matrix, row, NULL);
+        if (slot >= 0){
+            HashRow* row_entry = &matrix->row_table[slot];
+            memcpy(columns, row_entry->columns, sizeof(int) * row_entry->count);
+            for (int p = 0; p < row_entry->count; p++){
+                values[p] = row_entry->values[p] * matrix->scale;
+            }
+            *count = row_entry->count;
         }
-        curr = curr->next;
+        return HASH_STATUS_OK;
     }
 
-    return 0.0;
+    HashCursor cursor = {0, NULL, 0};
+    int stored_row, stored_column;
+    float data;
+    while (_next_entry(matrix, &cursor, &stored_row, &stored_column, &data)){
+        if ((matrix->is_transposed ? stored_column : stored_row) == row){
+            columns[*count] = matrix->is_transposed ? stored_row : stored_column;
+            values[*count] = data;
+            (*count)++;
+        }
+    }
+    return HASH_STATUS_OK;
 }
 
-HashStatus set_element_hash(HashMatrix* matrix, int row, int column, float data){
+HashStatus row_sum_hash(HashMatrix* matrix, int row, float* sum){
     if (matrix == NULL){
         return HASH_ERROR_NULL_MATRIX;
     }
+    if (sum == NULL){
+        return HASH_ERROR_INVALID_ARGUMENT;
+    }
 
     int max_rows = matrix->is_transposed ? matrix->columns : matrix->rows;
-    int max_columns = matrix->is_transposed ? matrix->rows : matrix->columns;
-
-    if (row >= max_rows || row < 0 || column >= max_columns || column < 0){
+    if (row >= max_rows || row < 0){
         return HASH_ERROR_OUT_OF_BOUNDS;
     }
 
-    int target_row = matrix->is_transposed ? column : row;
-    int target_column = matrix->is_transposed ? row : column;
-
-    unsigned int index = hash(target_row, target_column, matrix->capacity);
-    Node* curr = matrix->buckets[index];
-    Node* prev = NULL;
-
-    while(curr != NULL){
-        if (curr->row == target_row && curr->column == target_column){
-            if (data == 0.0){
-                if (prev == NULL){
-                    matrix->buckets[index] = curr->next;
-                } else {
-                    prev->next = curr->next;
-                }
-                free(curr);
-                matrix->count--;
-                if ((float)matrix->count / matrix->capacity < LOAD_FACTOR_LOWER && matrix->capacity > INITIAL_CAPACITY) {
-                    resize(matrix);
-                }
-            } else {
-                curr->data = data;
+    *sum = 0.0;
+    if (matrix->storage == HASH_STORAGE_ROWS && !matrix->is_transposed){
+        int slot = _rows_find_slot(matrix, row, NULL);
+        if (slot >= 0){
+            HashRow* row_entry = &matrix->row_table[slot];
+            for (int p = 0; p < row_entry->count; p++){
+                *sum += row_entry->values[p];
             }
-            return HASH_STATUS_OK;
+            *sum *= matrix->scale;
         }
-        prev = curr;
-        curr = curr->next;
+        return HASH_STATUS_OK;
     }
 
-    if (data != 0.0){
-        if ((float)(matrix->count + 1) / matrix->capacity > LOAD_FACTOR_UPPER){
-            resize(matrix);
-            index = hash(target_row, target_column, matrix->capacity);
+    HashCursor cursor = {0, NULL, 0};
+    int stored_row, stored_column;
+    float data;
+    while (_next_entry(matrix, &cursor, &stored_row, &stored_column, &data)){
+        if ((matrix->is_transposed ? stored_column : stored_row) == row){
+            *sum += data;
         }
-        
-        Node* new_Node = malloc(sizeof(Node));
-        if (new_Node == NULL){
-            _allocation_fail();
+    }
+    return HASH_STATUS_OK;
+}
+
+/**
+ * @brief Calcula y = M * x (transposed = false) ou y = M^T * x (transposed = true).
+ *
+ * A linha armazenada corresponde a uma posição de y quando is_transposed == transposed;
+ * nesse caso o modo de dois níveis calcula cada posição como um produto escalar.
+ */
+static HashStatus _spmv(HashMatrix* matrix, const float* x, float* y, bool transposed){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (x == NULL || y == NULL){
+        return HASH_ERROR_INVALID_ARGUMENT;
+    }
+
+    bool stored_rows_out = matrix->is_transposed == transposed;
+    int length = stored_rows_out ? matrix->rows : matrix->columns;
+    for (int t = 0; t < length; t++){
+        y[t] = 0.0f;
+    }
+    if (matrix->storage == HASH_STORAGE_ROWS && stored_rows_out){
+        for (int i = 0; i < matrix->capacity; i++){
+            HashRow* row_entry = &matrix->row_table[i];
+            if (row_entry->row == -1){
+                continue;
+            }
+            float sum = 0.0f;
+            for (int p = 0; p < row_entry->count; p++){
+                sum += row_entry->values[p] * x[row_entry->columns[p]];
+            }
+            y[row_entry->row] = sum * matrix->scale;
         }
-        new_Node->column = target_column;
-        new_Node->row = target_row;
-        new_Node->data = data;
-        new_Node->next = NULL;
+        return HASH_STATUS_OK;
+    }
 
-        new_Node->next = matrix->buckets[index];
-        matrix->buckets[index] = new_Node;
-        matrix->count++;
+    HashCursor cursor = {0, NULL, 0};
+    int stored_row, stored_column;
+    float data;
+    while (_next_entry(matrix, &cursor, &stored_row, &stored_column, &data)){
+        if (stored_rows_out){
+            y[stored_row] += data * x[stored_column];
+        } else {
+            y[stored_column] += data * x[stored_row];
+        }
+    }
+    return HASH_STATUS_OK;
+}
+
+HashStatus spmv_hash(HashMatrix* matrix, const float* x, float* y){
+    return _spmv(matrix, x, y, false);
+}
+
+HashStatus spmv_transposed_hash(HashMatrix* matrix, const float* x, float* y){
+    return _spmv(matrix, x, y, true);
+}
+
+HashStatus to_csr_hash(HashMatrix* matrix, int** row_ptr, int** columns, float** values){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (row_ptr == NULL || columns == NULL || values == NULL){
+        return HASH_ERROR_INVALID_ARGUMENT;
+    }
+
+    int rows = matrix->is_transposed ? matrix->columns : matrix->rows;
+    int logical_columns = matrix->is_transposed ? matrix->rows : matrix->columns;
+    _group_by_row(matrix, rows, row_ptr, columns, values);
+    if (matrix->storage == HASH_STORAGE_ROWS && !matrix->is_transposed){
+        return HASH_STATUS_OK;
     }
 
+    //Ida e volta pela transposta: cada passo é estável e deixa as colunas ordenadas.
+    int *t_ptr, *t_columns;
+    float* t_values;
+    _transpose_grouped(rows, logical_columns, *row_ptr, *columns, *values, &t_ptr, &t_columns, &t_values);
+    free(*row_ptr);
+    free(*columns);
+    free(*values);
+    _transpose_grouped(logical_columns, rows, t_ptr, t_columns, t_values, row_ptr, columns, values);
+    free(t_ptr);
+    free(t_columns);
+    free(t_values);
     return HASH_STATUS_OK;
 }
 
 HashStatus matrix_multiplication_hash(HashMatrix* A, HashMatrix* B, HashMatrix* C){
+    return matrix_multiplication_parallel_hash(A, B, C, thread_pool_global());
+}
+
+HashStatus matrix_multiplication_parallel_hash(HashMatrix* A, HashMatrix* B, HashMatrix* C, ThreadPool* pool){
     if (A == NULL || B == NULL){
         return HASH_ERROR_NULL_MATRIX;
     }
@@ -237,37 +1635,46 @@ HashStatus matrix_multiplication_hash(HashMatrix* A, HashMatrix* B, HashMatrix*
 
     if (!verify_result_matrix(C, rows_a, columns_b)){
         return HASH_ERROR_INVALID_ARGUMENT;
-    }    
-
-    Node* current_bucket_A = NULL;
-    Node* current_bucket_B = NULL;
-
-    for (int i = 0; i < A->capacity; i++){
-        current_bucket_A = A->buckets[i];
-
-        while (current_bucket_A != NULL){
-            int row_a = A->is_transposed ? current_bucket_A->column : current_bucket_A->row;
-            int column_a = A->is_transposed ? current_bucket_A->row : current_bucket_A->column;
-            float data_a = current_bucket_A->data;
-
-            for (int j = 0; j < B->capacity; j++){
-                current_bucket_B = B->buckets[j];
-                while (current_bucket_B != NULL){
-                    int row_b = B->is_transposed ? current_bucket_B->column : current_bucket_B->row;
-                    int column_b = B->is_transposed ? current_bucket_B->row : current_bucket_B->column;
-                    float data_b = current_bucket_B->data;
-
-                    if (column_a == row_b){
-                        float temp = get_element_hash(C, row_a, column_b);
-                        temp += data_a * data_b;
-                        set_element_hash(C, row_a, column_b, temp);
-                    }
-                    current_bucket_B = current_bucket_B->next;
-                }
-            }
-            current_bucket_A = current_bucket_A->next;
+    }
+
+    if (A->count == 0 || B->count == 0){
+        return HASH_STATUS_OK;
+    }
+
+    //Gustavson: C(i,:) = soma de A(i,j) * B(j,:), com A e B agrupadas por linha uma única vez.
+    int *a_ptr, *a_columns, *b_ptr, *b_columns;
+    float *a_values, *b_values;
+    _group_by_row(A, rows_a, &a_ptr, &a_columns, &a_values);
+    _group_by_row(B, rows_b, &b_ptr, &b_columns, &b_values);
+
+    //C em dois níveis sem transposição: as linhas já saem ordenadas das fatias, em paralelo.
+    //Com C transposto, cada linha armazenada recebe as colunas em ordem crescente de i.
+    bool sorted_output = C->storage == HASH_STORAGE_ROWS && !C->is_transposed;
+
+    int *c_ptr, *c_columns;
+    float* c_values;
+    int c_count = gustavson_csr(pool, rows_a, columns_b, a_ptr, a_columns, a_values, b_ptr, b_columns, b_values, sorted_output, &c_ptr, &c_columns, &c_values);
+
+    //Escrita em bloco: um único rehash e inserções sem busca, pois cada (i, c) é único.
+    _reserve(C, c_count);
+    for (int i = 0; i < rows_a; i++){
+        for (int p = c_ptr[i]; p < c_ptr[i + 1]; p++){
+            int target_row = C->is_transposed ? c_columns[p] : i;
+            int target_column = C->is_transposed ? i : c_columns[p];
+            _insert_absent(C, target_row, target_column, c_values[p]);
         }
     }
+    _finish_insert_absent(C);
+
+    free(a_ptr);
+    free(a_columns);
+    free(a_values);
+    free(b_ptr);
+    free(b_columns);
+    free(b_values);
+    free(c_ptr);
+    free(c_columns);
+    free(c_values);
 
     return HASH_STATUS_OK;
 }
@@ -278,42 +1685,37 @@ HashStatus matrix_addition_hash(HashMatrix* A, HashMatrix* B, HashMatrix* C){
         exit(1);
     }
 
-    if (!verify_result_matrix(C, A->is_transposed ? A->columns : A->rows, A->is_transposed ? A->rows : A->columns)){
+    int rows_a = A->is_transposed ? A->columns : A->rows;
+    int columns_a = A->is_transposed ? A->rows : A->columns;
+    int rows_b = B->is_transposed ? B->columns : B->rows;
+    int columns_b = B->is_transposed ? B->rows : B->columns;
+    if (rows_a != rows_b || columns_a != columns_b){
+        return HASH_ERROR_DIMENSION_MISMATCH;
+    }
+
+    if (!verify_result_matrix(C, rows_a, columns_a)){
         return HASH_ERROR_INVALID_ARGUMENT;
     }
-    
-    Node* current_bucket = NULL;
 
-    for (int i = 0; i < A->capacity; i++){
-        current_bucket = A->buckets[i];
+    _reserve(C, A->count > B->count ? A->count : B->count);
 
-        while (current_bucket != NULL){
-            int row_a = A->is_transposed ? current_bucket->column : current_bucket->row;
-            int column_a = A->is_transposed ? current_bucket->row : current_bucket->column;
-            float data_a = current_bucket->data;
+    HashCursor cursor = {0, NULL, 0};
+    int stored_row, stored_column;
+    float data;
 
-            float temp = get_element_hash(C, row_a, column_a);
-            temp += data_a;
-            set_element_hash(C, row_a, column_a, temp);
+    while (_next_entry(A, &cursor, &stored_row, &stored_column, &data)){
+        int row_a = A->is_transposed ? stored_column : stored_row;
+        int column_a = A->is_transposed ? stored_row : stored_column;
 
-            current_bucket = current_bucket->next;
-        }
+        _update_element(C, C->is_transposed ? column_a : row_a, C->is_transposed ? row_a : column_a, data, true);
     }
 
-    for (int i = 0; i < B->capacity; i++){
-        current_bucket = B->buckets[i];
-
-        while (current_bucket != NULL){
-            int row_b = B->is_transposed ? current_bucket->column : current_bucket->row;
-            int column_b = B->is_transposed ? current_bucket->row : current_bucket->column;
-            float data_b = current_bucket->data;
-
-            float temp = get_element_hash(C, row_b, column_b);
-            temp += data_b;
-            set_element_hash(C, row_b, column_b, temp);
+    cursor = (HashCursor){0, NULL, 0};
+    while (_next_entry(B, &cursor, &stored_row, &stored_column, &data)){
+        int row_b = B->is_transposed ? stored_column : stored_row;
+        int column_b = B->is_transposed ? stored_row : stored_column;
 
-            current_bucket = current_bucket->next;
-        }
+        _update_element(C, C->is_transposed ? column_b : row_b, C->is_transposed ? row_b : column_b, data, true);
     }
 
     return HASH_STATUS_OK;
@@ -328,23 +1730,169 @@ HashStatus matrix_scalar_multiplication_hash(HashMatrix* A, HashMatrix* B, float
         return HASH_ERROR_INVALID_ARGUMENT;
     }
 
-    Node* current_bucket = NULL;
+    //Cada posição de A aparece uma única vez: inserções em bloco, sem busca.
+    _reserve(B, A->count);
+    HashCursor cursor = {0, NULL, 0};
+    int stored_row, stored_column;
+    float data_a;
+
+    while (_next_entry(A, &cursor, &stored_row, &stored_column, &data_a)){
+        int row_a = A->is_transposed ? stored_column : stored_row;
+        int column_a = A->is_transposed ? stored_row : stored_column;
+
+        float temp = data_a * scalar;
+        if (temp != 0.0){
+            _insert_absent(B, B->is_transposed ? column_a : row_a, B->is_transposed ? row_a : column_a, temp);
+        }
+    }
+    _finish_insert_absent(B);
+
+    return HASH_STATUS_OK;
+}
+
+HashStatus set_resize_mode_hash(HashMatrix* matrix, HashResizeMode mode){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (mode != HASH_RESIZE_IMMEDIATE && mode != HASH_RESIZE_INCREMENTAL){
+        return HASH_ERROR_INVALID_ARGUMENT;
+    }
+    if (mode == HASH_RESIZE_INCREMENTAL && matrix->storage != HASH_STORAGE_CHAINED){
+        return HASH_ERROR_NOT_IMPLEMENTED;
+    }
+    if (mode == HASH_RESIZE_IMMEDIATE){
+        _finish_migration(matrix);
+    }
+    matrix->resize_mode = mode;
+    return HASH_STATUS_OK;
+}
+
+HashStatus hash_probe_stats(HashMatrix* matrix, HashProbeStats* stats){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (stats == NULL){
+        return HASH_ERROR_INVALID_ARGUMENT;
+    }
+
+    stats->capacity = matrix->capacity;
+    stats->count = matrix->count;
+    stats->max_length = 0;
+    stats->mean_length = 0.0;
+    for (int i = 0; i < HASH_PROBE_HISTOGRAM_SIZE; i++){
+        stats->histogram[i] = 0;
+    }
+
+    unsigned long long total = 0;
+    for (int i = 0; i < matrix->capacity; i++){
+        if (matrix->storage == HASH_STORAGE_ROWS){
+            if (matrix->row_table[i].row == -1){
+                continue;
+            }
+            int home = (int) hash(matrix->row_table[i].row, 0, matrix->capacity);
+            int length = ((i - home) & (matrix->capacity - 1)) + 1;
+            int elements = matrix->row_table[i].count;
+            stats->histogram[length < HASH_PROBE_HISTOGRAM_SIZE ? length - 1 : HASH_PROBE_HISTOGRAM_SIZE - 1] += elements;
+            stats->max_length = length > stats->max_length ? length : stats->max_length;
+            total += (unsigned long long) length * elements;
+        } else if (matrix->storage == HASH_STORAGE_OPEN){
+            if (matrix->keys[i] == EMPTY_KEY){
+                continue;
+            }
+            int home = (int) hash(_key_row(matrix->keys[i]), _key_column(matrix->keys[i]), matrix->capacity);
+            int length = ((i - home) & (matrix->capacity - 1)) + 1;
+            stats->histogram[length < HASH_PROBE_HISTOGRAM_SIZE ? length - 1 : HASH_PROBE_HISTOGRAM_SIZE - 1]++;
+            stats->max_length = length > stats->max_length ? length : stats->max_length;
+            total += length;
+        } else {
+            int length = 0;
+            for (Node* curr = matrix->buckets[i]; curr != NULL; curr = curr->next){
+                length++;
+                stats->histogram[length < HASH_PROBE_HISTOGRAM_SIZE ? length - 1 : HASH_PROBE_HISTOGRAM_SIZE - 1]++;
+                total += length;
+            }
+            stats->max_length = length > stats->max_length ? length : stats->max_length;
+        }
+    }
+
+    //Durante uma migração, um elemento da tabela antiga custa a busca na nova mais a posição na antiga.
+    for (int i = matrix->migrate_index; matrix->old_buckets != NULL && i < matrix->old_capacity; i++){
+        int length = 0;
+        for (Node* curr = matrix->old_buckets[i]; curr != NULL; curr = curr->next){
+            length++;
+            int cost = length + 1;
+            stats->histogram[cost < HASH_PROBE_HISTOGRAM_SIZE ? cost - 1 : HASH_PROBE_HISTOGRAM_SIZE - 1]++;
+            stats->max_length = cost > stats->max_length ? cost : stats->max_length;
+            total += cost;
+        }
+    }
 
-    for (int i = 0; i < A->capacity; i++){
-        current_bucket = A->buckets[i];
+    if (matrix->count > 0){
+        stats->mean_length = (double) total / matrix->count;
+    }
+    return HASH_STATUS_OK;
+}
 
-        while (current_bucket != NULL){
-            int row_a = A->is_transposed ? current_bucket->column : current_bucket->row;
-            int column_a = A->is_transposed ? current_bucket->row : current_bucket->column;
-            float data_a = current_bucket->data;
+/**
+ * @brief Remove todos os elementos, mantendo a capacidade atual da tabela.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ */
+static void _clear(HashMatrix* matrix){
+    matrix->scale = 1.0f;
+    matrix->count = 0;
 
-            float temp = data_a * scalar;
-            set_element_hash(B, row_a, column_a, temp);
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        _rows_free_vectors(matrix);
+        for (int i = 0; i < matrix->capacity; i++){
+            matrix->row_table[i].row = -1;
+        }
+        matrix->row_count = 0;
+        return;
+    }
 
-            current_bucket = current_bucket->next;
+    if (matrix->storage == HASH_STORAGE_OPEN){
+        for (int i = 0; i < matrix->capacity; i++){
+            matrix->keys[i] = EMPTY_KEY;
         }
+        return;
+    }
+
+    _finish_migration(matrix);
+    _pool_destroy(&matrix->pool);
+    for (int i = 0; i < matrix->capacity; i++){
+        matrix->buckets[i] = NULL;
+    }
+}
+
+HashStatus scale_hash(HashMatrix* matrix, float scalar){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+
+    if (scalar == 0.0){
+        _clear(matrix);
+        return HASH_STATUS_OK;
     }
 
+    //O fator pendente fica sempre na faixa normal; fora dela, é incorporado aos valores.
+    float new_scale = matrix->scale * scalar;
+    if (isnormal(new_scale)){
+        matrix->scale = new_scale;
+    } else {
+        _fold_scale(matrix, matrix->scale);
+        _fold_scale(matrix, scalar);
+    }
+    return HASH_STATUS_OK;
+}
+
+HashStatus materialize_hash(HashMatrix* matrix){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (matrix->scale != 1.0f){
+        _fold_scale(matrix, matrix->scale);
+    }
     return HASH_STATUS_OK;
 }
 
@@ -360,15 +1908,21 @@ HashStatus free_hash_matrix(HashMatrix* matrix){
     if (matrix == NULL){
         return HASH_ERROR_NULL_MATRIX;
     }
-    for (int i = 0; i < matrix->capacity; i++){
-        Node* curr = matrix->buckets[i];
-        while (curr != NULL){
-            Node* next = curr->next;
-            free(curr);
-            curr = next;
-        }
+    if (matrix->storage == HASH_STORAGE_ROWS){
+        _rows_free_vectors(matrix);
+        free(matrix->row_table);
+        free(matrix);
+        return HASH_STATUS_OK;
     }
+    if (matrix->storage == HASH_STORAGE_OPEN){
+        free(matrix->keys);
+        free(matrix->values);
+        free(matrix);
+        return HASH_STATUS_OK;
+    }
+    _pool_destroy(&matrix->pool);
     free(matrix->buckets);
+    free(matrix->old_buckets);
     free(matrix);
     return HASH_STATUS_OK;
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <stdbool.h>
+#include "thread_pool.h"
 
 /**
  * @file hash_matrix.h
@@ -18,16 +19,99 @@ typedef struct Node {
     struct Node* next;
 }Node;
 
+/**
+ * @brief Bloco contíguo (slab) de nós alocado de uma só vez pelo pool.
+ */
+typedef struct NodeSlab {
+    struct NodeSlab* next; /**< Slab alocado anteriormente. */
+    int capacity;          /**< Número de nós do slab. */
+    Node nodes[];          /**< Nós do slab. */
+} NodeSlab;
+
+/**
+ * @brief Pool de nós de uma matriz no modo encadeado.
+ *
+ * Os nós são entregues em sequência a partir do slab mais recente; nós removidos
+ * voltam para uma lista livre (encadeada pelo próprio campo next) e são reaproveitados
+ * antes de qualquer novo slab. Na liberação da matriz, os slabs são liberados em bloco.
+ */
+typedef struct NodePool {
+    NodeSlab* slabs;         /**< Lista de slabs, o mais recente primeiro. */
+    Node* free_list;         /**< Nós devolvidos aguardando reuso. */
+    int used;                /**< Nós já entregues do slab mais recente. */
+    unsigned long long bytes; /**< Total de bytes alocados em slabs. */
+} NodePool;
+
+/**
+ * @brief Estratégias de armazenamento disponíveis para a tabela de espalhamento.
+ */
+typedef enum {
+    HASH_STORAGE_CHAINED = 0, /**< Encadeamento: cada bucket é uma lista ligada de ::Node. */
+    HASH_STORAGE_OPEN = 1,    /**< Endereçamento aberto: chaves e valores em vetores contíguos, sondagem linear. */
+    HASH_STORAGE_ROWS = 2     /**< Dois níveis: tabela indexada por linha, cada linha com um vetor ordenado de colunas. */
+} HashStorage;
+
+/**
+ * @brief Linha armazenada no modo ::HASH_STORAGE_ROWS.
+ *
+ * As colunas ficam em ordem crescente, com os valores em um vetor paralelo; a busca
+ * de uma coluna é binária e percorrer a linha custa O(nnz da linha).
+ */
+typedef struct HashRow {
+    int row;        /**< Índice da linha armazenada, ou -1 para posição vazia da tabela. */
+    int count;      /**< Elementos não nulos da linha. */
+    int capacity;   /**< Capacidade alocada de columns e values. */
+    int* columns;   /**< Colunas em ordem crescente. */
+    float* values;  /**< Valores paralelos a columns. */
+} HashRow;
+
+/**
+ * @brief Política de redimensionamento da tabela de espalhamento.
+ */
+typedef enum {
+    HASH_RESIZE_IMMEDIATE = 0,  /**< O rehash completo acontece na operação que cruza o load factor (padrão). */
+    HASH_RESIZE_INCREMENTAL = 1 /**< Tabelas antiga e nova coexistem; cada get/set migra poucos buckets. */
+} HashResizeMode;
+
+/**
+ * @brief Tratamento de posições repetidas na construção em bloco.
+ */
+typedef enum {
+    HASH_DUPLICATES_SUM = 0,      /**< Valores repetidos são somados (convenção usual de COO). */
+    HASH_DUPLICATES_OVERWRITE = 1 /**< Prevalece o último valor, como em chamadas sucessivas de set_element_hash. */
+} HashDuplicatePolicy;
+
 /**
  * @brief Representação de uma matriz esparsa usando tabela de espalhamento (hash table).
  * 
  * Armazena os buckets da tabela de espalhamento, capacidade total, número de elementos não nulos,
  * dimensões da matriz (linhas e colunas) e flag de transposição.
+ *
+ * Assim como a transposição, a multiplicação por escalar in-place é preguiçosa: scale_hash
+ * apenas atualiza scale, aplicado em toda leitura. A primeira escrita seguinte incorpora
+ * scale aos valores, de modo que valores escritos são sempre guardados exatamente.
+ *
+ * No modo ::HASH_STORAGE_OPEN os buckets não são usados: cada posição i da tabela
+ * guarda em keys[i] o par (linha, coluna) empacotado em 64 bits e em values[i] o valor.
+ *
+ * No modo ::HASH_STORAGE_ROWS, capacity é o tamanho de row_table, uma tabela de
+ * endereçamento aberto indexada apenas pela linha armazenada.
  */
 typedef struct HashMatrix{
     Node **buckets;
+    unsigned long long *keys;  //endereçamento aberto: (linha << 32) | coluna, ou posição vazia
+    float *values;             //endereçamento aberto: valores paralelos a keys
     int capacity, count, rows, columns; //capacity = tamanho total do hash, count = num de elementos não nulos
     bool is_transposed;
+    HashStorage storage;
+    NodePool pool;             //encadeamento: origem de todos os nós da matriz
+    HashResizeMode resize_mode;
+    Node **old_buckets;        //redimensionamento incremental: tabela em migração (NULL se nenhuma)
+    int old_capacity, migrate_index; //buckets de old_buckets abaixo de migrate_index já foram migrados
+    int migrate_step;          //redimensionamento incremental: buckets migrados por get/set
+    float scale;               //fator escalar pendente: valor lógico = valor armazenado * scale
+    HashRow *row_table;        //dois níveis: linhas indexadas pela linha armazenada
+    int row_count;             //dois níveis: posições ocupadas de row_table
 }HashMatrix;
 
 /**
@@ -43,6 +127,39 @@ typedef enum {
     HASH_ERROR_NOT_IMPLEMENTED = -5     /**< Funcionalidade ainda não implementada. */
 } HashStatus;
 
+/**
+ * @brief Número de faixas do histograma de ::HashProbeStats.
+ */
+#define HASH_PROBE_HISTOGRAM_SIZE 16
+
+/**
+ * @brief Distribuição do custo de busca dos elementos armazenados.
+ *
+ * O comprimento de um elemento é o número de chaves comparadas para encontrá-lo:
+ * a posição dele na lista do bucket (encadeamento) ou a distância até a posição
+ * ideal mais um (endereçamento aberto). Para ambas as estratégias, um espalhamento
+ * saudável concentra quase todos os elementos nas primeiras faixas.
+ */
+typedef struct HashProbeStats {
+    int capacity;    /**< Capacidade atual da tabela. */
+    int count;       /**< Número de elementos armazenados. */
+    int max_length;  /**< Maior comprimento observado (maior lista ou maior sondagem). */
+    double mean_length; /**< Comprimento médio, isto é, custo médio de uma busca bem-sucedida. */
+    int histogram[HASH_PROBE_HISTOGRAM_SIZE]; /**< histogram[i]: elementos com comprimento i+1; a última faixa acumula os maiores. */
+} HashProbeStats;
+
+/**
+ * @brief Mistura os 64 bits da chave (row, column) (finalizador do MurmurHash3).
+ *
+ * As tabelas usam os bits baixos do resultado; os bits altos ficam livres para
+ * particionar elementos entre tabelas independentes (ver sharded_hash_matrix.h).
+ *
+ * @param row índice de linha armazenado.
+ * @param column índice de coluna armazenado.
+ * @return chave misturada.
+ */
+unsigned long long hash_mix(int row, int column);
+
 /**
  * @brief Cria uma nova matriz hash com dimensões especificadas.
  *
@@ -52,8 +169,43 @@ typedef enum {
  */
 HashMatrix* create_hash_matrix(int rows, int columns);
 
+/**
+ * @brief Cria uma nova matriz hash escolhendo a estratégia de armazenamento.
+ *
+ * Todas as demais operações deste cabeçalho funcionam para qualquer estratégia.
+ *
+ * @param rows número de linhas.
+ * @param columns número de colunas.
+ * @param storage estratégia de armazenamento (::HashStorage).
+ * @return Ponteiro para a nova matriz hash ou NULL se os parâmetros forem inválidos.
+ */
+HashMatrix* create_hash_matrix_with_storage(int rows, int columns, HashStorage storage);
+
+/**
+ * @brief Cria uma matriz hash a partir de triplas (I[t], J[t], Data[t]) no formato COO.
+ *
+ * A tabela e o pool de nós são dimensionados uma única vez para k elementos e os
+ * índices são validados em uma única passada antes das inserções, que dispensam a
+ * verificação de limites e de transposição de set_element_hash. Valores nulos, ou
+ * cuja soma resulte em zero, não são armazenados.
+ *
+ * @param rows número de linhas.
+ * @param columns número de colunas.
+ * @param k número de triplas.
+ * @param I vetor de linhas.
+ * @param J vetor de colunas.
+ * @param Data vetor de valores.
+ * @param policy tratamento de posições repetidas.
+ * @return Ponteiro para a nova matriz hash ou NULL se algum parâmetro ou índice for inválido.
+ */
+HashMatrix* create_hash_matrix_from_triplets(int rows, int columns, int k, const int* I, const int* J, const float* Data, HashDuplicatePolicy policy);
+
 /**
  * @brief Obtém o valor de um elemento da matriz hash.
+ *
+ * No modo ::HASH_RESIZE_INCREMENTAL a leitura também migra buckets pendentes, ou seja,
+ * escreve na matriz: não pode rodar ao mesmo tempo que outras chamadas sobre a mesma
+ * matriz, nem mesmo outras leituras (ver ::ShardedHashMatrix para acesso concorrente).
  * 
  * @param matrix ponteiro para a matriz hash.
  * @param row índice de linha.
@@ -64,6 +216,9 @@ float get_element_hash(HashMatrix* matrix, int row, int column);
 
 /**
  * @brief Define o valor de um elemento na matriz hash.
+ *
+ * Se houver um fator de scale_hash pendente, ele é antes incorporado aos valores (custo
+ * linear, uma vez), para que get_element_hash devolva exatamente data.
  * 
  * @param matrix ponteiro para a matriz hash.
  * @param row índice de linha.
@@ -73,15 +228,119 @@ float get_element_hash(HashMatrix* matrix, int row, int column);
  */
 HashStatus set_element_hash(HashMatrix* matrix, int row, int column, float data);
 
+/**
+ * @brief Soma delta ao elemento (row, column) com uma única busca na tabela.
+ *
+ * Insere o elemento se ele não existir e o remove se a soma resultar em zero.
+ * Equivale a set_element_hash(matrix, row, column, get_element_hash(matrix, row, column) + delta)
+ * sem percorrer o bucket (ou a sondagem) duas vezes.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param row índice de linha.
+ * @param column índice de coluna.
+ * @param delta valor a ser somado.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus accumulate_element_hash(HashMatrix* matrix, int row, int column, float delta);
+
+/**
+ * @brief Copia os elementos não nulos de uma linha.
+ *
+ * No modo ::HASH_STORAGE_ROWS sem transposição custa O(nnz da linha) e as colunas saem
+ * em ordem crescente; nos demais casos a tabela inteira é percorrida e a ordem é arbitrária.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param row índice da linha.
+ * @param columns saída: colunas (espaço para o número de colunas da matriz).
+ * @param values saída: valores (mesmo tamanho de columns).
+ * @param count saída: número de elementos copiados.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus get_row_hash(HashMatrix* matrix, int row, int* columns, float* values, int* count);
+
+/**
+ * @brief Soma os elementos de uma linha.
+ *
+ * Mesmo custo de get_row_hash.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param row índice da linha.
+ * @param sum saída: soma dos elementos da linha.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus row_sum_hash(HashMatrix* matrix, int row, float* sum);
+
+/**
+ * @brief Calcula y = matrix * x.
+ *
+ * No modo ::HASH_STORAGE_ROWS sem transposição, cada linha é um produto escalar com x;
+ * nos demais casos a tabela é percorrida uma vez, somando cada elemento em y.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param x vetor com uma posição por coluna lógica.
+ * @param y saída: vetor com uma posição por linha lógica (não pode sobrepor x).
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus spmv_hash(HashMatrix* matrix, const float* x, float* y);
+
+/**
+ * @brief Calcula y = matrix^T * x sem transpor a matriz.
+ *
+ * Mesmo custo de spmv_hash; no modo ::HASH_STORAGE_ROWS o caminho por linhas vale
+ * quando a matriz está transposta.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param x vetor com uma posição por linha lógica.
+ * @param y saída: vetor com uma posição por coluna lógica (não pode sobrepor x).
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus spmv_transposed_hash(HashMatrix* matrix, const float* x, float* y);
+
+/**
+ * @brief Exporta a matriz no formato CSR, com colunas crescentes em cada linha.
+ *
+ * Custo O(linhas + colunas + count) por ordenação por contagem (no modo
+ * ::HASH_STORAGE_ROWS sem transposição as linhas já estão ordenadas e são apenas
+ * copiadas). Os valores incluem o fator scale. Os três vetores são alocados com
+ * malloc e pertencem ao chamador.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param row_ptr saída: vetor de linhas+1 posições; a linha i ocupa [row_ptr[i], row_ptr[i+1]).
+ * @param columns saída: colunas dos count elementos.
+ * @param values saída: valores paralelos a columns.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus to_csr_hash(HashMatrix* matrix, int** row_ptr, int** columns, float** values);
+
 /**
  * @brief Multiplica duas matrizes hash.
  * 
+ * Usa o pool global, se inicializado (ver matrix_multiplication_parallel_hash).
+ *
  * @param A ponteiro para a matriz hash A.
  * @param B ponteiro para a matriz hash B.
  * @return Ponteiro para a matriz resultante C.
  */
 HashStatus matrix_multiplication_hash(HashMatrix* A, HashMatrix* B, HashMatrix* C);
 
+/**
+ * @brief Multiplica duas matrizes hash usando um pool de threads.
+ *
+ * As linhas de A são divididas em várias fatias contíguas por participante, com número
+ * parecido de multiplicações (estimado por nnz das linhas de B tocadas); fatias que
+ * demoram mais que o previsto são compensadas por roubo de trabalho. Cada participante
+ * usa um acumulador próprio e cada fatia vetores próprios; ao final os elementos são
+ * inseridos em C de uma vez, sem locks. matrix_multiplication_hash chama esta função com
+ * o pool global.
+ *
+ * @param A ponteiro para a matriz hash A.
+ * @param B ponteiro para a matriz hash B.
+ * @param C matriz resultado vazia com dimensões corretas.
+ * @param pool pool que executa as fatias (NULL para sequencial).
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus matrix_multiplication_parallel_hash(HashMatrix* A, HashMatrix* B, HashMatrix* C, ThreadPool* pool);
+
 /**
  * @brief Soma duas matrizes hash.
  * 
@@ -93,6 +352,8 @@ HashStatus matrix_addition_hash(HashMatrix* A, HashMatrix* B, HashMatrix* C);
 
 /**
  * @brief Multiplica uma matriz hash por um escalar.
+ *
+ * B deve ser uma matriz vazia distinta de A; para multiplicar A in-place use scale_hash.
  * 
  * @param A ponteiro para a matriz hash A.
  * @param scalar valor escalar.
@@ -100,6 +361,60 @@ HashStatus matrix_addition_hash(HashMatrix* A, HashMatrix* B, HashMatrix* C);
  */
 HashStatus matrix_scalar_multiplication_hash(HashMatrix* A, HashMatrix* B, float scalar);
 
+/**
+ * @brief Escolhe a política de redimensionamento da matriz.
+ *
+ * No modo ::HASH_RESIZE_INCREMENTAL, um redimensionamento apenas aloca a nova tabela;
+ * os buckets antigos são migrados aos poucos pelas chamadas seguintes de get/set, de modo
+ * que nenhuma operação isolada paga o rehash inteiro. O passo de migração acompanha a
+ * distância até o próximo limite de load factor, então uma migração sempre termina antes
+ * de a seguinte começar e toda inserção ou remoção custa O(1) no pior caso. Voltar ao modo imediato conclui
+ * qualquer migração pendente. Disponível apenas para ::HASH_STORAGE_CHAINED.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param mode política desejada.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus set_resize_mode_hash(HashMatrix* matrix, HashResizeMode mode);
+
+/**
+ * @brief Calcula a distribuição dos comprimentos de lista/sondagem da matriz.
+ *
+ * Útil para verificar que padrões estruturados (diagonais, bandas) não degradam o espalhamento.
+ *
+ * No modo ::HASH_STORAGE_ROWS, conta a sondagem até a linha de cada elemento (a busca
+ * da coluna dentro da linha é binária).
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param stats saída com as estatísticas.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus hash_probe_stats(HashMatrix* matrix, HashProbeStats* stats);
+
+/**
+ * @brief Multiplica a matriz por um escalar in-place, em tempo constante.
+ *
+ * Apenas o fator scale é atualizado; leituras, percursos e operações sobre a matriz inteira
+ * o aplicam, e a próxima escrita de elemento o incorpora aos valores (custo linear).
+ * Multiplicar por zero esvazia a matriz; se o fator acumulado sair da faixa normal de
+ * float, ele é incorporado aos valores imediatamente.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @param scalar fator escalar.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus scale_hash(HashMatrix* matrix, float scalar);
+
+/**
+ * @brief Incorpora o fator escalar pendente aos valores armazenados.
+ *
+ * Após a chamada scale vale 1. Elementos que resultarem em zero são removidos.
+ *
+ * @param matrix ponteiro para a matriz hash.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus materialize_hash(HashMatrix* matrix);
+
 /**
  * @brief Transpõe a matriz hash.   
  * 
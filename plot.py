@@ -11,6 +11,10 @@ with open("size_experiments.csv", newline="") as f:
             "dense": float(row["dense_bytes"].strip()),
             "avl": float(row["avl_bytes"].strip()),
             "hash": float(row["hash_bytes"].strip()),
+            "hash_open": float(row["hash_open_bytes"].strip()) if row.get("hash_open_bytes") else None,
+            "hash_rows": float(row["hash_rows_bytes"].strip()) if row.get("hash_rows_bytes") else None,
+            "avl_btree": float(row["avl_btree_bytes"].strip()) if row.get("avl_btree_bytes") else None,
+            "csr": float(row["csr_bytes"].strip()) if row.get("csr_bytes") else None,
         })
 
 by_n = {}
@@ -23,11 +27,23 @@ for n_val, group in by_n.items():
     d = [r["dense"] for r in group]
     a = [r["avl"] for r in group]
     h = [r["hash"] for r in group]
+    ho = [r["hash_open"] for r in group]
+    hr = [r["hash_rows"] for r in group]
+    ab = [r["avl_btree"] for r in group]
+    c = [r["csr"] for r in group]
 
     plt.figure()
     plt.plot(s, d, marker="o", label="Dense")
     plt.plot(s, a, marker="o", label="AVL")
+    if all(v is not None for v in ab):
+        plt.plot(s, ab, marker="o", label="AVL (fileiras B+)")
     plt.plot(s, h, marker="o", label="Hash")
+    if all(v is not None for v in ho):
+        plt.plot(s, ho, marker="o", label="Hash (endereçamento aberto)")
+    if all(v is not None for v in hr):
+        plt.plot(s, hr, marker="o", label="Hash (dois níveis)")
+    if all(v is not None for v in c):
+        plt.plot(s, c, marker="o", label="CSR")
     plt.title(f"Memória vs. esparsidade (n={n_val})")
     plt.xlabel("Esparsidade (escala log)")
     plt.ylabel("Bytes (escala log)")
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sharded_hash_matrix.h"
+
+#define MAX_SHARD_BITS 16
+
+/**
+ * @brief Encerramento imediato em caso de falha de alocação.
+ *
+ * Imprime uma mensagem de erro em stderr e aborta o processo usando EXIT_FAILURE.
+ */
+static void _allocation_fail(){
+    fprintf(stderr, "Error: memory allocation failed.\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Seleciona o shard de um elemento pelos bits altos de hash_mix.
+ *
+ * @param matrix ponteiro para a matriz particionada.
+ * @param row índice de linha.
+ * @param column índice de coluna.
+ * @return shard responsável por (row, column).
+ */
+static HashShard* _shard_of(ShardedHashMatrix* matrix, int row, int column){
+    if (matrix->shard_bits == 0){
+        return &matrix->shards[0];
+    }
+    return &matrix->shards[hash_mix(row, column) >> (64 - matrix->shard_bits)];
+}
+
+ShardedHashMatrix* create_sharded_hash_matrix(int rows, int columns, int shard_count){
+    if (rows < 0 || columns < 0){
+        return NULL;
+    }
+    if (shard_count <= 0 || (shard_count & (shard_count - 1)) != 0 || shard_count > (1 << MAX_SHARD_BITS)){
+        return NULL;
+    }
+
+    ShardedHashMatrix* matrix = malloc(sizeof(struct ShardedHashMatrix));
+    if (matrix == NULL){
+        _allocation_fail();
+    }
+    matrix->shards = aligned_alloc(_Alignof(HashShard), sizeof(HashShard) * shard_count);
+    if (matrix->shards == NULL){
+        _allocation_fail();
+    }
+
+    matrix->rows = rows;
+    matrix->columns = columns;
+    matrix->shard_count = shard_count;
+    matrix->shard_bits = 0;
+    while ((1 << matrix->shard_bits) < shard_count){
+        matrix->shard_bits++;
+    }
+
+    for (int i = 0; i < shard_count; i++){
+        if (pthread_mutex_init(&matrix->shards[i].lock, NULL) != 0){
+            _allocation_fail();
+        }
+        matrix->shards[i].matrix = create_hash_matrix(rows, columns);
+    }
+    return matrix;
+}
+
+float get_element_sharded_hash(ShardedHashMatrix* matrix, int row, int column){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (row >= matrix->rows || row < 0 || column >= matrix->columns || column < 0){
+        return HASH_ERROR_OUT_OF_BOUNDS;
+    }
+
+    HashShard* shard = _shard_of(matrix, row, column);
+    pthread_mutex_lock(&shard->lock);
+    float data = get_element_hash(shard->matrix, row, column);
+    pthread_mutex_unlock(&shard->lock);
+    return data;
+}
+
+HashStatus set_element_sharded_hash(ShardedHashMatrix* matrix, int row, int column, float data){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (row >= matrix->rows || row < 0 || column >= matrix->columns || column < 0){
+        return HASH_ERROR_OUT_OF_BOUNDS;
+    }
+
+    HashShard* shard = _shard_of(matrix, row, column);
+    pthread_mutex_lock(&shard->lock);
+    HashStatus status = set_element_hash(shard->matrix, row, column, data);
+    pthread_mutex_unlock(&shard->lock);
+    return status;
+}
+
+HashStatus accumulate_element_sharded_hash(ShardedHashMatrix* matrix, int row, int column, float delta){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    if (row >= matrix->rows || row < 0 || column >= matrix->columns || column < 0){
+        return HASH_ERROR_OUT_OF_BOUNDS;
+    }
+
+    HashShard* shard = _shard_of(matrix, row, column);
+    pthread_mutex_lock(&shard->lock);
+    HashStatus status = accumulate_element_hash(shard->matrix, row, column, delta);
+    pthread_mutex_unlock(&shard->lock);
+    return status;
+}
+
+int sharded_hash_count(ShardedHashMatrix* matrix){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+
+    int count = 0;
+    for (int i = 0; i < matrix->shard_count; i++){
+        pthread_mutex_lock(&matrix->shards[i].lock);
+        count += matrix->shards[i].matrix->count;
+        pthread_mutex_unlock(&matrix->shards[i].lock);
+    }
+    return count;
+}
+
+HashStatus free_sharded_hash_matrix(ShardedHashMatrix* matrix){
+    if (matrix == NULL){
+        return HASH_ERROR_NULL_MATRIX;
+    }
+    for (int i = 0; i < matrix->shard_count; i++){
+        pthread_mutex_destroy(&matrix->shards[i].lock);
+        free_hash_matrix(matrix->shards[i].matrix);
+    }
+    free(matrix->shards);
+    free(matrix);
+    return HASH_STATUS_OK;
+}
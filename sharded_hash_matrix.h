@@ -0,0 +1,92 @@
+#pragma once
+#include <pthread.h>
+#include "hash_matrix.h"
+
+/**
+ * @file sharded_hash_matrix.h
+ * @brief Matriz hash particionada em shards independentes para escritores concorrentes.
+ */
+
+/**
+ * @brief Partição da matriz: uma HashMatrix protegida pelo seu próprio mutex.
+ *
+ * Alinhada a 64 bytes para que mutexes de shards vizinhos não compartilhem linha de cache.
+ */
+typedef struct HashShard{
+    _Alignas(64) pthread_mutex_t lock; /**< Protege matrix, inclusive nas leituras (a migração incremental escreve). */
+    HashMatrix* matrix;                /**< Elementos cujos bits altos de hash_mix selecionam este shard. */
+} HashShard;
+
+/**
+ * @brief Matriz hash dividida em shard_count tabelas independentes.
+ *
+ * O elemento (row, column) pertence ao shard dado pelos shard_bits bits mais altos de
+ * hash_mix(row, column); dentro do shard, a tabela usa os bits baixos, de modo que as
+ * duas escolhas são independentes. Cada shard redimensiona sozinho, então um rehash
+ * bloqueia apenas os escritores daquele shard.
+ */
+typedef struct ShardedHashMatrix{
+    HashShard* shards;
+    int shard_count, shard_bits; //shard_count = 2^shard_bits
+    int rows, columns;
+} ShardedHashMatrix;
+
+/**
+ * @brief Cria uma matriz hash particionada.
+ *
+ * @param rows número de linhas.
+ * @param columns número de colunas.
+ * @param shard_count número de shards (potência de dois, no máximo 65536).
+ * @return Ponteiro para a nova matriz ou NULL se algum parâmetro for inválido.
+ */
+ShardedHashMatrix* create_sharded_hash_matrix(int rows, int columns, int shard_count);
+
+/**
+ * @brief Obtém o valor de um elemento. Seguro para chamadas concorrentes.
+ *
+ * @param matrix ponteiro para a matriz particionada.
+ * @param row índice de linha.
+ * @param column índice de coluna.
+ * @return valor do elemento na posição (row, column) ou código de erro.
+ */
+float get_element_sharded_hash(ShardedHashMatrix* matrix, int row, int column);
+
+/**
+ * @brief Define o valor de um elemento. Seguro para chamadas concorrentes.
+ *
+ * @param matrix ponteiro para a matriz particionada.
+ * @param row índice de linha.
+ * @param column índice de coluna.
+ * @param data valor a ser definido.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus set_element_sharded_hash(ShardedHashMatrix* matrix, int row, int column, float data);
+
+/**
+ * @brief Soma delta a um elemento de forma atômica em relação aos demais acessos.
+ *
+ * @param matrix ponteiro para a matriz particionada.
+ * @param row índice de linha.
+ * @param column índice de coluna.
+ * @param delta valor a ser somado.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus accumulate_element_sharded_hash(ShardedHashMatrix* matrix, int row, int column, float delta);
+
+/**
+ * @brief Conta os elementos não nulos somando todos os shards.
+ *
+ * Cada shard é lido sob o seu mutex; com escritores ativos o total é apenas aproximado.
+ *
+ * @param matrix ponteiro para a matriz particionada.
+ * @return número de elementos não nulos, ou código de erro se matrix for NULL.
+ */
+int sharded_hash_count(ShardedHashMatrix* matrix);
+
+/**
+ * @brief Libera a matriz particionada. Não pode haver acessos concorrentes.
+ *
+ * @param matrix ponteiro para a matriz a ser liberada.
+ * @return Código ::HashStatus indicando sucesso ou motivo da falha.
+ */
+HashStatus free_sharded_hash_matrix(ShardedHashMatrix* matrix);
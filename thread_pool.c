@@ -0,0 +1,319 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+static ThreadPool* _global_pool = NULL;
+static _Thread_local int _inside_pool = 0; //1 enquanto a thread executa um laço do pool
+
+/**
+ * @brief Argumento de uma thread auxiliar.
+ */
+typedef struct ThreadPoolWorker {
+    ThreadPool* pool;
+    int id;
+} ThreadPoolWorker;
+
+/**
+ * @brief Encerramento imediato em caso de falha de alocação.
+ *
+ * Imprime uma mensagem de erro em stderr e aborta o processo usando EXIT_FAILURE.
+ */
+static void _allocation_fail(){
+    fprintf(stderr, "Error: memory allocation failed.\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Insere um intervalo no fim da deque.
+ *
+ * @return 1 se inserido, 0 se a deque estiver cheia.
+ */
+static int _push_bottom(ThreadPoolDeque* deque, ThreadPoolRange range){
+    pthread_mutex_lock(&deque->lock);
+    int pushed = deque->count < THREAD_POOL_DEQUE_CAPACITY;
+    if(pushed){
+        deque->ranges[(deque->head + deque->count) % THREAD_POOL_DEQUE_CAPACITY] = range;
+        deque->count++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return pushed;
+}
+
+/**
+ * @brief Retira o intervalo mais recente (uso do dono da deque).
+ *
+ * @return 1 se algum intervalo foi retirado.
+ */
+static int _pop_bottom(ThreadPoolDeque* deque, ThreadPoolRange* range){
+    pthread_mutex_lock(&deque->lock);
+    int popped = deque->count > 0;
+    if(popped){
+        deque->count--;
+        *range = deque->ranges[(deque->head + deque->count) % THREAD_POOL_DEQUE_CAPACITY];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return popped;
+}
+
+/**
+ * @brief Retira o intervalo mais antigo, em geral o maior (uso dos ladrões).
+ *
+ * @return 1 se algum intervalo foi retirado.
+ */
+static int _pop_top(ThreadPoolDeque* deque, ThreadPoolRange* range){
+    pthread_mutex_lock(&deque->lock);
+    int popped = deque->count > 0;
+    if(popped){
+        *range = deque->ranges[deque->head];
+        deque->head = (deque->head + 1) % THREAD_POOL_DEQUE_CAPACITY;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return popped;
+}
+
+/**
+ * @brief Procura trabalho nas deques dos outros participantes, a partir do seguinte.
+ *
+ * @return 1 se algum intervalo foi roubado.
+ */
+static int _steal(ThreadPool* pool, int id, ThreadPoolRange* range){
+    for(int offset = 1; offset < pool->threads; offset++){
+        if(_pop_top(&pool->deques[(id + offset) % pool->threads], range)){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Executa um intervalo, deixando metades superiores na própria deque enquanto ele for maior que grain.
+ */
+static void _run_range(ThreadPool* pool, int id, ThreadPoolRange range){
+    if(pool->schedule == THREAD_POOL_STEALING){
+        while(range.end - range.begin > pool->grain){
+            int middle = range.begin + (range.end - range.begin) / 2;
+            if(!_push_bottom(&pool->deques[id], (ThreadPoolRange){middle, range.end})){
+                break;
+            }
+            range.end = middle;
+        }
+    }
+    pool->task(range.begin, range.end, id, pool->context);
+    atomic_fetch_sub(&pool->remaining, (long) (range.end - range.begin));
+}
+
+/**
+ * @brief Participa do laço atual até que todas as iterações terminem.
+ *
+ * No modo estático cada participante executa apenas o próprio bloco.
+ */
+static void _participate(ThreadPool* pool, int id){
+    _inside_pool = 1;
+    while(atomic_load(&pool->remaining) > 0){
+        ThreadPoolRange range;
+        if(_pop_bottom(&pool->deques[id], &range)){
+            _run_range(pool, id, range);
+        }
+        else if(pool->schedule == THREAD_POOL_STEALING && _steal(pool, id, &range)){
+            _run_range(pool, id, range);
+        }
+        else if(pool->schedule == THREAD_POOL_STATIC){
+            break;
+        }
+        else{
+            sched_yield(); //o restante está em execução em outras threads
+        }
+    }
+    _inside_pool = 0;
+}
+
+/**
+ * @brief Laço das threads auxiliares: espera um laço novo, participa e volta a esperar.
+ *
+ * @param argument ponteiro para ::ThreadPoolWorker.
+ * @return NULL.
+ */
+static void* _worker_main(void* argument){
+    ThreadPoolWorker* worker = argument;
+    ThreadPool* pool = worker->pool;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    while(!pool->shutdown){
+        if(pool->open && pool->generation != seen){
+            seen = pool->generation;
+            pool->active++;
+            pthread_mutex_unlock(&pool->lock);
+            _participate(pool, worker->id);
+            pthread_mutex_lock(&pool->lock);
+            pool->active--;
+            if(pool->active == 0){
+                pthread_cond_broadcast(&pool->idle);
+            }
+            continue;
+        }
+        pthread_cond_wait(&pool->wake, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    free(worker);
+    return NULL;
+}
+
+ThreadPool* create_thread_pool(int threads){
+    if(threads < 0){
+        return NULL;
+    }
+    if(threads == 0){
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int) online : 1;
+    }
+    ThreadPool* pool = malloc(sizeof(ThreadPool));
+    if(!pool){
+        _allocation_fail();
+    }
+    pool->threads = threads;
+    pool->workers = malloc(sizeof(pthread_t) * threads);
+    pool->deques = aligned_alloc(64, sizeof(ThreadPoolDeque) * threads);
+    if(!pool->workers || !pool->deques){
+        _allocation_fail();
+    }
+    for(int t = 0; t < threads; t++){
+        pthread_mutex_init(&pool->deques[t].lock, NULL);
+        pool->deques[t].head = 0;
+        pool->deques[t].count = 0;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    pthread_mutex_init(&pool->submit, NULL);
+    pool->generation = 0;
+    pool->open = 0;
+    pool->active = 0;
+    pool->shutdown = 0;
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->grain = 1;
+    pool->schedule = THREAD_POOL_STEALING;
+    atomic_init(&pool->remaining, 0);
+
+    //Uma thread que não pode ser criada reduz o pool; a chamadora sempre participa.
+    int started = 1;
+    for(int t = 1; t < threads; t++){
+        ThreadPoolWorker* worker = malloc(sizeof(ThreadPoolWorker));
+        if(!worker){
+            _allocation_fail();
+        }
+        *worker = (ThreadPoolWorker){pool, started};
+        if(pthread_create(&pool->workers[started], NULL, _worker_main, worker) != 0){
+            free(worker);
+            break;
+        }
+        started++;
+    }
+    pool->threads = started;
+    return pool;
+}
+
+ThreadPoolStatus parallel_for_thread_pool(ThreadPool* pool, int begin, int end, int grain, ThreadPoolSchedule schedule, ThreadPoolTask task, void* context){
+    if(!task || grain < 1 || (schedule != THREAD_POOL_STEALING && schedule != THREAD_POOL_STATIC)){
+        return THREAD_POOL_ERROR_INVALID_ARGUMENT;
+    }
+    if(end <= begin){
+        return THREAD_POOL_STATUS_OK;
+    }
+    //Sem paralelismo a chamadora é a única participante do laço, então usa o índice 0.
+    if(!pool || pool->threads == 1 || _inside_pool){
+        task(begin, end, 0, context);
+        return THREAD_POOL_STATUS_OK;
+    }
+
+    pthread_mutex_lock(&pool->submit);
+    pool->task = task;
+    pool->context = context;
+    pool->grain = grain;
+    pool->schedule = schedule;
+    atomic_store(&pool->remaining, (long) end - begin);
+    if(schedule == THREAD_POOL_STATIC){
+        for(int t = 0; t < pool->threads; t++){
+            int chunk_begin = begin + (int) ((long long) (end - begin) * t / pool->threads);
+            int chunk_end = begin + (int) ((long long) (end - begin) * (t + 1) / pool->threads);
+            if(chunk_end > chunk_begin){
+                _push_bottom(&pool->deques[t], (ThreadPoolRange){chunk_begin, chunk_end});
+            }
+        }
+    }
+    else{
+        _push_bottom(&pool->deques[0], (ThreadPoolRange){begin, end});
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->generation++;
+    pool->open = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    _participate(pool, 0);
+    //No modo estático a chamadora pode terminar antes dos outros blocos.
+    while(atomic_load(&pool->remaining) > 0){
+        sched_yield();
+    }
+
+    //Fecha o laço e espera os auxiliares saírem antes de liberar task e context para o próximo.
+    pthread_mutex_lock(&pool->lock);
+    pool->open = 0;
+    while(pool->active > 0){
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit);
+    return THREAD_POOL_STATUS_OK;
+}
+
+int thread_pool_size(ThreadPool* pool){
+    return pool ? pool->threads : 1;
+}
+
+void free_thread_pool(ThreadPool* pool){
+    if(!pool){
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for(int t = 1; t < pool->threads; t++){
+        pthread_join(pool->workers[t], NULL);
+    }
+    for(int t = 0; t < pool->threads; t++){
+        pthread_mutex_destroy(&pool->deques[t].lock);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->idle);
+    pthread_mutex_destroy(&pool->submit);
+    free(pool->workers);
+    free(pool->deques);
+    free(pool);
+}
+
+ThreadPoolStatus thread_pool_init(int threads){
+    ThreadPool* pool = create_thread_pool(threads);
+    if(!pool){
+        return THREAD_POOL_ERROR_INVALID_ARGUMENT;
+    }
+    thread_pool_shutdown();
+    _global_pool = pool;
+    return THREAD_POOL_STATUS_OK;
+}
+
+void thread_pool_shutdown(void){
+    free_thread_pool(_global_pool);
+    _global_pool = NULL;
+}
+
+ThreadPool* thread_pool_global(void){
+    return _global_pool;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <pthread.h>
+#include <stdatomic.h>
+
+/**
+ * @file thread_pool.h
+ * @brief Pool de threads com roubo de trabalho, compartilhado pelos kernels das matrizes.
+ */
+
+#define THREAD_POOL_DEQUE_CAPACITY 64 /**< Intervalos por deque; a divisão binária usa no máximo ~32. */
+
+/**
+ * @brief Corpo de um laço paralelo: processa as iterações [begin, end).
+ *
+ * worker identifica o participante que executa o trecho (0 a thread_pool_size - 1) e
+ * serve para indexar áreas de trabalho próprias de cada thread; dois trechos com o mesmo
+ * worker nunca rodam ao mesmo tempo.
+ */
+typedef void (*ThreadPoolTask)(int begin, int end, int worker, void* context);
+
+/**
+ * @brief Distribuição das iterações entre os participantes.
+ */
+typedef enum {
+    THREAD_POOL_STEALING = 0, /**< Divisão binária sob demanda; threads ociosas roubam as metades maiores (padrão). */
+    THREAD_POOL_STATIC = 1    /**< Um bloco contíguo de tamanho igual por participante, sem roubo. */
+} ThreadPoolSchedule;
+
+/**
+ * @brief Códigos de retorno das operações do pool.
+ */
+typedef enum {
+    THREAD_POOL_STATUS_OK = 0,              /**< Operação concluída com sucesso. */
+    THREAD_POOL_ERROR_INVALID_ARGUMENT = -4 /**< Parâmetro inválido. */
+} ThreadPoolStatus;
+
+/**
+ * @brief Intervalo de iterações ainda não executado.
+ */
+typedef struct ThreadPoolRange {
+    int begin, end;
+} ThreadPoolRange;
+
+/**
+ * @brief Deque de um participante, em buffer circular.
+ *
+ * O dono empilha e desempilha pelo fim (trechos recentes e pequenos, ainda quentes na
+ * cache); ladrões retiram do início, onde estão as metades maiores. Alinhada a 64 bytes
+ * para que deques vizinhas não compartilhem linha de cache.
+ */
+typedef struct ThreadPoolDeque {
+    _Alignas(64) pthread_mutex_t lock;
+    ThreadPoolRange ranges[THREAD_POOL_DEQUE_CAPACITY];
+    int head;  /**< Posição do intervalo mais antigo. */
+    int count; /**< Intervalos armazenados. */
+} ThreadPoolDeque;
+
+/**
+ * @brief Pool com threads - 1 threads auxiliares; a thread que submete um laço é o participante 0.
+ *
+ * Um laço por vez: parallel_for_thread_pool bloqueia até que todas as iterações terminem.
+ */
+typedef struct ThreadPool {
+    int threads;              //participantes, incluindo a thread que submete
+    pthread_t* workers;       //threads auxiliares (participantes 1 a threads - 1)
+    ThreadPoolDeque* deques;  //uma por participante
+    pthread_mutex_t lock;     //protege generation, open, active e shutdown
+    pthread_cond_t wake;      //novo laço ou encerramento
+    pthread_cond_t idle;      //último auxiliar saiu do laço
+    unsigned long generation; //incrementado a cada laço submetido
+    int open;                 //1 enquanto auxiliares ainda podem entrar no laço atual
+    int active;               //auxiliares dentro do laço atual
+    int shutdown;
+    pthread_mutex_t submit;   //serializa laços submetidos por threads diferentes
+    ThreadPoolTask task;      //laço atual
+    void* context;
+    int grain;
+    ThreadPoolSchedule schedule;
+    atomic_long remaining;    //iterações do laço atual ainda não concluídas
+} ThreadPool;
+
+/**
+ * @brief Cria um pool.
+ *
+ * @param threads número de participantes (incluindo a thread que submete); 0 usa o
+ * número de processadores disponíveis.
+ * @return Ponteiro para o pool ou NULL se threads for negativo.
+ */
+ThreadPool* create_thread_pool(int threads);
+
+/**
+ * @brief Executa task sobre [begin, end) e espera o fim de todas as iterações.
+ *
+ * No modo ::THREAD_POOL_STEALING, um intervalo maior que grain é dividido ao meio e a
+ * metade superior fica disponível para roubo, então linhas de custo muito desigual
+ * (matrizes com distribuição de lei de potência) não prendem o laço em uma só thread.
+ * Com pool NULL, com um único participante ou quando chamado de dentro de outro laço
+ * do pool, task é chamada uma vez, na própria thread, com o intervalo inteiro e worker 0.
+ *
+ * @param pool pool (pode ser NULL).
+ * @param begin primeira iteração.
+ * @param end fim (exclusivo) das iterações.
+ * @param grain menor intervalo que ainda é dividido (ao menos 1).
+ * @param schedule distribuição das iterações.
+ * @param task corpo do laço.
+ * @param context argumento repassado a task.
+ * @return Código ::ThreadPoolStatus indicando sucesso ou motivo da falha.
+ */
+ThreadPoolStatus parallel_for_thread_pool(ThreadPool* pool, int begin, int end, int grain, ThreadPoolSchedule schedule, ThreadPoolTask task, void* context);
+
+/**
+ * @brief Número de participantes do pool (1 para NULL).
+ *
+ * @param pool pool (pode ser NULL).
+ * @return Valores possíveis do parâmetro worker de ::ThreadPoolTask.
+ */
+int thread_pool_size(ThreadPool* pool);
+
+/**
+ * @brief Encerra as threads auxiliares e libera o pool.
+ *
+ * @param pool pool (ignorado se NULL); não pode haver laço em execução.
+ */
+void free_thread_pool(ThreadPool* pool);
+
+/**
+ * @brief Cria o pool global usado pelos kernels das matrizes (substitui um anterior).
+ *
+ * Enquanto o pool global existir, as operações que aceitam paralelismo o usam
+ * automaticamente; sem ele, rodam na thread chamadora.
+ *
+ * @param threads número de participantes; 0 usa o número de processadores disponíveis.
+ * @return Código ::ThreadPoolStatus indicando sucesso ou motivo da falha.
+ */
+ThreadPoolStatus thread_pool_init(int threads);
+
+/**
+ * @brief Encerra o pool global, se existir.
+ */
+void thread_pool_shutdown(void);
+
+/**
+ * @brief Pool global atual.
+ *
+ * @return Pool criado por thread_pool_init ou NULL.
+ */
+ThreadPool* thread_pool_global(void);